@@ -16,15 +16,28 @@
 #include <QInputDialog>
 #include <QUndoStack>
 #include <QPointer>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QFile>
+#include <QSettings>
+#include <QThreadPool>
+#include <algorithm>
 #include <memory>
 
 #include "ui/ShapeItem.h"
 #include "ui/DrawingScene.h"        
 #include "ui/CanvasView.h"
 #include "ui/PropertyPanel.h"       
+#include "ui/StatsPanel.h"
 #include "core/Serialization.h"
+#include "core/ObjectPool.h"
+#include "core/PolygonBoolean.h"
+#include "core/StyleTable.h"
 #include "undo/Commands.h"
 
+// 记录当前编辑日志路径的设置项：正常退出时清除，启动时仍存在说明上次会话异常结束
+static constexpr char kJournalKey[] = "recovery/journal";
+
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent) {
     setWindowTitle(QStringLiteral("FakeCAD"));
@@ -41,8 +54,15 @@ MainWindow::MainWindow(QWidget* parent)
     scene = new DrawingScene(this);
     scene->setSceneRect(-5000, -5000, 10000, 10000);
     scene->setUndoStack(undo_);
+    journal_ = std::make_unique<EditJournal>();
+    scene->setJournal(journal_.get());
     connect(actToggleGrid, &QAction::toggled, scene, &DrawingScene::setShowGrid);
     connect(actSnapGrid, &QAction::toggled, scene, &DrawingScene::setSnapToGrid);
+    connect(actLodSkipTiny, &QAction::toggled, scene, [this](bool on) {
+        auto lod = scene->lodSettings();
+        lod.skipTiny = on;
+        scene->setLodSettings(lod);
+    });
 
     view = new CanvasView(scene, this);
     view->setDragMode(QGraphicsView::RubberBandDrag);
@@ -55,6 +75,7 @@ MainWindow::MainWindow(QWidget* parent)
     setCentralWidget(view);
 
     createPropertyDock();
+    createStatsDock();
 
     qApp->installEventFilter(this);
 }
@@ -64,6 +85,14 @@ MainWindow::~MainWindow() {
     // 但此时 MainWindow 已处于析构链中会导致 Qt 的类型检查断言。
     if (scene) scene->blockSignals(true);
     if (view) view->blockSignals(true);
+    // 打开任务的结果已无处可用，通知其尽快停止；保存任务基于快照，照常完成
+    if (jobCancel_ && editingBlocked_) *jobCancel_ = true;
+    // 正常退出不需要恢复：删除编辑日志（未启动会话时不动他人的恢复记录）
+    if (scene) scene->setJournal(nullptr);
+    if (journal_ && journal_->isOpen()) {
+        journal_->discard();
+        rememberJournal();
+    }
     if (qApp) qApp->removeEventFilter(this);
 }
 
@@ -162,10 +191,26 @@ void MainWindow::createActions() {
     actSnapGrid->setShortcut(QKeySequence(tr("Shift+G")));
     // 注意：scene 尚未创建，连接在构造函数中完成
 
+    // 细节层次：缩小后的亚像素图形画为一个点或跳过，较小的图形不开抗锯齿
+    actLodSkipTiny = new QAction(tr("隐藏亚像素图形"), this);
+    actLodSkipTiny->setCheckable(true);
+    actLodThresholds = new QAction(tr("细节层次阈值..."), this);
+    connect(actLodThresholds, &QAction::triggered, this, &MainWindow::onLodThresholds);
+
     // 删除选中
     actDelete = new QAction(tr("删除选中"), this);
     actDelete->setShortcut(QKeySequence::Delete);
     connect(actDelete, &QAction::triggered, this, &MainWindow::onDelete);
+
+    // 布尔运算：最下层的选中图形为被减对象
+    actUnion = new QAction(tr("并集"), this);
+    actIntersect = new QAction(tr("交集"), this);
+    actSubtract = new QAction(tr("差集"), this);
+    actXor = new QAction(tr("异或"), this);
+    connect(actUnion, &QAction::triggered, this, [this]{ runBoolean(int(PolygonBoolean::Op::Union), tr("并集")); });
+    connect(actIntersect, &QAction::triggered, this, [this]{ runBoolean(int(PolygonBoolean::Op::Intersection), tr("交集")); });
+    connect(actSubtract, &QAction::triggered, this, [this]{ runBoolean(int(PolygonBoolean::Op::Difference), tr("差集")); });
+    connect(actXor, &QAction::triggered, this, [this]{ runBoolean(int(PolygonBoolean::Op::Xor), tr("异或")); });
 }
 
 void MainWindow::createMenus() {
@@ -177,11 +222,11 @@ void MainWindow::createMenus() {
     fileMenu->addAction(actExit);
 
     auto editMenu = menuBar()->addMenu(tr("编辑"));
-    auto undoAct = undo_->createUndoAction(this, tr("撤销"));
+    auto undoAct = actUndo_ = undo_->createUndoAction(this, tr("撤销"));
     undoAct->setShortcut(QKeySequence::Undo);
     undoAct->setShortcutContext(Qt::ApplicationShortcut);
     addAction(undoAct); // 确保即便焦点在子控件也能响应全局撤销
-    auto redoAct = undo_->createRedoAction(this, tr("重做"));
+    auto redoAct = actRedo_ = undo_->createRedoAction(this, tr("重做"));
     redoAct->setShortcuts({QKeySequence::Redo, QKeySequence(tr("Ctrl+Y"))});
     redoAct->setShortcutContext(Qt::ApplicationShortcut);
     addAction(redoAct);
@@ -189,14 +234,22 @@ void MainWindow::createMenus() {
     editMenu->addAction(redoAct);
     editMenu->addSeparator();
     editMenu->addAction(actDelete);
-
-    auto viewMenu = menuBar()->addMenu(tr("视图"));
-    viewMenu->addAction(actZoomIn);
-    viewMenu->addAction(actZoomOut);
-    viewMenu->addAction(actResetZoom);
-    viewMenu->addSeparator();
-    viewMenu->addAction(actToggleGrid);
-    viewMenu->addAction(actSnapGrid);
+    auto boolMenu = editMenu->addMenu(tr("布尔运算"));
+    boolMenu->addAction(actUnion);
+    boolMenu->addAction(actIntersect);
+    boolMenu->addAction(actSubtract);
+    boolMenu->addAction(actXor);
+
+    viewMenu_ = menuBar()->addMenu(tr("视图"));
+    viewMenu_->addAction(actZoomIn);
+    viewMenu_->addAction(actZoomOut);
+    viewMenu_->addAction(actResetZoom);
+    viewMenu_->addSeparator();
+    viewMenu_->addAction(actToggleGrid);
+    viewMenu_->addAction(actSnapGrid);
+    auto lodMenu = viewMenu_->addMenu(tr("细节层次"));
+    lodMenu->addAction(actLodSkipTiny);
+    lodMenu->addAction(actLodThresholds);
 
     auto helpMenu = menuBar()->addMenu(tr("帮助"));
     helpMenu->addAction(actAbout);
@@ -228,6 +281,67 @@ void MainWindow::createToolbars() {
 
 void MainWindow::createStatusbar() {
     statusBar()->showMessage(tr("就绪"));
+
+    jobProgress_ = new QProgressBar(this);
+    jobProgress_->setRange(0, 1000);
+    jobProgress_->setMaximumWidth(240);
+    jobProgress_->hide();
+    jobCancelButton_ = new QPushButton(tr("取消"), this);
+    jobCancelButton_->hide();
+    connect(jobCancelButton_, &QPushButton::clicked, this, [this] {
+        if (jobCancel_) *jobCancel_ = true;
+        jobCancelButton_->setEnabled(false);
+    });
+    statusBar()->addPermanentWidget(jobProgress_);
+    statusBar()->addPermanentWidget(jobCancelButton_);
+}
+
+void MainWindow::beginJob(const QString& text, bool blockEditing) {
+    jobCancel_ = std::make_shared<std::atomic<bool>>(false);
+    editingBlocked_ = blockEditing;
+    actNew->setEnabled(false);
+    actOpen->setEnabled(false);
+    actSave->setEnabled(false);
+    if (blockEditing) {
+        view->setInteractive(false);
+        propDock->setEnabled(false);
+        drawGroup->setEnabled(false);
+        for (auto* a : {actDelete, actUnion, actIntersect, actSubtract, actXor, actUndo_, actRedo_}) a->setEnabled(false);
+    }
+    jobProgress_->setFormat(text + QStringLiteral(" %p%"));
+    jobProgress_->setRange(0, 1000);
+    jobProgress_->setValue(0);
+    jobProgress_->show();
+    jobCancelButton_->setEnabled(true);
+    jobCancelButton_->show();
+}
+
+void MainWindow::endJob() {
+    jobCancel_.reset();
+    if (editingBlocked_) {
+        view->setInteractive(true);
+        propDock->setEnabled(true);
+        drawGroup->setEnabled(true);
+        for (auto* a : {actDelete, actUnion, actIntersect, actSubtract, actXor}) a->setEnabled(true);
+        actUndo_->setEnabled(undo_->canUndo());
+        actRedo_->setEnabled(undo_->canRedo());
+        editingBlocked_ = false;
+    }
+    actNew->setEnabled(true);
+    actOpen->setEnabled(true);
+    actSave->setEnabled(true);
+    jobProgress_->hide();
+    jobCancelButton_->hide();
+}
+
+void MainWindow::setJobProgress(qint64 done, qint64 total) {
+    // 总量未知时显示忙碌状态
+    if (total <= 0) {
+        jobProgress_->setRange(0, 0);
+        return;
+    }
+    jobProgress_->setRange(0, 1000);
+    jobProgress_->setValue(static_cast<int>(std::min<qint64>(done, total) * 1000 / total));
 }
 
 void MainWindow::createPropertyDock() {
@@ -240,25 +354,76 @@ void MainWindow::createPropertyDock() {
     connect(scene, &DrawingScene::shapeMetricsChanged, propPanel, &PropertyPanel::refresh);
 }
 
+void MainWindow::createStatsDock() {
+    statsPanel = new StatsPanel(scene, view, this);
+    statsDock = new QDockWidget(tr("统计"), this);
+    statsDock->setWidget(statsPanel);
+    addDockWidget(Qt::RightDockWidgetArea, statsDock);
+    viewMenu_->addSeparator();
+    viewMenu_->addAction(statsDock->toggleViewAction());
+    // 文档、选区或几何变化后合并刷新；面板隐藏时不统计
+    connect(scene, &QGraphicsScene::selectionChanged, statsPanel, &StatsPanel::scheduleRecompute);
+    connect(scene, &DrawingScene::shapeMetricsChanged, statsPanel, &StatsPanel::scheduleRecompute);
+    connect(undo_, &QUndoStack::indexChanged, statsPanel, &StatsPanel::scheduleRecompute);
+    connect(statsDock, &QDockWidget::visibilityChanged, statsPanel, [p = statsPanel](bool visible) {
+        if (visible) p->scheduleRecompute();
+    });
+}
+
 void MainWindow::onNew() { statusBar()->showMessage(tr("新建工程（待实现）"), 2000); }
 void MainWindow::onSave() {
-    const auto path = QFileDialog::getSaveFileName(this, tr("保存为"), QString(), tr("FakeCAD JSON (*.json)"));
+    const auto path = QFileDialog::getSaveFileName(this, tr("保存为"), QString(), tr("FakeCAD JSON (*.json);;FakeCAD 二进制 (*.fcadb)"));
     if (path.isEmpty()) return;
+    saveDocument(path);
+}
+
+void MainWindow::saveDocument(const QString& path) {
     std::vector<Shape*> shapes;
-    for (auto* item : scene->items()) {
-        if (auto* si = dynamic_cast<ShapeItem*>(item)) {
-            // 同步项位置到模型（仅平移）
-            const auto p = si->pos();
-            si->model()->MoveTo(p.x(), p.y());
-            si->model()->setRotationDegrees(si->rotation());
-            shapes.push_back(si->model());
-        }
+    std::vector<quint64> ids;
+    // 按文档顺序（自下而上）保存，含停放在静态层中的图形
+    for (auto* si : scene->shapeItems()) {
+        // 同步项位置到模型（仅平移）
+        const auto p = si->pos();
+        si->model()->MoveTo(p.x(), p.y());
+        si->model()->setRotationDegrees(si->rotation());
+        shapes.push_back(si->model());
+        ids.push_back(si->shapeId());
     }
-    QString err;
-    if (Ser::SaveToFile(path, shapes, &err)) {
+    // 同步之后取列式快照，后台线程只读快照，编辑可以继续；此后的编辑同时记入以该文件为基准的新日志
+    auto store = std::make_shared<ShapeStore>(ShapeStore::FromShapes(shapes));
+    journal_->beginRebase(path, ids);
+    beginJob(tr("正在保存"), false);
+    QPointer<MainWindow> self(this);
+    auto cancel = jobCancel_;
+    QThreadPool::globalInstance()->start([self, cancel, store, path] {
+        QString err;
+        const bool ok = Ser::SaveToFile(path, *store, &err, QJsonDocument::Indented, [self, cancel](qint64 done, qint64 total) {
+            QMetaObject::invokeMethod(qApp, [self, cancel, done, total] {
+                if (self && self->jobCancel_ == cancel) self->setJobProgress(done, total);
+            }, Qt::QueuedConnection);
+            return !*cancel;
+        });
+        QMetaObject::invokeMethod(qApp, [self, cancel, path, ok, err] {
+            if (self && self->jobCancel_ == cancel) self->finishSave(path, ok, err);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::finishSave(const QString& path, bool ok, const QString& error) {
+    const bool cancelled = *jobCancel_;
+    endJob();
+    if (ok) {
+        QString journalError;
+        if (journal_->commitRebase(&journalError)) rememberJournal();
+        else statusBar()->showMessage(tr("无法写入编辑日志：%1").arg(journalError), 5000);
         statusBar()->showMessage(tr("已保存: %1").arg(path), 3000);
+        return;
+    }
+    journal_->abortRebase();
+    if (cancelled) {
+        statusBar()->showMessage(tr("已取消保存，原文件未改动"), 3000);
     } else {
-        QMessageBox::warning(this, tr("保存失败"), err);
+        QMessageBox::warning(this, tr("保存失败"), error);
     }
 }
 void MainWindow::onExit() { QApplication::quit(); }
@@ -266,20 +431,163 @@ void MainWindow::onAbout() {
     QMessageBox::about(this, tr("关于 FakeCAD"), tr("FakeCAD\nC++17 / CMake / Qt6"));
 }
 void MainWindow::onOpen() {
-    const auto path = QFileDialog::getOpenFileName(this, tr("打开"), QString(), tr("FakeCAD JSON (*.json)"));
+    const auto path = QFileDialog::getOpenFileName(this, tr("打开"), QString(), tr("FakeCAD 文档 (*.json *.fcadb);;FakeCAD JSON (*.json);;FakeCAD 二进制 (*.fcadb)"));
     if (path.isEmpty()) return;
+    openDocument(path);
+}
+
+void MainWindow::openDocument(const QString& path, std::shared_ptr<EditJournal::Contents> recovery) {
+    // 解析在后台线程进行（对象池线程安全）；图元须在 GUI 线程创建，完成后再替换当前文档
+    beginJob(recovery ? tr("正在恢复") : tr("正在打开"), true);
+    QPointer<MainWindow> self(this);
+    auto cancel = jobCancel_;
+    QThreadPool::globalInstance()->start([self, cancel, path, recovery] {
+        QString err;
+        auto shapes = std::make_shared<std::vector<std::unique_ptr<Shape>>>(
+            Ser::LoadFromFile(path, &err, [self, cancel](qint64 done, qint64 total) {
+                QMetaObject::invokeMethod(qApp, [self, cancel, done, total] {
+                    if (self && self->jobCancel_ == cancel) self->setJobProgress(done, total);
+                }, Qt::QueuedConnection);
+                return !*cancel;
+            }));
+        QMetaObject::invokeMethod(qApp, [self, cancel, path, shapes, err, recovery] {
+            if (self && self->jobCancel_ == cancel) self->finishOpen(path, *shapes, err, recovery);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::finishOpen(const QString& path, std::vector<std::unique_ptr<Shape>>& shapes, const QString& error,
+                            std::shared_ptr<EditJournal::Contents> recovery) {
+    if (*jobCancel_) {
+        endJob();
+        statusBar()->showMessage(recovery ? tr("已取消恢复") : tr("已取消打开"), 3000);
+        if (recovery) startJournal({});
+        return;
+    }
+    if (!error.isEmpty()) {
+        endJob();
+        QMessageBox::warning(this, recovery ? tr("恢复失败") : tr("打开失败"), error);
+        if (recovery) startJournal({});
+        return;
+    }
+    closeDocument(&shapes);
+    // 图元分批创建，其间界面保持响应（编辑仍被阻止，可取消）；全部加入后才开始日志
+    jobProgress_->setFormat(tr("正在加入图形") + QStringLiteral(" %p%"));
+    QPointer<MainWindow> self(this);
+    auto cancel = jobCancel_;
+    scene->addShapesInBatches(std::move(shapes), [self, cancel](qint64 done, qint64 total) {
+        if (self && self->jobCancel_ == cancel) self->setJobProgress(done, total);
+        return !*cancel;
+    }, [self, cancel, path, recovery](bool complete) {
+        if (!self || self->jobCancel_ != cancel) return;
+        self->endJob();
+        if (!complete) {
+            // 原文档已关闭：以空文档开始新的日志
+            self->closeDocument();
+            self->startJournal({});
+            self->statusBar()->showMessage(recovery ? tr("已取消恢复") : tr("已取消打开"), 3000);
+            return;
+        }
+        if (recovery) {
+            self->finishRecovery(*recovery);
+            return;
+        }
+        // 打开的文档按文件顺序编号为 1..N，即新日志的基准
+        std::vector<quint64> ids;
+        for (auto* si : self->scene->shapeItems()) ids.push_back(si->shapeId());
+        self->startJournal(path, ids);
+        self->statsPanel->scheduleRecompute();
+        self->statusBar()->showMessage(tr("已加载: %1").arg(path), 3000);
+    });
+}
+
+void MainWindow::startJournal(const QString& basePath, const std::vector<quint64>& baseIds) {
     QString err;
-    propPanel->clearTarget();
-    auto shapes = Ser::LoadFromFile(path, &err);
-    if (!err.isEmpty()) {
-        QMessageBox::warning(this, tr("打开失败"), err);
+    if (!journal_->start(basePath, baseIds, &err)) {
+        statusBar()->showMessage(tr("无法写入编辑日志：%1").arg(err), 5000);
+    }
+    rememberJournal();
+}
+
+void MainWindow::rememberJournal() {
+    QSettings settings(QStringLiteral("FakeCAD"), QStringLiteral("FakeCAD"));
+    if (journal_->isOpen()) settings.setValue(kJournalKey, journal_->path());
+    else settings.remove(kJournalKey);
+}
+
+void MainWindow::startSession() {
+    QSettings settings(QStringLiteral("FakeCAD"), QStringLiteral("FakeCAD"));
+    const QString journalPath = settings.value(kJournalKey).toString();
+    if (journalPath.isEmpty() || !QFile::exists(journalPath)) {
+        startJournal({});
+        return;
+    }
+    auto contents = std::make_shared<EditJournal::Contents>();
+    QString err;
+    const bool readable = EditJournal::Load(journalPath, *contents, &err);
+    // 没有编辑记录则无需恢复
+    if (readable && contents->records.empty()) {
+        QFile::remove(journalPath);
+        startJournal({});
         return;
     }
+    if (!readable) {
+        QMessageBox::warning(this, tr("无法恢复"), err);
+        startJournal({});
+        return;
+    }
+    const auto answer = QMessageBox::question(
+        this, tr("恢复"),
+        tr("上次会话未正常结束，编辑日志中有 %1 条未保存的编辑。是否恢复？").arg(contents->records.size()));
+    if (answer != QMessageBox::Yes) {
+        QFile::remove(journalPath);
+        startJournal({});
+        return;
+    }
+    if (contents->basePath.isEmpty()) {
+        closeDocument();
+        finishRecovery(*contents);
+    } else {
+        openDocument(contents->basePath, contents);
+    }
+}
+
+void MainWindow::finishRecovery(const EditJournal::Contents& contents) {
+    QString err;
+    if (!EditJournal::Replay(scene, contents, &err)) {
+        QMessageBox::warning(this, tr("恢复失败"), err);
+        closeDocument();
+        startJournal({});
+        return;
+    }
+    statsPanel->scheduleRecompute();
+    // 压缩：在后台把恢复后的文档完整保存为新基准，旧日志在保存完成后被新日志替换；
+    // 保存完成前旧日志仍然有效
+    const QString base = contents.basePath.isEmpty() ? EditJournal::UntitledBasePath() : contents.basePath;
+    saveDocument(base);
+    statusBar()->showMessage(tr("已按编辑日志恢复 %1 条编辑").arg(contents.records.size()), 5000);
+}
+
+void MainWindow::closeDocument(std::vector<std::unique_ptr<Shape>>* incoming) {
+    propPanel->clearTarget();
+    // 撤销命令持有图元指针，须先于场景清空
+    undo_->clear();
     scene->clear();
-    for (auto& sp : shapes) {
-        scene->addItem(new ShapeItem(std::move(sp)));
+    scene->resetShapeIds();
+    // 样式表随文档重置，旧文档与编辑中途驻留的样式不跨文档累积；载入的图形改写为新下标
+    // （此时载入已结束，保存与统计的后台任务只读各自的快照）
+    std::vector<quint32> styles;
+    if (incoming) {
+        styles.reserve(incoming->size());
+        for (const auto& s : *incoming) styles.push_back(s ? s->styleIndex() : StyleTable::kDefault);
+    }
+    StyleTable::instance().reset(styles);
+    if (incoming) {
+        for (size_t i = 0; i < incoming->size(); ++i) {
+            if (auto& s = (*incoming)[i]) s->setStyleIndex(styles[i]);
+        }
     }
-    statusBar()->showMessage(tr("已加载: %1").arg(path), 3000);
+    ObjectPool::Trim();
 }
 
 void MainWindow::updateViewDragMode() {
@@ -362,6 +670,20 @@ void MainWindow::onZoomIn() { view->zoomBy(1.15); }
 void MainWindow::onZoomOut() { view->zoomBy(1.0/1.15); }
 void MainWindow::onResetZoom() { view->resetZoom(); }
 
+void MainWindow::onLodThresholds() {
+    auto lod = scene->lodSettings();
+    bool ok = false;
+    const double point = QInputDialog::getDouble(this, tr("细节层次阈值"), tr("小于此尺寸（像素）的图形画为一个点，0 为关闭"),
+                                                 lod.pointSize, 0.0, 64.0, 1, &ok);
+    if (!ok) return;
+    const double aliased = QInputDialog::getDouble(this, tr("细节层次阈值"), tr("小于此尺寸（像素）的图形不开抗锯齿，0 为关闭"),
+                                                   lod.aliasedSize, 0.0, 256.0, 1, &ok);
+    if (!ok) return;
+    lod.pointSize = point;
+    lod.aliasedSize = aliased;
+    scene->setLodSettings(lod);
+}
+
 void MainWindow::onDelete() {
     propPanel->clearTarget();
     // 收集 JSON 快照
@@ -376,6 +698,74 @@ void MainWindow::onDelete() {
     }
 }
 
+namespace {
+
+// 图形轮廓的场景坐标环；不支持布尔运算的图形返回空
+PolygonBoolean::Ring sceneRing(const ShapeItem* item) {
+    PolygonBoolean::Ring ring;
+    const Shape* s = item->model();
+    switch (s->kind()) {
+    case ShapeKind::Polygon:
+        ring = static_cast<const Polygon*>(s)->points();
+        break;
+    case ShapeKind::Rectangle: {
+        const QRectF r = static_cast<const Rectangle*>(s)->rect().normalized();
+        ring = {r.topLeft(), r.topRight(), r.bottomRight(), r.bottomLeft()};
+        break;
+    }
+    case ShapeKind::Triangle: {
+        const auto* t = static_cast<const Triangle*>(s);
+        ring = {t->p1(), t->p2(), t->p3()};
+        break;
+    }
+    default:
+        return {};
+    }
+    for (auto& p : ring) p = item->mapToScene(p);
+    return ring;
+}
+
+} // namespace
+
+void MainWindow::runBoolean(int op, const QString& text) {
+    // 按堆叠次序自下而上依次运算
+    std::vector<ShapeItem*> operands;
+    std::vector<PolygonBoolean::Ring> rings;
+    for (auto* it : scene->items(Qt::AscendingOrder)) {
+        auto* si = it->isSelected() ? dynamic_cast<ShapeItem*>(it) : nullptr;
+        if (!si) continue;
+        auto ring = sceneRing(si);
+        if (ring.size() < 3) continue;
+        operands.push_back(si);
+        rings.push_back(std::move(ring));
+    }
+    if (operands.size() < 2) {
+        statusBar()->showMessage(tr("布尔运算需要选中至少两个多边形、矩形或三角形"), 3000);
+        return;
+    }
+
+    std::vector<PolygonBoolean::ResultRing> result;
+    PolygonBoolean::Region acc {rings.front()};
+    for (size_t i = 1; i < rings.size(); ++i) {
+        result = PolygonBoolean::Compute(acc, {rings[i]}, static_cast<PolygonBoolean::Op>(op));
+        acc = PolygonBoolean::ToRegion(result);
+    }
+
+    // Polygon 只有一个环：洞经桥边并入所属外环，每个外环一个多边形；沿用最下层对象的画笔与填充
+    const auto bridged = PolygonBoolean::BridgeHoles(result);
+    const Shape* base = operands.front()->model();
+    std::vector<QJsonObject> jsons;
+    jsons.reserve(bridged.size());
+    for (const auto& r : bridged) {
+        Polygon poly(r);
+        poly.setPen(base->pen());
+        poly.setColor(base->color());
+        jsons.push_back(poly.ToJson());
+    }
+    propPanel->clearTarget();
+    undo_->push(new UndoCmd::ReplaceShapesCommand(scene, operands, jsons, text));
+}
+
 void MainWindow::onSelectionChanged() {
     auto sel = scene->selectedItems();
     if (sel.isEmpty()) { propPanel->clearTarget(); return; }
@@ -394,7 +784,7 @@ bool MainWindow::eventFilter(QObject* obj, QEvent* event) {
         const bool isRedoKey = keyEvent->matches(QKeySequence::Redo)
             || (keyEvent->modifiers().testFlag(Qt::ControlModifier) && keyEvent->key() == Qt::Key_Y);
         if (isRedoKey) {
-            if (event->type() == QEvent::KeyPress) {
+            if (event->type() == QEvent::KeyPress && !editingBlocked_) {
                 undo_->redo();
             }
             event->accept();
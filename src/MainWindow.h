@@ -1,8 +1,14 @@
 #pragma once
 
 #include <QMainWindow>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "undo/EditJournal.h"
 
 class QEvent;
+class Shape;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -10,6 +16,9 @@ public:
     explicit MainWindow(QWidget* parent = nullptr);
     ~MainWindow() override;
 
+    // 开始编辑会话：上次会话异常结束时提示按编辑日志恢复，否则为空文档开启日志
+    void startSession();
+
 protected:
     bool eventFilter(QObject* obj, QEvent* event) override;
 private:
@@ -37,7 +46,13 @@ private:
     class QActionGroup* drawGroup{};
     QAction* actToggleGrid{};
     QAction* actSnapGrid{};
+    QAction* actLodSkipTiny{};
+    QAction* actLodThresholds{};
     QAction* actDelete{};
+    QAction* actUnion{};
+    QAction* actIntersect{};
+    QAction* actSubtract{};
+    QAction* actXor{};
     QAction* actAbout{};
 
     // ui builders
@@ -46,7 +61,30 @@ private:
     void createToolbars();
     void createStatusbar();
     void createPropertyDock();
+    void createStatsDock();
     void updateViewDragMode();
+    // 关闭当前文档：清空撤销栈与场景、重置样式表，并把空闲的对象池内存整体归还；
+    // incoming 为已载入、即将加入场景的图形，保留其样式
+    void closeDocument(std::vector<std::unique_ptr<Shape>>* incoming = nullptr);
+    // 对选中的多边形/矩形/三角形做布尔运算（int 为 PolygonBoolean::Op），结果替换运算对象
+    void runBoolean(int op, const QString& text);
+
+    // 后台打开/保存：状态栏显示进度条与取消按钮，期间禁用新建/打开/保存；
+    // blockEditing 时（打开）同时禁止编辑当前场景，因为它即将被替换
+    void beginJob(const QString& text, bool blockEditing);
+    void endJob();
+    void setJobProgress(qint64 done, qint64 total);
+    void openDocument(const QString& path, std::shared_ptr<EditJournal::Contents> recovery = nullptr);
+    void finishOpen(const QString& path, std::vector<std::unique_ptr<Shape>>& shapes, const QString& error,
+                    std::shared_ptr<EditJournal::Contents> recovery);
+    void saveDocument(const QString& path);
+    void finishSave(const QString& path, bool ok, const QString& error);
+
+    // 编辑日志：以 basePath（空为空文档）为基准开启新日志，并记下其路径供下次启动检查
+    void startJournal(const QString& basePath, const std::vector<quint64>& baseIds = {});
+    void rememberJournal();
+    // 恢复：基准文档已载入场景后回放日志，再在后台保存为新基准（压缩）
+    void finishRecovery(const EditJournal::Contents& contents);
 
 private slots:
     void onNew();
@@ -65,11 +103,25 @@ private slots:
     void onZoomIn();
     void onZoomOut();
     void onResetZoom();
+    void onLodThresholds();
     void onDelete();
     void onSelectionChanged();
 
 private:
     class PropertyPanel* propPanel{};
     class QDockWidget* propDock{};
+    class StatsPanel* statsPanel{};
+    class QDockWidget* statsDock{};
+    class QMenu* viewMenu_{};
     class QUndoStack* undo_{};
+    QAction* actUndo_{};
+    QAction* actRedo_{};
+
+    // 当前后台任务的取消标志（工作线程轮询）；无任务时为空。回调按该指针识别过期的投递
+    std::shared_ptr<std::atomic<bool>> jobCancel_;
+    bool editingBlocked_{false};
+    class QProgressBar* jobProgress_{};
+    class QPushButton* jobCancelButton_{};
+
+    std::unique_ptr<EditJournal> journal_;
 };
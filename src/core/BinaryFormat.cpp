@@ -0,0 +1,232 @@
+#include "BinaryFormat.h"
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include <QIODevice>
+#include <QObject>
+
+#include "ShapeStore.h"
+
+using namespace BinaryFormat;
+
+namespace {
+
+// 各列按内存布局原样读写，要求主机为小端、qreal 为 double
+constexpr bool kNativeLayout = Q_BYTE_ORDER == Q_LITTLE_ENDIAN && sizeof(qreal) == 8;
+
+static_assert(std::is_trivially_copyable_v<ShapeStore::Style> && sizeof(ShapeStore::Style) == 16);
+static_assert(std::is_trivially_copyable_v<QPointF> && std::is_trivially_copyable_v<QRectF>);
+
+// 磁盘上的区间固定为 (i64 begin, i64 count)
+struct DiskRange {
+    qint64 begin;
+    qint64 count;
+};
+
+qint64 alignUp(qint64 v) { return (v + kAlignment - 1) & ~(kAlignment - 1); }
+
+struct Chunk {
+    Section id;
+    quint32 elementSize;
+    const void* data;
+    quint64 count;
+};
+
+template <class T> Chunk chunk(Section id, const std::vector<T>& v) {
+    return {id, static_cast<quint32>(sizeof(T)), v.data(), static_cast<quint64>(v.size())};
+}
+
+std::vector<DiskRange> toDisk(const std::vector<ShapeStore::VertexRange>& ranges) {
+    std::vector<DiskRange> out;
+    out.reserve(ranges.size());
+    for (const auto& r : ranges) out.push_back({static_cast<qint64>(r.begin), static_cast<qint64>(r.count)});
+    return out;
+}
+
+// 映射内存中的一段（已校验边界与元素大小）
+struct View {
+    const uchar* data {nullptr};
+    quint64 count {0};
+};
+
+template <class T> void assignColumn(std::vector<T>& dst, const View& v) {
+    dst.resize(static_cast<size_t>(v.count));
+    if (v.count) std::memcpy(dst.data(), v.data, static_cast<size_t>(v.count) * sizeof(T));
+}
+
+} // namespace
+
+bool ShapeStore::writeBinary(QIODevice& out, QString* error) const {
+    if (!kNativeLayout) {
+        if (error) *error = QObject::tr("当前平台不支持 .fcadb 格式");
+        return false;
+    }
+    const auto rows = static_cast<size_t>(size());
+
+    // 名称：UTF-8 拼接 + 偏移表；大多数图形无名称，只占一个偏移
+    std::vector<quint32> nameOffsets(rows + 1, 0);
+    std::vector<char> nameData;
+    for (size_t row = 0; row < rows; ++row) {
+        if (!name_[row].isEmpty()) {
+            const QByteArray utf8 = name_[row].toUtf8();
+            nameData.insert(nameData.end(), utf8.cbegin(), utf8.cend());
+        }
+        nameOffsets[row + 1] = static_cast<quint32>(nameData.size());
+    }
+    const auto polygonRanges = toDisk(polygonRanges_);
+    const auto polylineRanges = toDisk(polylineRanges_);
+
+    const Chunk chunks[] = {
+        chunk(Section::Styles, styles_),
+        chunk(Section::Kinds, kind_),
+        chunk(Section::Slots, slot_),
+        chunk(Section::StyleIndex, styleIndex_),
+        chunk(Section::Tx, tx_),
+        chunk(Section::Ty, ty_),
+        chunk(Section::Rotation, rot_),
+        chunk(Section::NameOffsets, nameOffsets),
+        chunk(Section::NameData, nameData),
+        chunk(Section::Segments, segments_),
+        chunk(Section::Rects, rects_),
+        chunk(Section::Circles, circles_),
+        chunk(Section::Ellipses, ellipses_),
+        chunk(Section::Triangles, triangles_),
+        chunk(Section::PolygonRanges, polygonRanges),
+        chunk(Section::PolylineRanges, polylineRanges),
+        chunk(Section::Vertices, vertices_),
+    };
+    constexpr quint32 kChunkCount = sizeof(chunks) / sizeof(chunks[0]);
+
+    std::vector<SectionEntry> entries;
+    entries.reserve(kChunkCount);
+    qint64 pos = static_cast<qint64>(sizeof(Header) + kChunkCount * sizeof(SectionEntry));
+    for (const auto& c : chunks) {
+        pos = alignUp(pos);
+        entries.push_back({static_cast<quint32>(c.id), c.elementSize, static_cast<quint64>(pos), c.count});
+        pos += static_cast<qint64>(c.count * c.elementSize);
+    }
+
+    Header h {};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.sectionCount = kChunkCount;
+    h.rowCount = rows;
+    h.fileSize = static_cast<quint64>(pos);
+
+    auto put = [&](const void* p, qint64 n) {
+        return n == 0 || out.write(static_cast<const char*>(p), n) == n;
+    };
+    bool ok = put(&h, sizeof(h)) && put(entries.data(), static_cast<qint64>(entries.size() * sizeof(SectionEntry)));
+    qint64 written = static_cast<qint64>(sizeof(Header) + entries.size() * sizeof(SectionEntry));
+    static const char kZeros[kAlignment] = {};
+    for (quint32 i = 0; ok && i < kChunkCount; ++i) {
+        const qint64 offset = static_cast<qint64>(entries[i].offset);
+        ok = put(kZeros, offset - written);
+        const qint64 bytes = static_cast<qint64>(chunks[i].count * chunks[i].elementSize);
+        ok = ok && put(chunks[i].data, bytes);
+        written = offset + bytes;
+    }
+    if (!ok && error) *error = out.errorString();
+    return ok;
+}
+
+bool ShapeStore::ReadBinary(const uchar* data, qint64 size, ShapeStore& out, QString* error) {
+    auto fail = [&](const QString& msg) {
+        if (error) *error = msg;
+        return false;
+    };
+    if (!kNativeLayout) return fail(QObject::tr("当前平台不支持 .fcadb 格式"));
+    if (!data || size < static_cast<qint64>(sizeof(Header))) return fail(QObject::tr("文件不完整"));
+
+    Header h;
+    std::memcpy(&h, data, sizeof(h));
+    if (!std::equal(kMagic, kMagic + 8, h.magic)) return fail(QObject::tr("不是 .fcadb 文件"));
+    if (h.version != kVersion) return fail(QObject::tr("不支持的 .fcadb 版本：%1").arg(h.version));
+    if (h.fileSize != static_cast<quint64>(size)) return fail(QObject::tr("文件长度不符（可能已截断）"));
+    const quint64 tableEnd = sizeof(Header) + static_cast<quint64>(h.sectionCount) * sizeof(SectionEntry);
+    if (h.sectionCount > 1024 || tableEnd > static_cast<quint64>(size)) return fail(QObject::tr("段表损坏"));
+
+    // 段表：按 id 取段并校验元素大小、对齐与边界；缺失的段视为空
+    std::vector<SectionEntry> entries(h.sectionCount);
+    std::memcpy(entries.data(), data + sizeof(Header), entries.size() * sizeof(SectionEntry));
+    bool bad = false;
+    auto section = [&](Section id, size_t elementSize) {
+        for (const auto& e : entries) {
+            if (e.id != static_cast<quint32>(id)) continue;
+            const bool fits = e.elementSize == elementSize && e.offset % kAlignment == 0
+                && e.offset <= static_cast<quint64>(size)
+                && e.count <= (static_cast<quint64>(size) - e.offset) / elementSize;
+            if (!fits) { bad = true; return View{}; }
+            return View{data + e.offset, e.count};
+        }
+        return View{};
+    };
+
+    ShapeStore s;
+    assignColumn(s.styles_, section(Section::Styles, sizeof(Style)));
+    assignColumn(s.kind_, section(Section::Kinds, sizeof(ShapeKind)));
+    assignColumn(s.slot_, section(Section::Slots, sizeof(quint32)));
+    assignColumn(s.styleIndex_, section(Section::StyleIndex, sizeof(quint32)));
+    assignColumn(s.tx_, section(Section::Tx, sizeof(double)));
+    assignColumn(s.ty_, section(Section::Ty, sizeof(double)));
+    assignColumn(s.rot_, section(Section::Rotation, sizeof(double)));
+    assignColumn(s.segments_, section(Section::Segments, sizeof(SegmentGeom)));
+    assignColumn(s.rects_, section(Section::Rects, sizeof(QRectF)));
+    assignColumn(s.circles_, section(Section::Circles, sizeof(CircleGeom)));
+    assignColumn(s.ellipses_, section(Section::Ellipses, sizeof(EllipseGeom)));
+    assignColumn(s.triangles_, section(Section::Triangles, sizeof(TriangleGeom)));
+    assignColumn(s.vertices_, section(Section::Vertices, sizeof(QPointF)));
+    std::vector<DiskRange> polygonRanges, polylineRanges;
+    std::vector<quint32> nameOffsets;
+    assignColumn(polygonRanges, section(Section::PolygonRanges, sizeof(DiskRange)));
+    assignColumn(polylineRanges, section(Section::PolylineRanges, sizeof(DiskRange)));
+    assignColumn(nameOffsets, section(Section::NameOffsets, sizeof(quint32)));
+    const View nameData = section(Section::NameData, 1);
+    if (bad) return fail(QObject::tr("段表损坏"));
+
+    const auto rows = static_cast<size_t>(h.rowCount);
+    if (s.kind_.size() != rows || s.slot_.size() != rows || s.styleIndex_.size() != rows || s.tx_.size() != rows
+        || s.ty_.size() != rows || s.rot_.size() != rows || nameOffsets.size() != rows + 1) {
+        return fail(QObject::tr("列长度与图形数不符"));
+    }
+
+    // 区间与下标都要落在各自的表内，损坏的文件不能导致越界访问
+    const auto vertexCount = static_cast<qint64>(s.vertices_.size());
+    auto convertRanges = [&](const std::vector<DiskRange>& in, std::vector<VertexRange>& dst) {
+        dst.reserve(in.size());
+        for (const auto& r : in) {
+            if (r.begin < 0 || r.count < 0 || r.begin > vertexCount || r.count > vertexCount - r.begin) return false;
+            dst.push_back({static_cast<qsizetype>(r.begin), static_cast<qsizetype>(r.count)});
+        }
+        return true;
+    };
+    if (!convertRanges(polygonRanges, s.polygonRanges_) || !convertRanges(polylineRanges, s.polylineRanges_)) {
+        return fail(QObject::tr("顶点区间越界"));
+    }
+    for (size_t row = 0; row < rows; ++row) {
+        size_t tableSize = 0;
+        switch (s.kind_[row]) {
+        case ShapeKind::LineSegment: tableSize = s.segments_.size(); break;
+        case ShapeKind::Rectangle: tableSize = s.rects_.size(); break;
+        case ShapeKind::Circle: tableSize = s.circles_.size(); break;
+        case ShapeKind::Ellipse: tableSize = s.ellipses_.size(); break;
+        case ShapeKind::Triangle: tableSize = s.triangles_.size(); break;
+        case ShapeKind::Polygon: tableSize = s.polygonRanges_.size(); break;
+        case ShapeKind::Polyline: tableSize = s.polylineRanges_.size(); break;
+        default: return fail(QObject::tr("未知图形类型"));
+        }
+        if (s.slot_[row] >= tableSize || s.styleIndex_[row] >= s.styles_.size()) return fail(QObject::tr("图形记录损坏"));
+    }
+
+    s.name_.resize(rows);
+    for (size_t row = 0; row < rows; ++row) {
+        const quint32 b = nameOffsets[row], e = nameOffsets[row + 1];
+        if (b > e || e > nameData.count) return fail(QObject::tr("名称表损坏"));
+        if (e > b) s.name_[row] = QString::fromUtf8(reinterpret_cast<const char*>(nameData.data) + b, e - b);
+    }
+
+    for (quint32 i = 0; i < s.styles_.size(); ++i) s.styleLookup_.insert(s.styles_[i], i);
+    out = std::move(s);
+    return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+#include <QByteArray>
+#include <QtGlobal>
+
+// .fcadb 二进制文档格式（版本 1，小端）——ShapeStore 各列的原样快照：
+//
+//   Header       magic "FCADBIN\0" | u32 version | u32 sectionCount | u64 rowCount | u64 fileSize
+//   SectionEntry u32 id | u32 elementSize | u64 offset | u64 count        （紧随头部，sectionCount 项）
+//   Section      count * elementSize 字节，起始偏移按 8 字节对齐
+//
+// 通用列（类型/类型表下标/样式下标/平移/旋转）与各类型几何表均为定长元素的连续数组，
+// 多边形与折线的顶点放在同一块 f64 (x, y) 缓冲中，由区间表引用；样式去重后存为共享样式表。
+// 读取时以 QFile::map 映射整个文件，各段按块复制回 ShapeStore 的列，不逐点解析。
+// JSON 仍是交换格式；.fcadb 面向大文档的快速保存/打开。
+namespace BinaryFormat {
+
+constexpr char kMagic[8] = {'F', 'C', 'A', 'D', 'B', 'I', 'N', '\0'};
+constexpr quint32 kVersion = 1;
+constexpr qint64 kAlignment = 8;
+
+enum class Section : quint32 {
+    Styles = 1,     // {u32 color, u32 penColor, f64 penWidth}
+    Kinds,          // u8 ShapeKind
+    Slots,          // u32 类型表下标
+    StyleIndex,     // u32 样式表下标
+    Tx,             // f64
+    Ty,             // f64
+    Rotation,       // f64（度）
+    NameOffsets,    // u32 * (rowCount + 1)，指向 NameData 的 UTF-8 区间
+    NameData,       // u8
+    Segments,       // f64 * 4
+    Rects,          // f64 * 4 (x, y, w, h)
+    Circles,        // f64 * 3 (cx, cy, r)
+    Ellipses,       // f64 * 4 (cx, cy, rx, ry)
+    Triangles,      // f64 * 6
+    PolygonRanges,  // i64 * 2 (begin, count)，单位为顶点
+    PolylineRanges, // i64 * 2
+    Vertices,       // f64 * 2
+};
+
+#pragma pack(push, 1)
+struct Header {
+    char magic[8];
+    quint32 version;
+    quint32 sectionCount;
+    quint64 rowCount;
+    quint64 fileSize;
+};
+struct SectionEntry {
+    quint32 id;
+    quint32 elementSize;
+    quint64 offset;
+    quint64 count;
+};
+#pragma pack(pop)
+static_assert(sizeof(Header) == 32 && sizeof(SectionEntry) == 24, "fixed on-disk layout");
+
+// 按文件开头的字节判断是否为 .fcadb（不足 8 字节时为 false）
+inline bool IsBinary(const QByteArray& head) {
+    return head.size() >= 8 && std::equal(kMagic, kMagic + 8, head.constData());
+}
+
+} // namespace BinaryFormat
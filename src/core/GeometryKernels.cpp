@@ -0,0 +1,287 @@
+#include "GeometryKernels.h"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FAKECAD_KERNELS_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define FAKECAD_TARGET_AVX2
+#else
+#define FAKECAD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace Kernels {
+namespace {
+
+// 补偿累加器（Knuth TwoSum，无分支，与求和顺序无关地保留每步舍入误差）
+struct Accum {
+    double sum = 0.0;
+    double comp = 0.0;
+    void add(double v) {
+        const double t = sum + v;
+        const double bp = t - sum;
+        comp += (sum - (t - bp)) + (v - bp);
+        sum = t;
+    }
+    double value() const { return sum + comp; }
+};
+
+// ---------------- 标量 ----------------
+
+double pathLengthScalar(const double* xy, std::size_t n, Accum& acc) {
+    for (std::size_t i = 1; i < n; ++i) {
+        const double dx = xy[2 * i] - xy[2 * i - 2];
+        const double dy = xy[2 * i + 1] - xy[2 * i - 1];
+        acc.add(std::sqrt(dx * dx + dy * dy));
+    }
+    return acc.value();
+}
+
+// 累加 [first, n-1) 段上相对 (ox, oy) 的叉积
+void crossSumScalar(const double* xy, std::size_t first, std::size_t n, double ox, double oy, Accum& acc) {
+    for (std::size_t i = first; i + 1 < n; ++i) {
+        const double ax = xy[2 * i] - ox, ay = xy[2 * i + 1] - oy;
+        const double bx = xy[2 * i + 2] - ox, by = xy[2 * i + 3] - oy;
+        acc.add(ax * by - bx * ay);
+    }
+}
+
+#ifdef FAKECAD_KERNELS_X86
+
+// ---------------- SSE2：每次处理 2 段 ----------------
+
+struct AccumSse2 {
+    __m128d sum = _mm_setzero_pd();
+    __m128d comp = _mm_setzero_pd();
+    void add(__m128d v) {
+        const __m128d t = _mm_add_pd(sum, v);
+        const __m128d bp = _mm_sub_pd(t, sum);
+        const __m128d err = _mm_add_pd(_mm_sub_pd(sum, _mm_sub_pd(t, bp)), _mm_sub_pd(v, bp));
+        comp = _mm_add_pd(comp, err);
+        sum = t;
+    }
+    void reduceInto(Accum& acc) const {
+        alignas(16) double s[2], c[2];
+        _mm_store_pd(s, sum);
+        _mm_store_pd(c, comp);
+        acc.add(s[0]);
+        acc.add(s[1]);
+        acc.comp += c[0] + c[1];
+    }
+};
+
+// 返回已处理到的点下标（其后的段交给标量收尾）
+std::size_t pathLengthSse2(const double* xy, std::size_t n, Accum& acc) {
+    AccumSse2 v;
+    std::size_t i = 0;
+    for (; i + 2 < n; i += 2) {
+        const __m128d p0 = _mm_loadu_pd(xy + 2 * i);
+        const __m128d p1 = _mm_loadu_pd(xy + 2 * i + 2);
+        const __m128d p2 = _mm_loadu_pd(xy + 2 * i + 4);
+        const __m128d d0 = _mm_sub_pd(p1, p0);
+        const __m128d d1 = _mm_sub_pd(p2, p1);
+        const __m128d dx = _mm_unpacklo_pd(d0, d1);
+        const __m128d dy = _mm_unpackhi_pd(d0, d1);
+        v.add(_mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+    }
+    v.reduceInto(acc);
+    return i;
+}
+
+std::size_t crossSumSse2(const double* xy, std::size_t n, double ox, double oy, Accum& acc) {
+    const __m128d o = _mm_set_pd(oy, ox);
+    AccumSse2 v;
+    std::size_t i = 0;
+    for (; i + 2 < n; i += 2) {
+        const __m128d p0 = _mm_sub_pd(_mm_loadu_pd(xy + 2 * i), o);
+        const __m128d p1 = _mm_sub_pd(_mm_loadu_pd(xy + 2 * i + 2), o);
+        const __m128d p2 = _mm_sub_pd(_mm_loadu_pd(xy + 2 * i + 4), o);
+        const __m128d ax = _mm_unpacklo_pd(p0, p1), ay = _mm_unpackhi_pd(p0, p1);
+        const __m128d bx = _mm_unpacklo_pd(p1, p2), by = _mm_unpackhi_pd(p1, p2);
+        v.add(_mm_sub_pd(_mm_mul_pd(ax, by), _mm_mul_pd(bx, ay)));
+    }
+    v.reduceInto(acc);
+    return i;
+}
+
+// ---------------- AVX2：每次处理 4 段 ----------------
+// unpacklo/unpackhi 在 256 位下按 128 位通道交错，车道顺序为 [0,2,1,3]；
+// 起点与终点使用相同的重排，每个车道仍对应同一条边，求和与顺序无关。
+
+struct AccumAvx {
+    __m256d sum;
+    __m256d comp;
+};
+
+FAKECAD_TARGET_AVX2 inline void avxAdd(AccumAvx& a, __m256d v) {
+    const __m256d t = _mm256_add_pd(a.sum, v);
+    const __m256d bp = _mm256_sub_pd(t, a.sum);
+    const __m256d err = _mm256_add_pd(_mm256_sub_pd(a.sum, _mm256_sub_pd(t, bp)), _mm256_sub_pd(v, bp));
+    a.comp = _mm256_add_pd(a.comp, err);
+    a.sum = t;
+}
+
+FAKECAD_TARGET_AVX2 inline void avxReduce(const AccumAvx& a, Accum& acc) {
+    alignas(32) double s[4], c[4];
+    _mm256_store_pd(s, a.sum);
+    _mm256_store_pd(c, a.comp);
+    for (int k = 0; k < 4; ++k) acc.add(s[k]);
+    acc.comp += (c[0] + c[1]) + (c[2] + c[3]);
+}
+
+FAKECAD_TARGET_AVX2 std::size_t pathLengthAvx2(const double* xy, std::size_t n, Accum& acc) {
+    AccumAvx v{_mm256_setzero_pd(), _mm256_setzero_pd()};
+    std::size_t i = 0;
+    for (; i + 4 < n; i += 4) {
+        const double* p = xy + 2 * i;
+        const __m256d a01 = _mm256_loadu_pd(p);
+        const __m256d a23 = _mm256_loadu_pd(p + 4);
+        const __m256d b01 = _mm256_loadu_pd(p + 2);
+        const __m256d b23 = _mm256_loadu_pd(p + 6);
+        const __m256d d01 = _mm256_sub_pd(b01, a01);
+        const __m256d d23 = _mm256_sub_pd(b23, a23);
+        const __m256d dx = _mm256_unpacklo_pd(d01, d23);
+        const __m256d dy = _mm256_unpackhi_pd(d01, d23);
+        avxAdd(v, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+    }
+    avxReduce(v, acc);
+    return i;
+}
+
+FAKECAD_TARGET_AVX2 std::size_t crossSumAvx2(const double* xy, std::size_t n, double ox, double oy, Accum& acc) {
+    const __m256d o = _mm256_set_pd(oy, ox, oy, ox);
+    AccumAvx v{_mm256_setzero_pd(), _mm256_setzero_pd()};
+    std::size_t i = 0;
+    for (; i + 4 < n; i += 4) {
+        const double* p = xy + 2 * i;
+        const __m256d a01 = _mm256_sub_pd(_mm256_loadu_pd(p), o);
+        const __m256d a23 = _mm256_sub_pd(_mm256_loadu_pd(p + 4), o);
+        const __m256d b01 = _mm256_sub_pd(_mm256_loadu_pd(p + 2), o);
+        const __m256d b23 = _mm256_sub_pd(_mm256_loadu_pd(p + 6), o);
+        const __m256d ax = _mm256_unpacklo_pd(a01, a23), ay = _mm256_unpackhi_pd(a01, a23);
+        const __m256d bx = _mm256_unpacklo_pd(b01, b23), by = _mm256_unpackhi_pd(b01, b23);
+        avxAdd(v, _mm256_sub_pd(_mm256_mul_pd(ax, by), _mm256_mul_pd(bx, ay)));
+    }
+    avxReduce(v, acc);
+    return i;
+}
+
+bool cpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] < 7) return false;
+    __cpuid(r, 1);
+    const bool osxsave = (r[2] & (1 << 27)) != 0;
+    const bool avx = (r[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false; // OS 保存 XMM/YMM 状态
+    __cpuidex(r, 7, 0);
+    return (r[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // FAKECAD_KERNELS_X86
+
+// 折线长度：向量段处理主体，标量处理剩余段
+double pathLength(const double* xy, std::size_t n, Isa isa, Accum& acc) {
+    std::size_t done = 0;
+#ifdef FAKECAD_KERNELS_X86
+    if (isa == Isa::AVX2) done = pathLengthAvx2(xy, n, acc);
+    else if (isa == Isa::SSE2) done = pathLengthSse2(xy, n, acc);
+#else
+    (void)isa;
+#endif
+    return pathLengthScalar(xy + 2 * done, n - done, acc);
+}
+
+void crossSum(const double* xy, std::size_t n, double ox, double oy, Isa isa, Accum& acc) {
+    std::size_t done = 0;
+#ifdef FAKECAD_KERNELS_X86
+    if (isa == Isa::AVX2) done = crossSumAvx2(xy, n, ox, oy, acc);
+    else if (isa == Isa::SSE2) done = crossSumSse2(xy, n, ox, oy, acc);
+#else
+    (void)isa;
+    (void)ox;
+    (void)oy;
+#endif
+    crossSumScalar(xy, done, n, ox, oy, acc);
+}
+
+Isa resolve(Isa isa) { return IsaSupported(isa) ? isa : Isa::Scalar; }
+
+} // namespace
+
+bool IsaSupported(Isa isa) {
+    switch (isa) {
+    case Isa::Scalar: return true;
+#ifdef FAKECAD_KERNELS_X86
+    case Isa::SSE2: return true; // x86-64 基线
+    case Isa::AVX2: {
+        static const bool has = cpuHasAvx2();
+        return has;
+    }
+#else
+    case Isa::SSE2:
+    case Isa::AVX2: return false;
+#endif
+    }
+    return false;
+}
+
+Isa ActiveIsa() {
+    static const Isa isa = IsaSupported(Isa::AVX2) ? Isa::AVX2
+                         : IsaSupported(Isa::SSE2) ? Isa::SSE2
+                         : Isa::Scalar;
+    return isa;
+}
+
+const char* IsaName(Isa isa) {
+    switch (isa) {
+    case Isa::Scalar: return "scalar";
+    case Isa::SSE2: return "sse2";
+    case Isa::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+double SignedPolygonArea(const double* xy, std::size_t n, Isa isa) {
+    if (n < 3) return 0.0;
+    // 以首点为原点：闭合边 (n-1 -> 0) 的叉积恒为 0，无需单独累加
+    Accum acc;
+    crossSum(xy, n, xy[0], xy[1], resolve(isa), acc);
+    return acc.value() * 0.5;
+}
+
+double PolygonArea(const double* xy, std::size_t n, Isa isa) {
+    return std::abs(SignedPolygonArea(xy, n, isa));
+}
+
+double PolygonPerimeter(const double* xy, std::size_t n, Isa isa) {
+    if (n < 2) return 0.0;
+    Accum acc;
+    pathLength(xy, n, resolve(isa), acc);
+    const double dx = xy[0] - xy[2 * n - 2];
+    const double dy = xy[1] - xy[2 * n - 1];
+    acc.add(std::sqrt(dx * dx + dy * dy));
+    return acc.value();
+}
+
+double PathLength(const double* xy, std::size_t n, Isa isa) {
+    if (n < 2) return 0.0;
+    Accum acc;
+    return pathLength(xy, n, resolve(isa), acc);
+}
+
+double PolygonArea(const double* xy, std::size_t n) { return PolygonArea(xy, n, ActiveIsa()); }
+double SignedPolygonArea(const double* xy, std::size_t n) { return SignedPolygonArea(xy, n, ActiveIsa()); }
+double PolygonPerimeter(const double* xy, std::size_t n) { return PolygonPerimeter(xy, n, ActiveIsa()); }
+double PathLength(const double* xy, std::size_t n) { return PathLength(xy, n, ActiveIsa()); }
+
+} // namespace Kernels
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+
+// 几何度量内核（不依赖 Qt）：
+// - 输入为交错存放的坐标 xy = [x0, y0, x1, y1, ...]，n 为点数；QPointF 数组可直接按此解释；
+// - 提供标量 / SSE2 / AVX2 三种实现，运行时按 CPU 能力选择；
+// - 求和均使用补偿求和（TwoSum），面积先平移到首点再做叉积，大坐标下精度不退化。
+namespace Kernels {
+
+enum class Isa { Scalar, SSE2, AVX2 };
+
+// 当前 CPU 支持该实现（Scalar 总是支持）
+bool IsaSupported(Isa isa);
+// 自动选择时使用的实现
+Isa ActiveIsa();
+const char* IsaName(Isa isa);
+
+// 闭合多边形面积（绝对值）；n < 3 时为 0
+double PolygonArea(const double* xy, std::size_t n);
+// 有向面积（y 轴向下的屏幕坐标中顺时针为正）；n < 3 时为 0
+double SignedPolygonArea(const double* xy, std::size_t n);
+// 闭合多边形周长（含末点到首点的闭合边）；n < 2 时为 0
+double PolygonPerimeter(const double* xy, std::size_t n);
+// 折线路径长度（相邻点距离之和）；n < 2 时为 0
+double PathLength(const double* xy, std::size_t n);
+
+// 指定实现（测试与基准用）；isa 不受支持时退回标量
+double PolygonArea(const double* xy, std::size_t n, Isa isa);
+double SignedPolygonArea(const double* xy, std::size_t n, Isa isa);
+double PolygonPerimeter(const double* xy, std::size_t n, Isa isa);
+double PathLength(const double* xy, std::size_t n, Isa isa);
+
+} // namespace Kernels
@@ -0,0 +1,156 @@
+#include "HitTest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "shapes/LineSegment.h"
+#include "shapes/Rectangle.h"
+#include "shapes/Circle.h"
+#include "shapes/Triangle.h"
+#include "shapes/Polygon.h"
+#include "shapes/Polyline.h"
+#include "shapes/Ellipse.h"
+
+namespace {
+
+// 第一象限点 (y0, y1) 到半轴 e0 >= e1 > 0 的椭圆的距离（Eberly 的二分求根法）
+double ellipseDistanceFirstQuadrant(double e0, double e1, double y0, double y1) {
+    if (y1 > 0.0) {
+        if (y0 > 0.0) {
+            const double z0 = y0 / e0, z1 = y1 / e1;
+            double g = z0 * z0 + z1 * z1 - 1.0;
+            if (g == 0.0) return 0.0;
+            const double r0 = (e0 / e1) * (e0 / e1);
+            const double n0 = r0 * z0;
+            double s0 = z1 - 1.0;
+            double s1 = (g < 0.0) ? 0.0 : std::hypot(n0, z1) - 1.0;
+            double s = 0.0;
+            for (int i = 0; i < 160; ++i) {
+                s = 0.5 * (s0 + s1);
+                if (s == s0 || s == s1) break;
+                const double ratio0 = n0 / (s + r0), ratio1 = z1 / (s + 1.0);
+                g = ratio0 * ratio0 + ratio1 * ratio1 - 1.0;
+                if (g > 0.0) s0 = s;
+                else if (g < 0.0) s1 = s;
+                else break;
+            }
+            const double x0 = r0 * y0 / (s + r0), x1 = y1 / (s + 1.0);
+            return std::hypot(x0 - y0, x1 - y1);
+        }
+        return std::abs(y1 - e1);
+    }
+    const double numer0 = e0 * y0, denom0 = e0 * e0 - e1 * e1;
+    if (numer0 < denom0) {
+        const double xde0 = numer0 / denom0;
+        const double x0 = e0 * xde0, x1 = e1 * std::sqrt(std::max(0.0, 1.0 - xde0 * xde0));
+        return std::hypot(x0 - y0, x1);
+    }
+    return std::abs(y0 - e0);
+}
+
+bool inEllipse(const QPointF& p, const QPointF& c, double rx, double ry) {
+    if (rx <= 0.0 || ry <= 0.0) return false;
+    const double u = (p.x() - c.x()) / rx, v = (p.y() - c.y()) / ry;
+    return u * u + v * v <= 1.0;
+}
+
+} // namespace
+
+namespace HitTest {
+
+double PointSegmentDistance(const QPointF& p, const QPointF& a, const QPointF& b) {
+    const double dx = b.x() - a.x(), dy = b.y() - a.y();
+    const double len2 = dx * dx + dy * dy;
+    double t = 0.0;
+    if (len2 > 0.0) t = std::clamp(((p.x() - a.x()) * dx + (p.y() - a.y()) * dy) / len2, 0.0, 1.0);
+    return std::hypot(p.x() - (a.x() + t * dx), p.y() - (a.y() + t * dy));
+}
+
+double PointPathDistance(const QPointF& p, const QPointF* pts, qsizetype n, bool closed) {
+    if (n <= 0) return std::numeric_limits<double>::infinity();
+    if (n == 1) return std::hypot(p.x() - pts[0].x(), p.y() - pts[0].y());
+    double best = std::numeric_limits<double>::infinity();
+    for (qsizetype i = 1; i < n; ++i) best = std::min(best, PointSegmentDistance(p, pts[i - 1], pts[i]));
+    if (closed && n > 2) best = std::min(best, PointSegmentDistance(p, pts[n - 1], pts[0]));
+    return best;
+}
+
+bool PointInPolygon(const QPointF& p, const QPointF* pts, qsizetype n) {
+    bool inside = false;
+    for (qsizetype i = 0, j = n - 1; i < n; j = i++) {
+        const QPointF& a = pts[i];
+        const QPointF& b = pts[j];
+        if ((a.y() > p.y()) != (b.y() > p.y())
+            && p.x() < (b.x() - a.x()) * (p.y() - a.y()) / (b.y() - a.y()) + a.x()) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+double PointEllipseDistance(const QPointF& p, const QPointF& center, double rx, double ry) {
+    rx = std::abs(rx);
+    ry = std::abs(ry);
+    double y0 = std::abs(p.x() - center.x()), y1 = std::abs(p.y() - center.y());
+    if (rx <= 0.0 || ry <= 0.0) {
+        // 退化为沿另一轴的线段（或单点）
+        return PointSegmentDistance(QPointF(y0, y1), QPointF(0, 0), QPointF(rx, ry));
+    }
+    if (rx == ry) return std::abs(std::hypot(y0, y1) - rx);
+    double e0 = rx, e1 = ry;
+    if (e0 < e1) { std::swap(e0, e1); std::swap(y0, y1); }
+    return ellipseDistanceFirstQuadrant(e0, e1, y0, y1);
+}
+
+bool Hit(const Shape& shape, const QPointF& local, double tolerance) {
+    const double tol = std::max(0.0, tolerance) + shape.pen().widthF() * 0.5;
+    const QRectF& lb = shape.LocalBounds();
+    if (local.x() < lb.left() - tol || local.x() > lb.right() + tol
+        || local.y() < lb.top() - tol || local.y() > lb.bottom() + tol) {
+        return false;
+    }
+
+    switch (shape.kind()) {
+    case ShapeKind::LineSegment: {
+        const auto& s = static_cast<const LineSegment&>(shape);
+        return PointSegmentDistance(local, s.p1(), s.p2()) <= tol;
+    }
+    case ShapeKind::Polyline: {
+        const auto& pts = static_cast<const Polyline&>(shape).points();
+        return PointPathDistance(local, pts.constData(), pts.size(), false) <= tol;
+    }
+    case ShapeKind::Rectangle: {
+        // 局部包围盒即矩形本身
+        const double dx = std::max({lb.left() - local.x(), 0.0, local.x() - lb.right()});
+        const double dy = std::max({lb.top() - local.y(), 0.0, local.y() - lb.bottom()});
+        return std::hypot(dx, dy) <= tol;
+    }
+    case ShapeKind::Triangle: {
+        const auto& s = static_cast<const Triangle&>(shape);
+        const QPointF pts[3] = {s.p1(), s.p2(), s.p3()};
+        return PointInPolygon(local, pts, 3) || PointPathDistance(local, pts, 3, true) <= tol;
+    }
+    case ShapeKind::Polygon: {
+        const auto& pts = static_cast<const Polygon&>(shape).points();
+        return PointInPolygon(local, pts.constData(), pts.size())
+            || PointPathDistance(local, pts.constData(), pts.size(), true) <= tol;
+    }
+    case ShapeKind::Circle: {
+        const auto& s = static_cast<const Circle&>(shape);
+        const double d = std::hypot(local.x() - s.center().x(), local.y() - s.center().y());
+        return d <= s.radius() + tol;
+    }
+    case ShapeKind::Ellipse: {
+        const auto& s = static_cast<const Ellipse&>(shape);
+        return inEllipse(local, s.center(), s.rx(), s.ry())
+            || PointEllipseDistance(local, s.center(), s.rx(), s.ry()) <= tol;
+    }
+    case ShapeKind::Count:
+        break;
+    }
+    return false;
+}
+
+} // namespace HitTest
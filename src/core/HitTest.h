@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QPointF>
+
+class Shape;
+
+// 精确命中测试（局部坐标，即未变换的模型几何）：
+// - 线类图形（线段/折线）只按到轮廓的距离判定；
+// - 闭合图形（矩形/三角形/多边形/圆/椭圆）内部或距轮廓不超过容差均算命中；
+// - 容差另加线宽的一半，粗线按可见笔画命中。
+// 先以缓存的局部包围盒快速排除，再做逐边/解析计算。
+namespace HitTest {
+
+double PointSegmentDistance(const QPointF& p, const QPointF& a, const QPointF& b);
+// 到折线（closed 时含末点到首点的闭合边）的最短距离；n == 0 时为 +inf
+double PointPathDistance(const QPointF& p, const QPointF* pts, qsizetype n, bool closed);
+// 奇偶规则（与 QPainter 默认填充规则一致）
+bool PointInPolygon(const QPointF& p, const QPointF* pts, qsizetype n);
+// 到轴对齐椭圆边界的精确距离（半轴可为 0，此时退化为线段）
+double PointEllipseDistance(const QPointF& p, const QPointF& center, double rx, double ry);
+
+bool Hit(const Shape& shape, const QPointF& local, double tolerance);
+
+} // namespace HitTest
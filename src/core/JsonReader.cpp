@@ -0,0 +1,352 @@
+#include "JsonReader.h"
+
+#include <algorithm>
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+
+namespace {
+
+constexpr qsizetype kChunkSize = 64 * 1024;
+// 超过该嵌套深度视为损坏，避免递归耗尽栈
+constexpr size_t kMaxDepth = 512;
+
+bool isSpace(int c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+int hexValue(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void appendUtf8(QByteArray& out, char32_t c) {
+    if (c < 0x80) {
+        out += static_cast<char>(c);
+    } else if (c < 0x800) {
+        out += static_cast<char>(0xc0 | (c >> 6));
+        out += static_cast<char>(0x80 | (c & 0x3f));
+    } else if (c < 0x10000) {
+        out += static_cast<char>(0xe0 | (c >> 12));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (c & 0x3f));
+    } else {
+        out += static_cast<char>(0xf0 | (c >> 18));
+        out += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (c & 0x3f));
+    }
+}
+
+} // namespace
+
+JsonReader::JsonReader(QIODevice& in) : in_(&in) {}
+
+JsonReader::JsonReader(const char* data, qsizetype size, qint64 baseOffset)
+    : buf_(QByteArray::fromRawData(data, size)), base_(baseOffset) {}
+
+void JsonReader::fail(const QString& msg) {
+    if (error_.isEmpty()) error_ = QObject::tr("JSON 解析错误（第 %1 字节）：%2").arg(bytesConsumed()).arg(msg);
+}
+
+bool JsonReader::refill() {
+    if (!in_) return false;
+    base_ += buf_.size();
+    pos_ = 0;
+    buf_.resize(kChunkSize);
+    const qint64 n = in_->read(buf_.data(), kChunkSize);
+    buf_.resize(n > 0 ? static_cast<qsizetype>(n) : 0);
+    return n > 0;
+}
+
+int JsonReader::peekChar() {
+    if (pos_ >= buf_.size() && !refill()) return -1;
+    return static_cast<uchar>(buf_[pos_]);
+}
+
+int JsonReader::peekNonSpace() {
+    int c = peekChar();
+    while (isSpace(c)) {
+        ++pos_;
+        c = peekChar();
+    }
+    return c;
+}
+
+bool JsonReader::expect(char c) {
+    if (hasError()) return false;
+    if (peekNonSpace() != static_cast<uchar>(c)) {
+        fail(QObject::tr("应为 '%1'").arg(QLatin1Char(c)));
+        return false;
+    }
+    ++pos_;
+    return true;
+}
+
+JsonReader::Type JsonReader::peekType() {
+    if (hasError()) return Type::Invalid;
+    const int c = peekNonSpace();
+    switch (c) {
+    case '{': return Type::Object;
+    case '[': return Type::Array;
+    case '"': return Type::String;
+    case 't': case 'f': return Type::Bool;
+    case 'n': return Type::Null;
+    default: return (c == '-' || (c >= '0' && c <= '9')) ? Type::Number : Type::Invalid;
+    }
+}
+
+bool JsonReader::beginObject() {
+    if (hasElements_.size() >= kMaxDepth) {
+        fail(QObject::tr("嵌套过深"));
+        return false;
+    }
+    if (!expect('{')) return false;
+    hasElements_.push_back(false);
+    return true;
+}
+
+bool JsonReader::beginArray() {
+    if (hasElements_.size() >= kMaxDepth) {
+        fail(QObject::tr("嵌套过深"));
+        return false;
+    }
+    if (!expect('[')) return false;
+    hasElements_.push_back(false);
+    return true;
+}
+
+// 容器内的下一个元素：遇到闭括号（序列为输入结束 -1）时退出容器；非首个元素前必须有逗号
+bool JsonReader::separator(int close) {
+    if (hasError() || hasElements_.empty()) return false;
+    const int c = peekNonSpace();
+    if (c == close) {
+        ++pos_;
+        hasElements_.pop_back();
+        return false;
+    }
+    if (hasElements_.back()) {
+        if (c != ',') {
+            fail(c < 0 ? QObject::tr("文件意外结束")
+                       : close < 0 ? QObject::tr("应为 ','")
+                                   : QObject::tr("应为 ',' 或 '%1'").arg(QLatin1Char(static_cast<char>(close))));
+            return false;
+        }
+        ++pos_;
+    }
+    hasElements_.back() = true;
+    return true;
+}
+
+bool JsonReader::nextKey() {
+    if (!separator('}')) return false;
+    if (peekNonSpace() != '"') {
+        fail(QObject::tr("应为键名"));
+        return false;
+    }
+    return readRawString(key_) && expect(':');
+}
+
+bool JsonReader::nextElement() { return separator(']'); }
+
+void JsonReader::beginSequence() { hasElements_.push_back(false); }
+
+bool JsonReader::nextInSequence() { return separator(-1); }
+
+void JsonReader::skipBytes(qint64 n) {
+    while (n > 0 && peekChar() >= 0) {
+        const qint64 step = std::min<qint64>(n, buf_.size() - pos_);
+        pos_ += step;
+        n -= step;
+    }
+}
+
+bool JsonReader::readRawString(QByteArray& utf8) {
+    utf8.clear();
+    ++pos_; // 开头的引号
+    // 等待低代理项的高代理项；孤立代理项无法编码为 UTF-8，替换为 U+FFFD（与 QString::fromUtf8 一致）
+    char32_t pendingHigh = 0;
+    auto flushPending = [&]() {
+        if (pendingHigh) appendUtf8(utf8, 0xfffd);
+        pendingHigh = 0;
+    };
+    auto readHex4 = [this]() {
+        int v = 0;
+        for (int i = 0; i < 4; ++i) {
+            const int h = hexValue(peekChar());
+            if (h < 0) return -1;
+            ++pos_;
+            v = v * 16 + h;
+        }
+        return v;
+    };
+    for (;;) {
+        // 普通字符成段复制
+        const qsizetype start = pos_;
+        while (pos_ < buf_.size()) {
+            const auto ch = static_cast<uchar>(buf_[pos_]);
+            if (ch == '"' || ch == '\\' || ch < 0x20) break;
+            ++pos_;
+        }
+        if (pos_ > start) {
+            flushPending();
+            utf8.append(buf_.constData() + start, pos_ - start);
+        }
+
+        const int c = peekChar();
+        if (c < 0) {
+            fail(QObject::tr("字符串未结束"));
+            return false;
+        }
+        if (c == '"') {
+            ++pos_;
+            flushPending();
+            return true;
+        }
+        if (c < 0x20) {
+            fail(QObject::tr("字符串中有控制字符"));
+            return false;
+        }
+        if (c != '\\') continue; // 块边界，继续复制
+
+        ++pos_;
+        const int e = peekChar();
+        if (e < 0) {
+            fail(QObject::tr("字符串未结束"));
+            return false;
+        }
+        ++pos_;
+        if (e == 'u') {
+            const int v = readHex4();
+            if (v < 0) {
+                fail(QObject::tr("无效的 \\u 转义"));
+                return false;
+            }
+            const auto cp = static_cast<char32_t>(v);
+            if (pendingHigh && QChar::isLowSurrogate(cp)) {
+                appendUtf8(utf8, QChar::surrogateToUcs4(static_cast<char16_t>(pendingHigh), static_cast<char16_t>(cp)));
+                pendingHigh = 0;
+            } else {
+                flushPending();
+                if (QChar::isHighSurrogate(cp)) pendingHigh = cp;
+                else appendUtf8(utf8, QChar::isSurrogate(cp) ? 0xfffd : cp);
+            }
+            continue;
+        }
+        flushPending();
+        switch (e) {
+        case '"': utf8 += '"'; break;
+        case '\\': utf8 += '\\'; break;
+        case '/': utf8 += '/'; break;
+        case 'b': utf8 += '\b'; break;
+        case 'f': utf8 += '\f'; break;
+        case 'n': utf8 += '\n'; break;
+        case 'r': utf8 += '\r'; break;
+        case 't': utf8 += '\t'; break;
+        default:
+            fail(QObject::tr("无效的转义字符"));
+            return false;
+        }
+    }
+}
+
+QString JsonReader::readString() {
+    if (peekType() != Type::String) {
+        fail(QObject::tr("应为字符串"));
+        return {};
+    }
+    return readRawString(token_) ? QString::fromUtf8(token_) : QString();
+}
+
+double JsonReader::readNumber() {
+    if (peekType() != Type::Number) {
+        fail(QObject::tr("应为数字"));
+        return 0.0;
+    }
+    token_.clear();
+    for (int c = peekChar(); (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+         c = peekChar()) {
+        token_ += static_cast<char>(c);
+        ++pos_;
+    }
+    // QByteArray::toDouble 与区域设置无关
+    bool ok = false;
+    const double v = token_.toDouble(&ok);
+    if (!ok) fail(QObject::tr("无效的数字"));
+    return ok ? v : 0.0;
+}
+
+bool JsonReader::readLiteral(const char* word) {
+    for (const char* p = word; *p; ++p) {
+        if (peekChar() != static_cast<uchar>(*p)) {
+            fail(QObject::tr("无效的字面量"));
+            return false;
+        }
+        ++pos_;
+    }
+    return true;
+}
+
+bool JsonReader::readBool() {
+    switch (peekNonSpace()) {
+    case 't': return readLiteral("true");
+    case 'f': readLiteral("false"); return false;
+    default: fail(QObject::tr("应为布尔值")); return false;
+    }
+}
+
+QJsonValue JsonReader::readValue() {
+    switch (peekType()) {
+    case Type::Object: {
+        QJsonObject obj;
+        beginObject();
+        while (nextKey()) {
+            const QString k = QString::fromUtf8(key_);
+            obj.insert(k, readValue());
+        }
+        return obj;
+    }
+    case Type::Array: {
+        QJsonArray arr;
+        beginArray();
+        while (nextElement()) arr.append(readValue());
+        return arr;
+    }
+    case Type::String: return readString();
+    case Type::Number: return readNumber();
+    case Type::Bool: return readBool();
+    case Type::Null: readLiteral("null"); return QJsonValue(QJsonValue::Null);
+    case Type::Invalid: break;
+    }
+    fail(peekChar() < 0 ? QObject::tr("文件意外结束") : QObject::tr("意外的字符"));
+    return {};
+}
+
+void JsonReader::skipValue() {
+    switch (peekType()) {
+    case Type::Object:
+        beginObject();
+        while (nextKey()) skipValue();
+        return;
+    case Type::Array:
+        beginArray();
+        while (nextElement()) skipValue();
+        return;
+    case Type::String: readRawString(token_); return;
+    case Type::Number: readNumber(); return;
+    case Type::Bool: readBool(); return;
+    case Type::Null: readLiteral("null"); return;
+    case Type::Invalid: break;
+    }
+    fail(peekChar() < 0 ? QObject::tr("文件意外结束") : QObject::tr("意外的字符"));
+}
+
+bool JsonReader::atDocumentEnd() {
+    if (hasError()) return false;
+    if (peekNonSpace() >= 0) {
+        fail(QObject::tr("文档末尾有多余内容"));
+        return false;
+    }
+    return true;
+}
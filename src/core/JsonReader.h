@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <QByteArray>
+#include <QJsonValue>
+#include <QString>
+
+class QIODevice;
+
+// 拉取式 JSON 读取：按固定大小的块从 QIODevice 读入，调用方逐个取键/元素/标量，
+// 不构造 QJsonDocument。缓冲大小固定，内存占用与文件大小无关（单个字符串除外）。
+// 出错后所有调用都返回空/false，由 hasError()/errorString() 报告首个错误。
+//
+//   r.beginObject();
+//   while (r.nextKey()) { if (r.key() == "a") x = r.readNumber(); else r.skipValue(); }
+class JsonReader {
+public:
+    enum class Type { Object, Array, String, Number, Bool, Null, Invalid };
+
+    explicit JsonReader(QIODevice& in);
+    // 直接读内存中的一段（不复制，调用方保证其存活）；baseOffset 为该段在文件中的偏移，用于进度与错误位置
+    JsonReader(const char* data, qsizetype size, qint64 baseOffset = 0);
+
+    // 下一个值的类型（不消耗）
+    Type peekType();
+
+    // 进入对象；nextKey 读出下一个键并停在其值之前，遇到 '}' 时退出对象并返回 false
+    bool beginObject();
+    bool nextKey();
+    // 最近一次 nextKey 读出的键（UTF-8，缓冲复用，下一次 nextKey 前有效）
+    const QByteArray& key() const { return key_; }
+    // 进入数组；nextElement 停在下一个元素之前，遇到 ']' 时退出数组并返回 false
+    bool beginArray();
+    bool nextElement();
+    // 逗号分隔、直到输入结束的值序列（没有括号）：并行读取时每段数组元素按此方式读出
+    void beginSequence();
+    bool nextInSequence();
+
+    double readNumber();
+    QString readString();
+    bool readBool();
+    // 读出整个值（对象/数组构造为 QJsonValue，仅用于小的子树）
+    QJsonValue readValue();
+    void skipValue();
+    // 跳过 n 个原始字节（该段内容已由调用方另行处理）
+    void skipBytes(qint64 n);
+
+    // 文档结束后只允许空白
+    bool atDocumentEnd();
+
+    qint64 bytesConsumed() const { return base_ + pos_; }
+    bool hasError() const { return !error_.isEmpty(); }
+    QString errorString() const { return error_; }
+
+private:
+    bool refill();
+    int peekChar();
+    int peekNonSpace();
+    bool expect(char c);
+    bool separator(int close);
+    bool readLiteral(const char* word);
+    bool readRawString(QByteArray& utf8);
+    void fail(const QString& msg);
+
+    QIODevice* in_ {nullptr};
+    QByteArray buf_;
+    qsizetype pos_ {0};
+    qint64 base_ {0};
+    // 当前各层容器是否已读过元素（决定下一个元素前需要逗号）
+    std::vector<bool> hasElements_;
+    // 键与数字/字符串的临时缓冲，重复使用
+    QByteArray key_;
+    QByteArray token_;
+    QString error_;
+};
@@ -0,0 +1,197 @@
+#include "JsonWriter.h"
+
+#include <QCborValue>
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QLocale>
+#include <QtNumeric>
+#include <cmath>
+
+namespace {
+
+// 缓冲达到该大小即写出，峰值内存与文档大小无关
+constexpr qsizetype kFlushThreshold = 64 * 1024;
+
+char hexDigit(uint v) { return static_cast<char>(v < 10 ? '0' + v : 'a' + v - 10); }
+
+void appendEscapedUnit(QByteArray& buf, char16_t u) {
+    buf += "\\u";
+    buf += hexDigit((u >> 12) & 0xf);
+    buf += hexDigit((u >> 8) & 0xf);
+    buf += hexDigit((u >> 4) & 0xf);
+    buf += hexDigit(u & 0xf);
+}
+
+// Qt 各版本对整数值 double 的写法不同（"1e+06" 或 "1000000"），首次使用时按 Qt 自身的输出探测一次
+bool integralDoublesAsFixed() {
+    static const bool fixed = QJsonDocument(QJsonArray{1e6}).toJson(QJsonDocument::Compact) == "[1000000]";
+    return fixed;
+}
+
+QByteArray formatDouble(double d) {
+    if (!qIsFinite(d)) return QByteArray("null");
+    const bool integral = std::abs(d) < 1.8e19 && d == std::trunc(d);
+    return QByteArray::number(d, integral && integralDoublesAsFixed() ? 'f' : 'g', QLocale::FloatingPointShortest);
+}
+
+} // namespace
+
+JsonWriter::JsonWriter(QIODevice& out, QJsonDocument::JsonFormat format)
+    : out_(out), compact_(format == QJsonDocument::Compact) {
+    buf_.reserve(kFlushThreshold + 1024);
+}
+
+JsonWriter::~JsonWriter() { flush(); }
+
+bool JsonWriter::flush() {
+    if (ok_ && !buf_.isEmpty()) ok_ = out_.write(buf_) == buf_.size();
+    buf_.clear();
+    return ok_;
+}
+
+QString JsonWriter::errorString() const { return out_.errorString(); }
+
+void JsonWriter::maybeFlush() {
+    if (buf_.size() >= kFlushThreshold) flush();
+}
+
+void JsonWriter::indent(int depth) {
+    if (!compact_) buf_.append(4 * depth, ' ');
+}
+
+// 与 Qt 的写法一致：容器开括号后换行，元素间 ",\n"，末元素后换行，再缩进闭括号
+void JsonWriter::beginElement() {
+    if (afterKey_) {
+        afterKey_ = false;
+        return;
+    }
+    if (hasElements_.empty()) return;
+    if (hasElements_.back()) buf_ += compact_ ? "," : ",\n";
+    hasElements_.back() = true;
+    indent(static_cast<int>(hasElements_.size()));
+}
+
+void JsonWriter::open(char bracket) {
+    beginElement();
+    buf_ += bracket;
+    if (!compact_) buf_ += '\n';
+    hasElements_.push_back(false);
+}
+
+void JsonWriter::close(char bracket) {
+    if (hasElements_.empty()) return;
+    if (hasElements_.back() && !compact_) buf_ += '\n';
+    hasElements_.pop_back();
+    indent(static_cast<int>(hasElements_.size()));
+    buf_ += bracket;
+    // 顶层文档以换行结尾（缩进格式）
+    if (hasElements_.empty() && !compact_) buf_ += '\n';
+    maybeFlush();
+}
+
+void JsonWriter::beginObject() { open('{'); }
+void JsonWriter::endObject() { close('}'); }
+void JsonWriter::beginArray() { open('['); }
+void JsonWriter::endArray() { close(']'); }
+
+void JsonWriter::key(const QString& name) {
+    beginElement();
+    buf_ += '"';
+    writeString(name);
+    buf_ += compact_ ? "\":" : "\": ";
+    afterKey_ = true;
+}
+
+void JsonWriter::value(const QJsonValue& v) {
+    switch (v.type()) {
+    case QJsonValue::Object: {
+        beginObject();
+        const QJsonObject obj = v.toObject();
+        for (auto it = obj.begin(); it != obj.end(); ++it) {
+            key(it.key());
+            value(it.value());
+        }
+        endObject();
+        return;
+    }
+    case QJsonValue::Array: {
+        beginArray();
+        for (const auto& e : v.toArray()) value(e);
+        endArray();
+        return;
+    }
+    default:
+        beginElement();
+        writeValue(v);
+        maybeFlush();
+        return;
+    }
+}
+
+void JsonWriter::writeValue(const QJsonValue& v) {
+    switch (v.type()) {
+    case QJsonValue::Bool:
+        buf_ += v.toBool() ? "true" : "false";
+        break;
+    case QJsonValue::Double: {
+        // 整数存储的值按整数写（与 Qt 相同），其余按最短往返格式
+        const QCborValue c = QCborValue::fromJsonValue(v);
+        buf_ += c.isInteger() ? QByteArray::number(c.toInteger()) : formatDouble(v.toDouble());
+        break;
+    }
+    case QJsonValue::String:
+        buf_ += '"';
+        writeString(v.toString());
+        buf_ += '"';
+        break;
+    default:
+        buf_ += "null";
+        break;
+    }
+}
+
+// 转义规则同 Qt：引号、反斜杠与控制字符转义，其余按 UTF-8 原样写出；孤立代理项写成 \uXXXX
+void JsonWriter::writeString(const QString& s) {
+    const char16_t* p = reinterpret_cast<const char16_t*>(s.utf16());
+    const char16_t* const end = p + s.size();
+    while (p != end) {
+        const char16_t u = *p++;
+        if (u < 0x80) {
+            if (u >= 0x20 && u != '"' && u != '\\') {
+                buf_ += static_cast<char>(u);
+                continue;
+            }
+            buf_ += '\\';
+            switch (u) {
+            case '"': buf_ += '"'; break;
+            case '\\': buf_ += '\\'; break;
+            case '\b': buf_ += 'b'; break;
+            case '\f': buf_ += 'f'; break;
+            case '\n': buf_ += 'n'; break;
+            case '\r': buf_ += 'r'; break;
+            case '\t': buf_ += 't'; break;
+            default:
+                buf_ += "u00";
+                buf_ += hexDigit(u >> 4);
+                buf_ += hexDigit(u & 0xf);
+                break;
+            }
+        } else if (u < 0x800) {
+            buf_ += static_cast<char>(0xc0 | (u >> 6));
+            buf_ += static_cast<char>(0x80 | (u & 0x3f));
+        } else if (QChar::isHighSurrogate(u) && p != end && QChar::isLowSurrogate(*p)) {
+            const char32_t c = QChar::surrogateToUcs4(u, *p++);
+            buf_ += static_cast<char>(0xf0 | (c >> 18));
+            buf_ += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+            buf_ += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            buf_ += static_cast<char>(0x80 | (c & 0x3f));
+        } else if (QChar::isSurrogate(u)) {
+            appendEscapedUnit(buf_, u);
+        } else {
+            buf_ += static_cast<char>(0xe0 | (u >> 12));
+            buf_ += static_cast<char>(0x80 | ((u >> 6) & 0x3f));
+            buf_ += static_cast<char>(0x80 | (u & 0x3f));
+        }
+    }
+}
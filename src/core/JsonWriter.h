@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <QByteArray>
+#include <QJsonDocument>
+#include <QJsonValue>
+#include <QString>
+
+class QIODevice;
+
+// 流式 JSON 写出：边生成边写入缓冲的 QIODevice，不必先构造整个文档。
+// 缩进/紧凑两种格式的输出与 QJsonDocument::toJson 逐字节一致
+// （键序由调用方保证：写整个 QJsonObject 时按其内部的有序键）。
+class JsonWriter {
+public:
+    explicit JsonWriter(QIODevice& out, QJsonDocument::JsonFormat format = QJsonDocument::Indented);
+    ~JsonWriter();
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    // 对象内：下一个值的键
+    void key(const QString& name);
+    // 标量或完整的对象/数组
+    void value(const QJsonValue& v);
+
+    // 写出缓冲；返回此前所有写入是否成功
+    bool flush();
+    bool ok() const { return ok_; }
+    QString errorString() const;
+
+private:
+    void beginElement();
+    void open(char bracket);
+    void close(char bracket);
+    void writeValue(const QJsonValue& v);
+    void writeString(const QString& s);
+    void indent(int depth);
+    void maybeFlush();
+
+    QIODevice& out_;
+    bool compact_;
+    bool ok_ {true};
+    bool afterKey_ {false};
+    QByteArray buf_;
+    // 每层容器是否已有元素
+    std::vector<bool> hasElements_;
+};
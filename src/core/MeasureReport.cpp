@@ -0,0 +1,165 @@
+#include "MeasureReport.h"
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "ShapeStore.h"
+
+namespace {
+
+// 每块行数：过小的块线程调度开销大于计算本身
+constexpr int kRowsPerChunk = 4096;
+
+QRectF unite(const QRectF& a, const QRectF& b) {
+    // 不用 QRectF::united：其会忽略宽高均为 0 的矩形（如单点折线）
+    return QRectF(QPointF(std::min(a.left(), b.left()), std::min(a.top(), b.top())),
+                  QPointF(std::max(a.right(), b.right()), std::max(a.bottom(), b.bottom())));
+}
+
+// 闭区间相交：水平/竖直线段的包围盒高或宽为 0，QRectF::intersects 会判为不相交
+bool touches(const QRectF& a, const QRectF& b) {
+    return a.left() <= b.right() && b.left() <= a.right()
+        && a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+void accumulate(MeasureReport& r, const ShapeStore& store, int row, const QRectF& box) {
+    auto& t = r.byKind[static_cast<int>(store.kind(row))];
+    switch (store.kind(row)) {
+    case ShapeKind::LineSegment:
+    case ShapeKind::Polyline:
+        t.length += store.length(row);
+        break;
+    default:
+        t.area += store.area(row);
+        t.perimeter += store.perimeter(row);
+        break;
+    }
+    t.extents = t.count == 0 ? box : unite(t.extents, box);
+    ++t.count;
+}
+
+void computeRange(MeasureReport& r, const ShapeStore& store, int begin, int end, const QRectF* region) {
+    for (int row = begin; row < end; ++row) {
+        const QRectF box = store.boundingBox(row);
+        if (region && !touches(box, *region)) continue;
+        accumulate(r, store, row, box);
+    }
+}
+
+// 一个块：某份快照的行区间 [begin, end)
+struct Chunk {
+    const ShapeStore* store;
+    int begin;
+    int end;
+};
+
+// 领取块并累加；调用线程与池中的辅助任务共用
+struct ChunkJob {
+    const std::vector<Chunk>& chunks;
+    std::vector<MeasureReport>& partial;
+    const QRectF* region;
+    std::atomic<int> next {0};
+    std::atomic<int> workers {0};
+
+    void drain() {
+        bool counted = false;
+        for (int c = next++; c < static_cast<int>(chunks.size()); c = next++) {
+            if (!counted) {
+                ++workers;
+                counted = true;
+            }
+            const Chunk& ch = chunks[static_cast<size_t>(c)];
+            computeRange(partial[static_cast<size_t>(c)], *ch.store, ch.begin, ch.end, region);
+        }
+    }
+};
+
+class ChunkHelper : public QRunnable {
+public:
+    ChunkHelper(ChunkJob& job, QSemaphore& finished) : job_(job), finished_(finished) { setAutoDelete(false); }
+    void run() override {
+        job_.drain();
+        finished_.release();
+    }
+
+private:
+    ChunkJob& job_;
+    QSemaphore& finished_;
+};
+
+MeasureReport computeChunked(const std::vector<const ShapeStore*>& parts, const QRectF* region, int threads) {
+    std::vector<Chunk> chunks;
+    for (const ShapeStore* store : parts) {
+        if (!store) continue;
+        for (int begin = 0; begin < store->size(); begin += kRowsPerChunk) {
+            chunks.push_back(Chunk{store, begin, std::min(store->size(), begin + kRowsPerChunk)});
+        }
+    }
+    if (threads <= 0) threads = std::max(1, QThread::idealThreadCount());
+    const int helpers = std::min(threads, static_cast<int>(chunks.size())) - 1;
+
+    std::vector<MeasureReport> partial(chunks.size());
+    ChunkJob job {chunks, partial, region};
+    QSemaphore finished;
+    std::vector<std::unique_ptr<ChunkHelper>> started;
+    QThreadPool* pool = QThreadPool::globalInstance();
+    for (int i = 0; i < helpers; ++i) {
+        started.push_back(std::make_unique<ChunkHelper>(job, finished));
+        pool->start(started.back().get());
+    }
+    job.drain();
+    // 尚未开始的辅助任务撤回，不必等池中有空闲线程（调用方自身可能就在池中）
+    int running = 0;
+    for (auto& h : started) {
+        if (!pool->tryTake(h.get())) ++running;
+    }
+    finished.acquire(running);
+
+    MeasureReport out;
+    for (const auto& p : partial) {
+        for (int k = 0; k < kShapeKindCount; ++k) out.byKind[k].merge(p.byKind[k]);
+    }
+    for (const auto& t : out.byKind) out.total.merge(t);
+    out.workers = job.workers;
+    return out;
+}
+
+} // namespace
+
+void MeasureReport::Totals::merge(const Totals& o) {
+    if (o.count == 0) return;
+    extents = count == 0 ? o.extents : unite(extents, o.extents);
+    count += o.count;
+    area += o.area;
+    perimeter += o.perimeter;
+    length += o.length;
+}
+
+void MeasureReport::merge(const MeasureReport& o) {
+    for (int k = 0; k < kShapeKindCount; ++k) byKind[k].merge(o.byKind[k]);
+    total.merge(o.total);
+}
+
+MeasureReport MeasureReport::Compute(const ShapeStore& store, int threads) {
+    return computeChunked({&store}, nullptr, threads);
+}
+
+MeasureReport MeasureReport::ComputeInRect(const ShapeStore& store, const QRectF& region, int threads) {
+    const QRectF r = region.normalized();
+    return computeChunked({&store}, &r, threads);
+}
+
+MeasureReport MeasureReport::Compute(const std::vector<const ShapeStore*>& parts, int threads) {
+    return computeChunked(parts, nullptr, threads);
+}
+
+MeasureReport MeasureReport::ComputeInRect(const std::vector<const ShapeStore*>& parts, const QRectF& region, int threads) {
+    const QRectF r = region.normalized();
+    return computeChunked(parts, &r, threads);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <QRectF>
+#include <QtGlobal>
+
+#include "ShapeKind.h"
+
+class ShapeStore;
+
+// 度量统计报表：按类型汇总实例数、总面积、总周长/长度与外包范围。
+// 输入为 ShapeStore 快照（或按文档顺序分块的多份快照），可在任意线程计算：行区间按固定行数切块，
+// 由调用线程与 QThreadPool::globalInstance() 中的线程共同领取并行累加（池中线程忙时调用线程独自做完，
+// 不会互相等待），各块结果按块顺序合并，结果与线程数无关。
+struct MeasureReport {
+    struct Totals {
+        qint64 count {0};
+        double area {0.0};      // 面积图形的面积之和
+        double perimeter {0.0}; // 面积图形的周长之和
+        double length {0.0};    // 线类图形的长度之和
+        QRectF extents;         // 包围盒的并（变换后）；无图形时为空
+
+        void merge(const Totals& o);
+    };
+
+    std::array<Totals, kShapeKindCount> byKind {};
+    Totals total;
+    // 实际领取到块的线程数（诊断用，不参与合并）
+    int workers {0};
+
+    const Totals& of(ShapeKind kind) const { return byKind[static_cast<int>(kind)]; }
+    // 并入另一份报表（如分块快照各自的结果）
+    void merge(const MeasureReport& o);
+
+    // threads <= 0 时使用全部硬件线程；块数较少时自动减少线程
+    static MeasureReport Compute(const ShapeStore& store, int threads = 0);
+    // 仅统计包围盒与 region 相交（含边界接触）的图形
+    static MeasureReport ComputeInRect(const ShapeStore& store, const QRectF& region, int threads = 0);
+    // 多份快照合起来统计（各份的块一起参与并行）
+    static MeasureReport Compute(const std::vector<const ShapeStore*>& parts, int threads = 0);
+    static MeasureReport ComputeInRect(const std::vector<const ShapeStore*>& parts, const QRectF& region, int threads = 0);
+};
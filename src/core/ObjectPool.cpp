@@ -0,0 +1,181 @@
+#include "ObjectPool.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t kGranularity = 16;
+constexpr std::size_t kMaxPooledSize = 512;
+constexpr std::size_t kClassCount = kMaxPooledSize / kGranularity;
+// 单个大块的目标字节数；小对象一块可容纳数千个
+constexpr std::size_t kSlabBytes = 64 * 1024;
+
+static_assert(alignof(std::max_align_t) <= kGranularity, "slot size must keep max_align_t alignment");
+
+struct FreeSlot { FreeSlot* next; };
+
+class SizeClass {
+public:
+    void init(std::size_t slotSize) {
+        slotSize_ = slotSize;
+        slotsPerSlab_ = kSlabBytes / slotSize;
+    }
+
+    void* allocate() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++live_;
+        if (free_) {
+            FreeSlot* s = free_;
+            free_ = s->next;
+            return s;
+        }
+        if (bumpLeft_ == 0) {
+            auto* slab = static_cast<char*>(::operator new(slotsPerSlab_ * slotSize_));
+            slabs_.push_back(slab);
+            bump_ = slab;
+            bumpLeft_ = slotsPerSlab_;
+        }
+        void* p = bump_;
+        bump_ += slotSize_;
+        --bumpLeft_;
+        return p;
+    }
+
+    void deallocate(void* p) noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto* s = static_cast<FreeSlot*>(p);
+        s->next = free_;
+        free_ = s;
+        --live_;
+    }
+
+    std::size_t trim() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (slabs_.empty()) return 0;
+        const std::size_t slabBytes = slotsPerSlab_ * slotSize_;
+        if (live_ == 0) {
+            const std::size_t bytes = slabs_.size() * slabBytes;
+            for (char* slab : slabs_) ::operator delete(slab);
+            slabs_.clear();
+            slabs_.shrink_to_fit();
+            free_ = nullptr;
+            bump_ = nullptr;
+            bumpLeft_ = 0;
+            return bytes;
+        }
+
+        // 仍有存活对象：统计每个大块中的空闲槽位（空闲链表 + 未切分的尾部），整块空闲的归还
+        std::sort(slabs_.begin(), slabs_.end(), std::less<char*>());
+        auto slabOf = [this](const void* p) {
+            auto it = std::upper_bound(slabs_.begin(), slabs_.end(), static_cast<const char*>(p), std::less<const char*>());
+            return static_cast<std::size_t>(it - slabs_.begin()) - 1;
+        };
+        std::vector<std::size_t> freeCount(slabs_.size(), 0);
+        for (FreeSlot* s = free_; s; s = s->next) ++freeCount[slabOf(s)];
+        if (bumpLeft_ > 0) freeCount[slabOf(bump_)] += bumpLeft_;
+
+        std::vector<char> release(slabs_.size(), 0);
+        std::size_t bytes = 0;
+        for (std::size_t i = 0; i < slabs_.size(); ++i) {
+            if (freeCount[i] == slotsPerSlab_) { release[i] = 1; bytes += slabBytes; }
+        }
+        if (bytes == 0) return 0;
+
+        // 重建空闲链表，跳过将被归还的大块
+        FreeSlot* kept = nullptr;
+        for (FreeSlot* s = free_; s;) {
+            FreeSlot* next = s->next;
+            if (!release[slabOf(s)]) { s->next = kept; kept = s; }
+            s = next;
+        }
+        free_ = kept;
+        if (bumpLeft_ > 0 && release[slabOf(bump_)]) { bump_ = nullptr; bumpLeft_ = 0; }
+
+        std::size_t out = 0;
+        for (std::size_t i = 0; i < slabs_.size(); ++i) {
+            if (release[i]) ::operator delete(slabs_[i]);
+            else slabs_[out++] = slabs_[i];
+        }
+        slabs_.resize(out);
+        return bytes;
+    }
+
+    void stats(ObjectPool::Stats& out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out.liveObjects += live_;
+        out.reservedBytes += slabs_.size() * slotsPerSlab_ * slotSize_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::size_t slotSize_ {0};
+    std::size_t slotsPerSlab_ {0};
+    FreeSlot* free_ {nullptr};
+    char* bump_ {nullptr};
+    std::size_t bumpLeft_ {0};
+    std::size_t live_ {0};
+    std::vector<char*> slabs_;
+};
+
+class Pools {
+public:
+    Pools() {
+        const char* env = std::getenv("FAKECAD_DISABLE_POOL");
+        enabled_ = !(env && *env && *env != '0');
+        for (std::size_t i = 0; i < kClassCount; ++i) classes_[i].init((i + 1) * kGranularity);
+    }
+
+    bool enabled() const { return enabled_; }
+    SizeClass& of(std::size_t size) { return classes_[(size - 1) / kGranularity]; }
+    std::array<SizeClass, kClassCount>& all() { return classes_; }
+
+private:
+    bool enabled_ {true};
+    std::array<SizeClass, kClassCount> classes_;
+};
+
+Pools& pools() {
+    // 不析构：静态对象析构顺序不定，退出时仍可能有图形经由池释放；大块随进程回收
+    static Pools* p = new Pools;
+    return *p;
+}
+
+bool pooled(std::size_t size) { return size != 0 && size <= kMaxPooledSize && pools().enabled(); }
+
+} // namespace
+
+namespace ObjectPool {
+
+void* Allocate(std::size_t size) {
+    if (!pooled(size)) return ::operator new(size);
+    return pools().of(size).allocate();
+}
+
+void Deallocate(void* p, std::size_t size) noexcept {
+    if (!p) return;
+    if (!pooled(size)) { ::operator delete(p); return; }
+    pools().of(size).deallocate(p);
+}
+
+std::size_t Trim() {
+    std::size_t bytes = 0;
+    for (auto& c : pools().all()) bytes += c.trim();
+    return bytes;
+}
+
+Stats GetStats() {
+    Stats s;
+    for (auto& c : pools().all()) c.stats(s);
+    return s;
+}
+
+bool Enabled() { return pools().enabled(); }
+
+} // namespace ObjectPool
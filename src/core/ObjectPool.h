@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+// 按对象大小分级的内存池：Shape 与 ShapeItem 通过类内 operator new/delete 从这里分配。
+// - 每个分级（16 字节一级，最大 512 字节）按大块（slab）向系统申请内存，槽位顺序切分；
+// - 释放的槽位挂入该分级的空闲链表，后续分配优先复用；
+// - 文档关闭/重新加载后调用 Trim()，所有槽位均已空闲的大块整体归还系统。
+// 超过最大分级的请求直接走全局 operator new。各分级独立加锁，可在任意线程分配/释放。
+// 设置环境变量 FAKECAD_DISABLE_POOL=1 可整体回退到全局分配（便于对比测量），首次分配时读取。
+namespace ObjectPool {
+
+void* Allocate(std::size_t size);
+// size 必须与分配时一致（由 sized operator delete 提供）
+void Deallocate(void* p, std::size_t size) noexcept;
+
+// 归还所有槽位均空闲的大块，返回归还的字节数
+std::size_t Trim();
+
+struct Stats {
+    std::size_t liveObjects {0};   // 当前从池中分配且未释放的对象数
+    std::size_t reservedBytes {0}; // 各分级持有的大块总字节数
+};
+Stats GetStats();
+
+bool Enabled();
+
+} // namespace ObjectPool
+
+// 在类内声明池化的 operator new/delete；派生类经由虚析构以实际大小释放
+#define FAKECAD_POOL_ALLOCATED                                                     \
+    static void* operator new(std::size_t size) { return ObjectPool::Allocate(size); } \
+    static void operator delete(void* p, std::size_t size) noexcept { ObjectPool::Deallocate(p, size); }
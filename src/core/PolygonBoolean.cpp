@@ -0,0 +1,517 @@
+#include "PolygonBoolean.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <queue>
+#include <set>
+
+namespace {
+
+using PolygonBoolean::Op;
+
+enum class EdgeType : quint8 { Normal, NonContributing, SameTransition, DifferentTransition };
+
+// 精确比较（QPointF::operator== 为模糊比较，不能用于拓扑判断）
+bool same(const QPointF& a, const QPointF& b) { return a.x() == b.x() && a.y() == b.y(); }
+
+// p2 相对有向线段 p0->p1 的方向（两倍有向面积）
+double signedArea(const QPointF& p0, const QPointF& p1, const QPointF& p2) {
+    return (p0.x() - p2.x()) * (p1.y() - p2.y()) - (p1.x() - p2.x()) * (p0.y() - p2.y());
+}
+
+struct SweepEvent;
+
+struct SegmentLess {
+    bool operator()(const SweepEvent* a, const SweepEvent* b) const;
+};
+using SweepLine = std::set<SweepEvent*, SegmentLess>;
+
+struct SweepEvent {
+    QPointF point;
+    bool left {false};
+    bool subject {true};
+    SweepEvent* other {nullptr};
+    int contourId {0};
+    quint64 id {0};
+    EdgeType type {EdgeType::Normal};
+    // 边下方的区域是否在本多边形外（inOut）/另一多边形外（otherInOut）
+    bool inOut {false};
+    bool otherInOut {false};
+    // 结果边界方向：+1 进入结果，-1 离开结果，0 不在结果中
+    int resultTransition {0};
+    // 扫描线上其下方最近的结果边（用于判定洞）
+    SweepEvent* prevInResult {nullptr};
+    SweepLine::iterator posSL {};
+    // 连接阶段使用
+    int otherPos {0};
+    int outputContourId {-1};
+
+    bool inResult() const { return resultTransition != 0; }
+    bool isVertical() const { return point.x() == other->point.x(); }
+    // p 是否位于本边下方
+    bool isBelow(const QPointF& p) const {
+        return left ? signedArea(point, other->point, p) > 0 : signedArea(other->point, point, p) > 0;
+    }
+    bool isAbove(const QPointF& p) const { return !isBelow(p); }
+};
+
+// e1 是否应在 e2 之后处理：x 小者先，x 相同 y 小者先，同点时右端点先、下方的边先
+bool processedAfter(const SweepEvent* e1, const SweepEvent* e2) {
+    const QPointF& p1 = e1->point;
+    const QPointF& p2 = e2->point;
+    if (p1.x() != p2.x()) return p1.x() > p2.x();
+    if (p1.y() != p2.y()) return p1.y() > p2.y();
+    if (e1->left != e2->left) return e1->left;
+    if (signedArea(p1, e1->other->point, e2->other->point) != 0) return !e1->isBelow(e2->other->point);
+    return !e1->subject && e2->subject;
+}
+
+// 扫描线上的竖直次序（le1 在 le2 下方返回 -1）；无法区分时返回 0，由调用方以 id 兜底
+int compareSegments(const SweepEvent* le1, const SweepEvent* le2) {
+    if (le1 == le2) return 0;
+    if (signedArea(le1->point, le1->other->point, le2->point) != 0
+        || signedArea(le1->point, le1->other->point, le2->other->point) != 0) {
+        // 不共线
+        if (same(le1->point, le2->point)) return le1->isBelow(le2->other->point) ? -1 : 1;
+        if (le1->point.x() == le2->point.x()) return le1->point.y() < le2->point.y() ? -1 : 1;
+        if (processedAfter(le1, le2)) return le2->isAbove(le1->point) ? -1 : 1;
+        return le1->isBelow(le2->point) ? -1 : 1;
+    }
+    // 共线
+    if (le1->subject == le2->subject) {
+        if (same(le1->point, le2->point)) {
+            if (same(le1->other->point, le2->other->point)) return 0;
+            return le1->contourId > le2->contourId ? 1 : -1;
+        }
+    } else {
+        return le1->subject ? -1 : 1;
+    }
+    return processedAfter(le1, le2) ? 1 : -1;
+}
+
+bool SegmentLess::operator()(const SweepEvent* a, const SweepEvent* b) const {
+    const int c = compareSegments(a, b);
+    if (c != 0) return c < 0;
+    return a->id < b->id;
+}
+
+struct EventAfter {
+    bool operator()(const SweepEvent* a, const SweepEvent* b) const { return processedAfter(a, b); }
+};
+
+// 线段交点：0 个、1 个或重叠时的 2 个端点
+int findIntersection(const QPointF& a1, const QPointF& a2, const QPointF& b1, const QPointF& b2,
+                     QPointF& i0, QPointF& i1) {
+    const QPointF va = a2 - a1, vb = b2 - b1, e = b1 - a1;
+    auto cross = [](const QPointF& u, const QPointF& v) { return u.x() * v.y() - u.y() * v.x(); };
+    auto dot = [](const QPointF& u, const QPointF& v) { return u.x() * v.x() + u.y() * v.y(); };
+    auto at = [](const QPointF& p, double s, const QPointF& d) { return QPointF(p.x() + s * d.x(), p.y() + s * d.y()); };
+
+    const double kross = cross(va, vb);
+    if (kross * kross > 0) {
+        const double s = cross(e, vb) / kross;
+        if (s < 0 || s > 1) return 0;
+        const double t = cross(e, va) / kross;
+        if (t < 0 || t > 1) return 0;
+        // 落在端点上时直接取端点，避免舍入误差产生新点
+        if (s == 0 || s == 1) { i0 = at(a1, s, va); return 1; }
+        if (t == 0 || t == 1) { i0 = at(b1, t, vb); return 1; }
+        i0 = at(a1, s, va);
+        return 1;
+    }
+    // 平行：不共线则无交点
+    const double k2 = cross(e, va);
+    if (k2 * k2 > 0) return 0;
+    const double sqrLenA = dot(va, va);
+    const double sa = dot(va, e) / sqrLenA;
+    const double sb = sa + dot(va, vb) / sqrLenA;
+    const double smin = std::min(sa, sb), smax = std::max(sa, sb);
+    if (smin <= 1 && smax >= 0) {
+        if (smin == 1 || smax == 0) { i0 = at(a1, std::max(smin, 0.0), va); return 1; }
+        i0 = at(a1, std::max(smin, 0.0), va);
+        i1 = at(a1, std::min(smax, 1.0), va);
+        return 2;
+    }
+    return 0;
+}
+
+class Engine {
+public:
+    explicit Engine(Op op) : op_(op) {}
+
+    void addRegion(const PolygonBoolean::Region& region, bool subject) {
+        for (const auto& ring : region) {
+            const int contourId = nextContour_++;
+            const qsizetype n = ring.size();
+            if (n < 3) continue;
+            for (qsizetype i = 0; i < n; ++i) {
+                const QPointF& s1 = ring[i];
+                const QPointF& s2 = ring[(i + 1) % n];
+                if (same(s1, s2)) continue; // 退化边
+                SweepEvent* e1 = newEvent(s1, false, nullptr, subject);
+                SweepEvent* e2 = newEvent(s2, false, e1, subject);
+                e1->other = e2;
+                e1->contourId = e2->contourId = contourId;
+                if (processedAfter(e1, e2)) e2->left = true;
+                else e1->left = true;
+                const double x = std::max(s1.x(), s2.x());
+                if (subject) subjectMaxX_ = std::max(subjectMaxX_, x);
+                else clippingMaxX_ = std::max(clippingMaxX_, x);
+                queue_.push(e1);
+                queue_.push(e2);
+            }
+        }
+    }
+
+    std::vector<PolygonBoolean::ResultRing> run() {
+        subdivide();
+        return connectEdges();
+    }
+
+private:
+    SweepEvent* newEvent(const QPointF& p, bool left, SweepEvent* other, bool subject) {
+        events_.emplace_back();
+        SweepEvent* e = &events_.back();
+        e->point = p;
+        e->left = left;
+        e->other = other;
+        e->subject = subject;
+        e->id = nextId_++;
+        return e;
+    }
+
+    bool inResult(const SweepEvent* e) const {
+        switch (e->type) {
+        case EdgeType::Normal:
+            switch (op_) {
+            case Op::Intersection: return !e->otherInOut;
+            case Op::Union: return e->otherInOut;
+            case Op::Difference: return (e->subject && e->otherInOut) || (!e->subject && !e->otherInOut);
+            case Op::Xor: return true;
+            }
+            return false;
+        case EdgeType::SameTransition: return op_ == Op::Intersection || op_ == Op::Union;
+        case EdgeType::DifferentTransition: return op_ == Op::Difference;
+        case EdgeType::NonContributing: return false;
+        }
+        return false;
+    }
+
+    int resultTransition(const SweepEvent* e) const {
+        const bool thisIn = !e->inOut;
+        const bool thatIn = !e->otherInOut;
+        bool isIn = false;
+        switch (op_) {
+        case Op::Intersection: isIn = thisIn && thatIn; break;
+        case Op::Union: isIn = thisIn || thatIn; break;
+        case Op::Xor: isIn = thisIn != thatIn; break;
+        case Op::Difference: isIn = e->subject ? (thisIn && !thatIn) : (thatIn && !thisIn); break;
+        }
+        return isIn ? 1 : -1;
+    }
+
+    void computeFields(SweepEvent* e, SweepEvent* prev) const {
+        if (!prev) {
+            e->inOut = false;
+            e->otherInOut = true;
+        } else {
+            if (e->subject == prev->subject) {
+                e->inOut = !prev->inOut;
+                e->otherInOut = prev->otherInOut;
+            } else {
+                e->inOut = !prev->otherInOut;
+                e->otherInOut = prev->isVertical() ? !prev->inOut : prev->inOut;
+            }
+            e->prevInResult = (!inResult(prev) || prev->isVertical()) ? prev->prevInResult : prev;
+        }
+        e->resultTransition = inResult(e) ? resultTransition(e) : 0;
+    }
+
+    void divideSegment(SweepEvent* le, const QPointF& p) {
+        SweepEvent* r = newEvent(p, false, le, le->subject);
+        SweepEvent* l = newEvent(p, true, le->other, le->subject);
+        r->contourId = l->contourId = le->contourId;
+        // 舍入误差可能使新左端点排在原右端点之后：交换左右角色
+        if (processedAfter(l, le->other)) {
+            le->other->left = true;
+            l->left = false;
+        }
+        le->other->other = l;
+        le->other = r;
+        queue_.push(l);
+        queue_.push(r);
+    }
+
+    // 返回 0：无需处理；1：单点相交；2：重叠且共享左端点（需重算字段）；3：其他重叠
+    int possibleIntersection(SweepEvent* se1, SweepEvent* se2) {
+        QPointF i0, i1;
+        const int n = findIntersection(se1->point, se1->other->point, se2->point, se2->other->point, i0, i1);
+        if (n == 0) return 0;
+        if (n == 1 && (same(se1->point, se2->point) || same(se1->other->point, se2->other->point))) return 0;
+        // 同一输入内部的重叠边无法按奇偶规则区分，忽略
+        if (n == 2 && se1->subject == se2->subject) return 0;
+
+        if (n == 1) {
+            if (!same(se1->point, i0) && !same(se1->other->point, i0)) divideSegment(se1, i0);
+            if (!same(se2->point, i0) && !same(se2->other->point, i0)) divideSegment(se2, i0);
+            return 1;
+        }
+
+        // 两条边重叠
+        std::vector<SweepEvent*> ev;
+        const bool leftCoincide = same(se1->point, se2->point);
+        const bool rightCoincide = same(se1->other->point, se2->other->point);
+        if (!leftCoincide) {
+            if (processedAfter(se1, se2)) { ev.push_back(se2); ev.push_back(se1); }
+            else { ev.push_back(se1); ev.push_back(se2); }
+        }
+        if (!rightCoincide) {
+            if (processedAfter(se1->other, se2->other)) { ev.push_back(se2->other); ev.push_back(se1->other); }
+            else { ev.push_back(se1->other); ev.push_back(se2->other); }
+        }
+        if (leftCoincide) {
+            // 完全相同或共享左端点：一条不贡献，另一条按两侧是否同向过渡决定
+            se2->type = EdgeType::NonContributing;
+            se1->type = (se2->inOut == se1->inOut) ? EdgeType::SameTransition : EdgeType::DifferentTransition;
+            if (!rightCoincide) divideSegment(ev[1]->other, ev[0]->point);
+            return 2;
+        }
+        if (rightCoincide) {
+            divideSegment(ev[0], ev[1]->point);
+            return 3;
+        }
+        if (ev[0] != ev[3]->other) {
+            // 互不包含
+            divideSegment(ev[0], ev[1]->point);
+            divideSegment(ev[1], ev[2]->point);
+            return 3;
+        }
+        // 一条包含另一条
+        divideSegment(ev[0], ev[1]->point);
+        divideSegment(ev[3]->other, ev[2]->point);
+        return 3;
+    }
+
+    SweepEvent* prevOf(SweepLine::iterator it) const {
+        return it == sweep_.begin() ? nullptr : *std::prev(it);
+    }
+
+    void subdivide() {
+        const double rightBound = std::min(subjectMaxX_, clippingMaxX_);
+        while (!queue_.empty()) {
+            SweepEvent* e = queue_.top();
+            queue_.pop();
+            sorted_.push_back(e);
+            // 交集只需扫到两者右边界的较小值，差集只需扫到被减区域的右边界
+            if ((op_ == Op::Intersection && e->point.x() > rightBound)
+                || (op_ == Op::Difference && e->point.x() > subjectMaxX_)) {
+                break;
+            }
+            if (e->left) {
+                const auto it = sweep_.insert(e).first;
+                e->posSL = it;
+                const auto nextIt = std::next(it);
+                SweepEvent* prev = prevOf(it);
+                computeFields(e, prev);
+                if (nextIt != sweep_.end()) {
+                    SweepEvent* next = *nextIt;
+                    if (possibleIntersection(e, next) == 2) {
+                        computeFields(e, prev);
+                        computeFields(next, e);
+                    }
+                }
+                if (prev) {
+                    if (possibleIntersection(prev, e) == 2) {
+                        computeFields(prev, prevOf(prev->posSL));
+                        computeFields(e, prev);
+                    }
+                }
+            } else {
+                SweepEvent* le = e->other;
+                const auto it = le->posSL;
+                if (it == sweep_.end() || *it != le) continue;
+                SweepEvent* prev = prevOf(it);
+                const auto nextIt = std::next(it);
+                SweepEvent* next = nextIt != sweep_.end() ? *nextIt : nullptr;
+                sweep_.erase(it);
+                le->posSL = sweep_.end();
+                if (prev && next) possibleIntersection(prev, next);
+            }
+        }
+    }
+
+    std::vector<PolygonBoolean::ResultRing> connectEdges() {
+        std::vector<SweepEvent*> events;
+        for (auto* e : sorted_) {
+            if ((e->left && e->inResult()) || (!e->left && e->other->inResult())) events.push_back(e);
+        }
+        // 重叠边拆分后的事件可能局部乱序：插入排序，代价与逆序对数成正比
+        for (size_t i = 1; i < events.size(); ++i) {
+            for (size_t j = i; j > 0 && processedAfter(events[j - 1], events[j]); --j) {
+                std::swap(events[j - 1], events[j]);
+            }
+        }
+        const int n = static_cast<int>(events.size());
+        for (int i = 0; i < n; ++i) events[i]->otherPos = i;
+        for (int i = 0; i < n; ++i) {
+            SweepEvent* e = events[i];
+            if (!e->left) std::swap(e->otherPos, e->other->otherPos);
+        }
+
+        struct Contour { PolygonBoolean::Ring points; int holeOf; int depth; };
+        std::vector<Contour> contours;
+        std::vector<char> processed(static_cast<size_t>(n), 0);
+        // back[k]：k 之前可能未处理的位置；向回找时跳过已处理的整段（路径压缩）
+        std::vector<int> back(static_cast<size_t>(n));
+        for (int k = 0; k < n; ++k) back[k] = k - 1;
+        auto lastUnprocessed = [&](int k) {
+            int r = k;
+            while (r >= 0 && processed[r]) r = back[r];
+            while (k >= 0 && processed[k] && back[k] != r) {
+                const int next = back[k];
+                back[k] = r;
+                k = next;
+            }
+            return r;
+        };
+        // 同一点上的下一条未处理边；没有则回退到本轮廓起点之后最近的未处理位置
+        auto nextPos = [&](int pos, int origPos) {
+            for (int k = pos + 1; k < n && same(events[k]->point, events[pos]->point); ++k) {
+                if (!processed[k]) return k;
+            }
+            if (pos - 1 <= origPos) return pos - 1;
+            const int u = lastUnprocessed(pos - 1);
+            return u > origPos ? u : origPos;
+        };
+        for (int i = 0; i < n; ++i) {
+            if (processed[i]) continue;
+            const int contourId = static_cast<int>(contours.size());
+            Contour contour {{}, -1, 0};
+            // 由下方最近的结果边判断新轮廓是外环还是洞
+            if (const SweepEvent* below = events[i]->prevInResult; below && below->outputContourId >= 0) {
+                const int lowerId = below->outputContourId;
+                if (below->resultTransition > 0) {
+                    const Contour& lower = contours[lowerId];
+                    if (lower.holeOf >= 0) {
+                        contour.holeOf = lower.holeOf;
+                        contour.depth = lower.depth;
+                    } else {
+                        contour.holeOf = lowerId;
+                        contour.depth = lower.depth + 1;
+                    }
+                } else {
+                    contour.depth = contours[lowerId].depth;
+                }
+            }
+
+            auto mark = [&](int pos) {
+                processed[pos] = 1;
+                events[pos]->outputContourId = contourId;
+            };
+            int pos = i;
+            const QPointF initial = events[i]->point;
+            contour.points.append(initial);
+            while (true) {
+                mark(pos);
+                pos = events[pos]->otherPos;
+                mark(pos);
+                contour.points.append(events[pos]->point);
+                pos = nextPos(pos, i);
+                if (pos == i || pos < 0 || pos >= n) break;
+            }
+            if (contour.points.size() > 1 && same(contour.points.front(), contour.points.back())) {
+                contour.points.removeLast();
+            }
+            contours.push_back(std::move(contour));
+        }
+
+        std::vector<PolygonBoolean::ResultRing> out;
+        out.reserve(contours.size());
+        // 丢弃退化轮廓时需要重映射洞的所属下标
+        std::vector<int> remap(contours.size(), -1);
+        for (size_t c = 0; c < contours.size(); ++c) {
+            if (contours[c].points.size() < 3) continue;
+            remap[c] = static_cast<int>(out.size());
+            out.push_back({std::move(contours[c].points), contours[c].holeOf});
+        }
+        for (auto& r : out) {
+            if (r.holeOf >= 0) r.holeOf = remap[r.holeOf];
+        }
+        return out;
+    }
+
+    Op op_;
+    std::deque<SweepEvent> events_;
+    std::priority_queue<SweepEvent*, std::vector<SweepEvent*>, EventAfter> queue_;
+    SweepLine sweep_;
+    std::vector<SweepEvent*> sorted_;
+    quint64 nextId_ {0};
+    int nextContour_ {0};
+    double subjectMaxX_ {-std::numeric_limits<double>::infinity()};
+    double clippingMaxX_ {-std::numeric_limits<double>::infinity()};
+};
+
+} // namespace
+
+namespace PolygonBoolean {
+
+std::vector<ResultRing> Compute(const Region& subject, const Region& clipping, Op op) {
+    Engine engine(op);
+    engine.addRegion(subject, true);
+    engine.addRegion(clipping, false);
+    return engine.run();
+}
+
+std::vector<Ring> BridgeHoles(const std::vector<ResultRing>& rings) {
+    auto ringArea = [](const Ring& r) {
+        double a = 0.0;
+        for (int i = 0, n = r.size(); i < n; ++i) {
+            const QPointF& p = r[i];
+            const QPointF& q = r[(i + 1) % n];
+            a += p.x() * q.y() - q.x() * p.y();
+        }
+        return a / 2.0;
+    };
+    std::vector<Ring> out;
+    std::vector<int> outIndex(rings.size(), -1);
+    for (size_t i = 0; i < rings.size(); ++i) {
+        if (rings[i].isHole()) continue;
+        outIndex[i] = static_cast<int>(out.size());
+        out.push_back(rings[i].points);
+    }
+    for (const auto& h : rings) {
+        if (!h.isHole() || h.points.size() < 3 || outIndex[h.holeOf] < 0) continue;
+        Ring& outer = out[outIndex[h.holeOf]];
+        Ring hole = h.points;
+        if ((ringArea(hole) > 0) == (ringArea(rings[h.holeOf].points) > 0)) std::reverse(hole.begin(), hole.end());
+        // 桥边：洞最左的顶点连到外环（含已并入的洞）上最近的顶点
+        int hi = 0;
+        for (int k = 1; k < hole.size(); ++k) {
+            if (hole[k].x() < hole[hi].x()) hi = k;
+        }
+        int oi = 0;
+        double best = std::numeric_limits<double>::max();
+        for (int k = 0; k < outer.size(); ++k) {
+            const QPointF d = outer[k] - hole[hi];
+            const double d2 = d.x() * d.x() + d.y() * d.y();
+            if (d2 < best) { best = d2; oi = k; }
+        }
+        Ring joined;
+        joined.reserve(outer.size() + hole.size() + 2);
+        for (int k = 0; k <= oi; ++k) joined.append(outer[k]);
+        for (int k = 0; k <= hole.size(); ++k) joined.append(hole[(hi + k) % hole.size()]);
+        for (int k = oi; k < outer.size(); ++k) joined.append(outer[k]);
+        outer = std::move(joined);
+    }
+    return out;
+}
+
+Region ToRegion(const std::vector<ResultRing>& rings) {
+    Region region;
+    region.reserve(rings.size());
+    for (const auto& r : rings) region.push_back(r.points);
+    return region;
+}
+
+} // namespace PolygonBoolean
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+#include <QPointF>
+#include <QVector>
+
+// 多边形布尔运算（并/交/差/异或），Martinez–Rueda–Feito 扫描线算法：
+// - 所有边按端点排成事件队列，自左向右扫描；扫描线状态为按竖直次序排列的有序集合，
+//   只检测相邻边的交点并就地拆分，总代价 O((n + k) log n)（k 为交点数），适合数万顶点的轮廓；
+// - 输入区域由若干闭合环组成（首尾不重复），按奇偶规则解释，可含洞；
+// - 输出为闭合环列表，洞记录其所属的外环。
+// 运算在调用方给出的坐标系中进行（通常为场景坐标），不依赖 Shape。
+namespace PolygonBoolean {
+
+enum class Op { Union, Intersection, Difference, Xor };
+
+using Ring = QVector<QPointF>;
+using Region = std::vector<Ring>;
+
+struct ResultRing {
+    Ring points;      // 首尾不重复
+    int holeOf {-1};  // 洞所属外环在结果中的下标；外环为 -1
+    bool isHole() const { return holeOf >= 0; }
+};
+
+// subject op clipping；Difference 为 subject - clipping
+std::vector<ResultRing> Compute(const Region& subject, const Region& clipping, Op op);
+
+// 结果环转回区域（可作为下一次运算的输入）
+Region ToRegion(const std::vector<ResultRing>& rings);
+
+// 每个外环与其洞经往返的桥边连成一个简单的环（每个外环一个结果），供只有一个环的 Polygon 使用：
+// 桥边走两遍，奇偶填充下洞仍为空；洞取与外环相反的方向，有向面积为外环减各洞（周长多计桥边两次）
+std::vector<Ring> BridgeHoles(const std::vector<ResultRing>& rings);
+
+} // namespace PolygonBoolean
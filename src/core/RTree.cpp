@@ -0,0 +1,406 @@
+#include "RTree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+#include "Shape.h"
+
+namespace {
+constexpr double kInf = std::numeric_limits<double>::infinity();
+}
+
+RTree::RTree() {
+    clear();
+}
+
+// ---------- 包围盒工具 ----------
+
+RTree::Box RTree::boxOf(const Shape* s) {
+    const QRectF r = s->BoundingBox();
+    return {std::min(r.left(), r.right()), std::min(r.top(), r.bottom()),
+            std::max(r.left(), r.right()), std::max(r.top(), r.bottom())};
+}
+
+RTree::Box RTree::unite(const Box& a, const Box& b) {
+    return {std::min(a.x0, b.x0), std::min(a.y0, b.y0), std::max(a.x1, b.x1), std::max(a.y1, b.y1)};
+}
+
+bool RTree::touches(const Box& a, const Box& b) {
+    return a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1;
+}
+
+bool RTree::covers(const Box& outer, const Box& inner) {
+    return outer.x0 <= inner.x0 && outer.y0 <= inner.y0 && inner.x1 <= outer.x1 && inner.y1 <= outer.y1;
+}
+
+double RTree::area(const Box& b) { return (b.x1 - b.x0) * (b.y1 - b.y0); }
+
+double RTree::margin(const Box& b) { return (b.x1 - b.x0) + (b.y1 - b.y0); }
+
+double RTree::distance2(const Box& b, const QPointF& p) {
+    const double dx = std::max({b.x0 - p.x(), 0.0, p.x() - b.x1});
+    const double dy = std::max({b.y0 - p.y(), 0.0, p.y() - b.y1});
+    return dx * dx + dy * dy;
+}
+
+// ---------- 节点管理 ----------
+
+int RTree::newNode(bool leaf) {
+    if (!freeNodes_.empty()) {
+        const int idx = freeNodes_.back();
+        freeNodes_.pop_back();
+        nodes_[idx].leaf = leaf;
+        nodes_[idx].entries.clear();
+        return idx;
+    }
+    nodes_.push_back(Node{leaf, {}});
+    nodes_.back().entries.reserve(kMaxEntries + 1);
+    return static_cast<int>(nodes_.size()) - 1;
+}
+
+void RTree::freeNode(int idx) {
+    nodes_[idx].entries.clear();
+    freeNodes_.push_back(idx);
+}
+
+RTree::Box RTree::nodeBox(int idx) const {
+    Box b {kInf, kInf, -kInf, -kInf};
+    for (const auto& e : nodes_[idx].entries) b = unite(b, e.box);
+    return b;
+}
+
+void RTree::clear() {
+    nodes_.clear();
+    freeNodes_.clear();
+    boxes_.clear();
+    root_ = newNode(true);
+    height_ = 1;
+}
+
+QRectF RTree::bounds() const {
+    if (empty()) return {};
+    const Box b = nodeBox(root_);
+    return QRectF(QPointF(b.x0, b.y0), QPointF(b.x1, b.y1));
+}
+
+// ---------- 批量构建（STR） ----------
+
+std::vector<RTree::Entry> RTree::packLevel(std::vector<Entry>& entries, bool leaf) {
+    const size_t n = entries.size();
+    const size_t pages = (n + kMaxEntries - 1) / kMaxEntries;
+    const auto slices = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(pages))));
+    const size_t perSlice = slices * kMaxEntries;
+
+    auto cx = [](const Entry& e) { return e.box.x0 + e.box.x1; };
+    auto cy = [](const Entry& e) { return e.box.y0 + e.box.y1; };
+    std::sort(entries.begin(), entries.end(), [&](const Entry& a, const Entry& b) { return cx(a) < cx(b); });
+
+    std::vector<Entry> parents;
+    parents.reserve(pages);
+    for (size_t s = 0; s < n; s += perSlice) {
+        const auto sliceEnd = entries.begin() + static_cast<std::ptrdiff_t>(std::min(n, s + perSlice));
+        const auto sliceBegin = entries.begin() + static_cast<std::ptrdiff_t>(s);
+        std::sort(sliceBegin, sliceEnd, [&](const Entry& a, const Entry& b) { return cy(a) < cy(b); });
+        for (auto it = sliceBegin; it < sliceEnd; it += std::min<std::ptrdiff_t>(kMaxEntries, sliceEnd - it)) {
+            const int idx = newNode(leaf);
+            nodes_[idx].entries.assign(it, it + std::min<std::ptrdiff_t>(kMaxEntries, sliceEnd - it));
+            parents.push_back({nodeBox(idx), idx, nullptr});
+        }
+    }
+    return parents;
+}
+
+void RTree::bulkLoad(const std::vector<Shape*>& shapes) {
+    clear();
+    std::vector<Entry> entries;
+    entries.reserve(shapes.size());
+    boxes_.reserve(static_cast<qsizetype>(shapes.size()));
+    for (auto* s : shapes) {
+        if (!s || boxes_.contains(s)) continue;
+        const Box b = boxOf(s);
+        boxes_.insert(s, b);
+        entries.push_back({b, -1, s});
+    }
+    if (entries.size() <= static_cast<size_t>(kMaxEntries)) {
+        nodes_[root_].entries = std::move(entries);
+        return;
+    }
+
+    // 自底向上逐层打包，直到一层的条目可放入单个根节点
+    freeNode(root_);
+    bool leaf = true;
+    int levels = 0;
+    while (entries.size() > static_cast<size_t>(kMaxEntries)) {
+        entries = packLevel(entries, leaf);
+        leaf = false;
+        ++levels;
+    }
+    root_ = newNode(false);
+    nodes_[root_].entries = std::move(entries);
+    height_ = levels + 1;
+}
+
+// ---------- 增量插入 ----------
+
+int RTree::chooseSubtree(const Node& node, const Box& b) const {
+    // 面积增量最小者；面积为 0 的退化包围盒（线段）以周长增量区分，再比较面积
+    int best = 0;
+    double bestGrow = kInf, bestMarginGrow = kInf, bestArea = kInf;
+    for (int i = 0; i < static_cast<int>(node.entries.size()); ++i) {
+        const Box& eb = node.entries[i].box;
+        const Box u = unite(eb, b);
+        const double grow = area(u) - area(eb);
+        const double marginGrow = margin(u) - margin(eb);
+        const double a = area(eb);
+        if (grow < bestGrow
+            || (grow == bestGrow && (marginGrow < bestMarginGrow || (marginGrow == bestMarginGrow && a < bestArea)))) {
+            best = i;
+            bestGrow = grow;
+            bestMarginGrow = marginGrow;
+            bestArea = a;
+        }
+    }
+    return best;
+}
+
+int RTree::split(int idx) {
+    std::vector<Entry> all = std::move(nodes_[idx].entries);
+    const bool leaf = nodes_[idx].leaf;
+    const int n = static_cast<int>(all.size());
+
+    // 选种子：合并后浪费最大的一对
+    int s1 = 0, s2 = 1;
+    double worst = -kInf, worstMargin = -kInf;
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            const Box u = unite(all[i].box, all[j].box);
+            const double d = area(u) - area(all[i].box) - area(all[j].box);
+            const double dm = margin(u) - margin(all[i].box) - margin(all[j].box);
+            if (d > worst || (d == worst && dm > worstMargin)) { worst = d; worstMargin = dm; s1 = i; s2 = j; }
+        }
+    }
+
+    std::vector<Entry> groupA {all[s1]}, groupB {all[s2]};
+    Box boxA = all[s1].box, boxB = all[s2].box;
+    std::vector<Entry> rest;
+    rest.reserve(n - 2);
+    for (int i = 0; i < n; ++i) {
+        if (i != s1 && i != s2) rest.push_back(all[i]);
+    }
+
+    while (!rest.empty()) {
+        // 保证两组都不少于最小条目数
+        if (static_cast<int>(groupA.size() + rest.size()) == kMinEntries) {
+            groupA.insert(groupA.end(), rest.begin(), rest.end());
+            break;
+        }
+        if (static_cast<int>(groupB.size() + rest.size()) == kMinEntries) {
+            groupB.insert(groupB.end(), rest.begin(), rest.end());
+            break;
+        }
+        // 取两组面积增量差异最大的条目
+        size_t pick = 0;
+        double bestDiff = -1.0;
+        double pickGrowA = 0.0, pickGrowB = 0.0;
+        for (size_t i = 0; i < rest.size(); ++i) {
+            const double ga = area(unite(boxA, rest[i].box)) - area(boxA)
+                            + 1e-12 * (margin(unite(boxA, rest[i].box)) - margin(boxA));
+            const double gb = area(unite(boxB, rest[i].box)) - area(boxB)
+                            + 1e-12 * (margin(unite(boxB, rest[i].box)) - margin(boxB));
+            const double diff = std::abs(ga - gb);
+            if (diff > bestDiff) { bestDiff = diff; pick = i; pickGrowA = ga; pickGrowB = gb; }
+        }
+        const Entry e = rest[pick];
+        rest[pick] = rest.back();
+        rest.pop_back();
+        bool toA;
+        if (pickGrowA != pickGrowB) toA = pickGrowA < pickGrowB;
+        else if (area(boxA) != area(boxB)) toA = area(boxA) < area(boxB);
+        else toA = groupA.size() <= groupB.size();
+        if (toA) { groupA.push_back(e); boxA = unite(boxA, e.box); }
+        else { groupB.push_back(e); boxB = unite(boxB, e.box); }
+    }
+
+    const int sibling = newNode(leaf);
+    nodes_[idx].entries = std::move(groupA);
+    nodes_[sibling].entries = std::move(groupB);
+    return sibling;
+}
+
+void RTree::insertEntry(const Entry& e, int level) {
+    std::vector<int> path;
+    int idx = root_;
+    for (int lvl = height_ - 1; lvl > level; --lvl) {
+        path.push_back(idx);
+        auto& entries = nodes_[idx].entries;
+        auto& pe = entries[chooseSubtree(nodes_[idx], e.box)];
+        pe.box = unite(pe.box, e.box);
+        idx = pe.child;
+    }
+    nodes_[idx].entries.push_back(e);
+
+    // 自下而上处理溢出；下降时已扩大了沿途的包围盒
+    int sibling = static_cast<int>(nodes_[idx].entries.size()) > kMaxEntries ? split(idx) : -1;
+    while (sibling >= 0 && !path.empty()) {
+        const int parent = path.back();
+        path.pop_back();
+        const Box nodeB = nodeBox(idx), sibB = nodeBox(sibling);
+        auto& entries = nodes_[parent].entries;
+        for (auto& pe : entries) {
+            if (pe.child == idx) { pe.box = nodeB; break; }
+        }
+        entries.push_back({sibB, sibling, nullptr});
+        idx = parent;
+        sibling = static_cast<int>(entries.size()) > kMaxEntries ? split(parent) : -1;
+    }
+    if (sibling >= 0) {
+        // 根分裂：树长高一层
+        const Box rootB = nodeBox(root_), sibB = nodeBox(sibling);
+        const int oldRoot = root_;
+        root_ = newNode(false);
+        nodes_[root_].entries = {{rootB, oldRoot, nullptr}, {sibB, sibling, nullptr}};
+        ++height_;
+    }
+}
+
+void RTree::insert(Shape* s) {
+    if (!s) return;
+    if (contains(s)) { update(s); return; }
+    const Box b = boxOf(s);
+    boxes_.insert(s, b);
+    insertEntry({b, -1, s}, 0);
+}
+
+// ---------- 删除/更新 ----------
+
+bool RTree::findLeaf(int idx, const Shape* s, const Box& b, std::vector<int>& path) const {
+    path.push_back(idx);
+    const Node& node = nodes_[idx];
+    if (node.leaf) {
+        for (const auto& e : node.entries) {
+            if (e.shape == s) return true;
+        }
+    } else {
+        for (const auto& e : node.entries) {
+            if (covers(e.box, b) && findLeaf(e.child, s, b, path)) return true;
+        }
+    }
+    path.pop_back();
+    return false;
+}
+
+bool RTree::remove(const Shape* s) {
+    const auto it = boxes_.constFind(s);
+    if (it == boxes_.constEnd()) return false;
+    const Box b = it.value();
+    boxes_.erase(it);
+
+    std::vector<int> path;
+    if (!findLeaf(root_, s, b, path)) return false;
+    auto& leafEntries = nodes_[path.back()].entries;
+    leafEntries.erase(std::find_if(leafEntries.begin(), leafEntries.end(), [s](const Entry& e) { return e.shape == s; }));
+
+    // 自下而上收缩：下溢的非根节点整体摘除，其条目按原层级重新插入；其余节点收紧父条目的包围盒
+    struct Orphan { Entry entry; int level; };
+    std::vector<Orphan> orphans;
+    for (int i = static_cast<int>(path.size()) - 1, level = 0; i > 0; --i, ++level) {
+        const int node = path[i];
+        auto& parentEntries = nodes_[path[i - 1]].entries;
+        const auto pit = std::find_if(parentEntries.begin(), parentEntries.end(),
+                                      [node](const Entry& e) { return e.child == node; });
+        if (static_cast<int>(nodes_[node].entries.size()) < kMinEntries) {
+            for (const auto& e : nodes_[node].entries) orphans.push_back({e, level});
+            parentEntries.erase(pit);
+            freeNode(node);
+        } else {
+            pit->box = nodeBox(node);
+        }
+    }
+
+    if (!nodes_[root_].leaf && nodes_[root_].entries.empty()) {
+        // 根下的子树全部被摘除：退回单个叶子，孤儿子树展开成图形逐个插入
+        nodes_[root_].leaf = true;
+        height_ = 1;
+        std::vector<Orphan> flat;
+        while (!orphans.empty()) {
+            const Orphan o = orphans.back();
+            orphans.pop_back();
+            if (o.level == 0) { flat.push_back(o); continue; }
+            for (const auto& e : nodes_[o.entry.child].entries) orphans.push_back({e, o.level - 1});
+            freeNode(o.entry.child);
+        }
+        orphans = std::move(flat);
+    }
+    for (const auto& o : orphans) insertEntry(o.entry, o.level);
+
+    // 根只剩一个子节点时降低树高
+    while (!nodes_[root_].leaf && nodes_[root_].entries.size() == 1) {
+        const int child = nodes_[root_].entries.front().child;
+        freeNode(root_);
+        root_ = child;
+        --height_;
+    }
+    return true;
+}
+
+void RTree::update(Shape* s) {
+    if (!s) return;
+    const auto it = boxes_.constFind(s);
+    if (it != boxes_.constEnd()) {
+        const Box nb = boxOf(s);
+        const Box& ob = it.value();
+        if (nb.x0 == ob.x0 && nb.y0 == ob.y0 && nb.x1 == ob.x1 && nb.y1 == ob.y1) return;
+        remove(s);
+    }
+    insert(s);
+}
+
+// ---------- 查询 ----------
+
+void RTree::query(const QRectF& region, std::vector<Shape*>& out) const {
+    if (empty()) return;
+    const Box q {std::min(region.left(), region.right()), std::min(region.top(), region.bottom()),
+                 std::max(region.left(), region.right()), std::max(region.top(), region.bottom())};
+    std::vector<int> stack {root_};
+    while (!stack.empty()) {
+        const Node& node = nodes_[stack.back()];
+        stack.pop_back();
+        for (const auto& e : node.entries) {
+            if (!touches(e.box, q)) continue;
+            if (node.leaf) out.push_back(e.shape);
+            else stack.push_back(e.child);
+        }
+    }
+}
+
+std::vector<Shape*> RTree::query(const QRectF& region) const {
+    std::vector<Shape*> out;
+    query(region, out);
+    return out;
+}
+
+std::vector<Shape*> RTree::nearest(const QPointF& p, int k) const {
+    std::vector<Shape*> out;
+    if (k <= 0 || empty()) return out;
+    // 最优优先：节点与图形按到 p 的距离放入同一个小顶堆，弹出的图形即为当前最近
+    struct Item {
+        double d2;
+        int node;
+        Shape* shape;
+        bool operator>(const Item& o) const { return d2 > o.d2; }
+    };
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+    heap.push({0.0, root_, nullptr});
+    while (!heap.empty() && static_cast<int>(out.size()) < k) {
+        const Item top = heap.top();
+        heap.pop();
+        if (top.shape) { out.push_back(top.shape); continue; }
+        const Node& node = nodes_[top.node];
+        for (const auto& e : node.entries) {
+            heap.push({distance2(e.box, p), node.leaf ? -1 : e.child, node.leaf ? e.shape : nullptr});
+        }
+    }
+    return out;
+}
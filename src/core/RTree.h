@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <QHash>
+#include <QPointF>
+#include <QRectF>
+
+class Shape;
+
+// 二维 R 树空间索引（核心层，不依赖场景/图元），键为 Shape::BoundingBox()（变换后）：
+// - bulkLoad 使用 STR（Sort-Tile-Recursive）打包，O(n log n) 构建，节点接近满填充；
+// - 增量 insert/remove/update：Guttman 二次分裂，删除后下溢节点的条目重新插入；
+// - 范围查询按闭区间相交，宽或高为 0 的包围盒（水平/竖直线段、单点）同样能命中；
+// - k 近邻按点到包围盒的距离，最优优先遍历。
+// 索引只保存指针、不拥有图形；图形几何或变换变化后须调用 update()。
+class RTree {
+public:
+    static constexpr int kMaxEntries = 16;
+    static constexpr int kMinEntries = 6;
+
+    RTree();
+
+    // 以 shapes 重建整棵树（丢弃原有内容；空指针忽略）
+    void bulkLoad(const std::vector<Shape*>& shapes);
+    void clear();
+
+    // 已存在时等同 update
+    void insert(Shape* s);
+    bool remove(const Shape* s);
+    // 按当前 BoundingBox() 重新定位；未被索引时插入
+    void update(Shape* s);
+
+    bool contains(const Shape* s) const { return boxes_.contains(s); }
+    int size() const { return static_cast<int>(boxes_.size()); }
+    bool empty() const { return boxes_.isEmpty(); }
+    // 全部图形包围盒的并；空树返回空矩形
+    QRectF bounds() const;
+    // 树高（仅有根叶子时为 1）
+    int height() const { return height_; }
+
+    // 包围盒与 region 相交（含边界接触）的图形，结果追加到 out（顺序不定）
+    void query(const QRectF& region, std::vector<Shape*>& out) const;
+    std::vector<Shape*> query(const QRectF& region) const;
+    // 距 p 最近的 k 个图形（按到包围盒的距离升序，包围盒内的点距离为 0）
+    std::vector<Shape*> nearest(const QPointF& p, int k) const;
+
+private:
+    // 闭区间包围盒
+    struct Box {
+        double x0, y0, x1, y1;
+    };
+    // 内部节点条目指向子节点，叶子条目指向图形
+    struct Entry {
+        Box box;
+        int child;
+        Shape* shape;
+    };
+    struct Node {
+        bool leaf;
+        std::vector<Entry> entries;
+    };
+
+    static Box boxOf(const Shape* s);
+    static Box unite(const Box& a, const Box& b);
+    static bool touches(const Box& a, const Box& b);
+    static bool covers(const Box& outer, const Box& inner);
+    static double area(const Box& b);
+    static double margin(const Box& b);
+    static double distance2(const Box& b, const QPointF& p);
+
+    int newNode(bool leaf);
+    void freeNode(int idx);
+    Box nodeBox(int idx) const;
+
+    // 把条目插入到 level 层的节点（叶子为第 0 层）
+    void insertEntry(const Entry& e, int level);
+    int chooseSubtree(const Node& node, const Box& b) const;
+    // 二次分裂：node 保留一组，返回容纳另一组的新节点
+    int split(int idx);
+    bool findLeaf(int idx, const Shape* s, const Box& b, std::vector<int>& path) const;
+    // STR 打包一层条目，返回上一层的条目
+    std::vector<Entry> packLevel(std::vector<Entry>& entries, bool leaf);
+
+    std::vector<Node> nodes_;
+    std::vector<int> freeNodes_;
+    int root_ { -1 };
+    int height_ { 1 };
+    QHash<const Shape*, Box> boxes_;
+};
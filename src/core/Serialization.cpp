@@ -3,38 +3,116 @@
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <QObject>
 
-#include "shapes/LineSegment.h"
-#include "shapes/Rectangle.h"
-#include "shapes/Circle.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "BinaryFormat.h"
+#include "JsonReader.h"
+#include "JsonWriter.h"
+#include "ShapeRegistry.h"
 
 namespace Ser {
 
-static QJsonObject shapeToJson(const Shape& s) {
-    // 使用虚函数 ToJson 生成对象（其中包含 type 与 geom）
-    return s.ToJson();
+// 写出的 JSON 版本：2 起顶点为扁平数组、样式集中在 styles 表中；读取兼容版本 1
+constexpr int kJsonVersion = 2;
+
+// 版本 2 的样式表：JSON 写法相同的样式（只差描边颜色，JSON 中不保存）合并为一项，按首次出现的次序
+class StyleTableBuilder {
+public:
+    int ref(const ShapeStore::Style& st) {
+        auto it = seen_.constFind({st.color, st.penWidth});
+        if (it == seen_.constEnd()) {
+            it = seen_.insert({st.color, st.penWidth}, static_cast<int>(table_.size()));
+            table_.append(ShapeStore::StyleJson(st));
+        }
+        return it.value();
+    }
+    const QJsonArray& table() const { return table_; }
+
+private:
+    QJsonArray table_;
+    QHash<QPair<QRgb, double>, int> seen_;
+};
+
+// refs 为快照样式下标到表中下标的映射
+static QJsonArray styleTable(const ShapeStore& store, std::vector<int>& refs) {
+    StyleTableBuilder b;
+    refs.clear();
+    refs.reserve(store.styles().size());
+    for (const auto& st : store.styles()) refs.push_back(b.ref(st));
+    return b.table();
+}
+
+// 直接遍历图形列表（不建快照）：refs[i] 为 shapes[i] 的表中下标，空指针为 -1；
+// 同一进程样式（Shape::styleIndex）只换算一次
+static QJsonArray styleTable(const std::vector<Shape*>& shapes, std::vector<int>& refs) {
+    StyleTableBuilder b;
+    QHash<quint32, int> byStyle;
+    refs.clear();
+    refs.reserve(shapes.size());
+    for (auto* s : shapes) {
+        if (!s) {
+            refs.push_back(-1);
+            continue;
+        }
+        auto it = byStyle.constFind(s->styleIndex());
+        if (it == byStyle.constEnd()) it = byStyle.insert(s->styleIndex(), b.ref(ShapeStore::StyleOf(*s)));
+        refs.push_back(it.value());
+    }
+    return b.table();
 }
 
 QJsonDocument Serialize(const std::vector<Shape*>& shapes) {
+    std::vector<int> refs;
+    const QJsonArray styles = styleTable(shapes, refs);
     QJsonArray arr;
-    for (auto* s : shapes) {
-        if (!s) continue;
-        arr.append(shapeToJson(*s));
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        if (shapes[i]) arr.append(ShapeStore::CompactJson(*shapes[i], refs[i]));
+    }
+    QJsonObject root{{"version", kJsonVersion}, {"shapes", arr}, {"styles", styles}};
+    return QJsonDocument(root);
+}
+
+QJsonDocument Serialize(const ShapeStore& store) {
+    std::vector<int> refs;
+    const QJsonArray styles = styleTable(store, refs);
+    QJsonArray arr;
+    for (int row = 0; row < store.size(); ++row) {
+        arr.append(store.toCompactJson(row, refs[store.styleIndex(row)]));
     }
-    QJsonObject root{{"version", 1}, {"shapes", arr}};
+    QJsonObject root{{"version", kJsonVersion}, {"shapes", arr}, {"styles", styles}};
     return QJsonDocument(root);
 }
 
 std::unique_ptr<Shape> FromJsonObject(const QJsonObject& obj) {
-    const auto type = obj["type"].toString();
-    if (type == QStringLiteral("LineSegment")) return LineSegment::FromJson(obj);
-    if (type == QStringLiteral("Rectangle"))   return Rectangle::FromJson(obj);
-    if (type == QStringLiteral("Circle"))      return Circle::FromJson(obj);
-    if (type == QStringLiteral("Triangle"))    return Triangle::FromJson(obj);
-    if (type == QStringLiteral("Polygon"))     return Polygon::FromJson(obj);
-    if (type == QStringLiteral("Polyline"))    return Polyline::FromJson(obj);
-    if (type == QStringLiteral("Ellipse"))     return Ellipse::FromJson(obj);
-    return {};
+    // 类型名一次哈希查找
+    const auto* codec = ShapeRegistry::instance().find(obj["type"].toString());
+    return codec ? codec->fromJson(obj) : nullptr;
+}
+
+// 文档中的图形对象：版本 1 与 Shape::ToJson 相同；版本 2 的 style 为样式表下标、points 为扁平数组。
+// 按值的类型识别两种写法，因此不依赖根对象的 version
+static std::unique_ptr<Shape> shapeFromDocument(QJsonObject obj, const QJsonArray& styles) {
+    const auto* codec = ShapeRegistry::instance().find(obj["type"].toString());
+    if (!codec) return nullptr;
+    const QJsonValue style = obj.value(QLatin1String("style"));
+    // 下标越界时 at() 为 Undefined，插入即移除该键
+    if (style.isDouble()) obj.insert(QStringLiteral("style"), styles.at(style.toInt()));
+    const QJsonArray pts = obj["geom"].toObject()["points"].toArray();
+    if (codec->fromPoints && !pts.isEmpty() && pts.first().isDouble()) {
+        QVector<QPointF> points;
+        points.reserve(pts.size() / 2);
+        for (qsizetype i = 0; i + 1 < pts.size(); i += 2) points.append(QPointF(pts[i].toDouble(), pts[i + 1].toDouble()));
+        auto s = codec->fromPoints(points);
+        s->FromJsonCommon(obj);
+        return s;
+    }
+    return codec->fromJson(obj);
 }
 
 std::vector<std::unique_ptr<Shape>> Deserialize(const QJsonDocument& doc) {
@@ -42,88 +120,463 @@ std::vector<std::unique_ptr<Shape>> Deserialize(const QJsonDocument& doc) {
     if (!doc.isObject()) return out;
     auto root = doc.object();
     auto arr = root["shapes"].toArray();
+    const QJsonArray styles = root["styles"].toArray();
     out.reserve(arr.size());
     for (const auto& v : arr) {
-        auto obj = v.toObject();
-        if (auto s = FromJsonObject(obj)) out.push_back(std::move(s));
+        if (auto s = shapeFromDocument(v.toObject(), styles)) out.push_back(std::move(s));
     }
     return out;
 }
 
-bool SaveToFile(const QString& path, const std::vector<Shape*>& shapes, QString* error) {
-    QFile f(path);
+// 进度回调的最小间隔（字节）
+static constexpr qint64 kProgressStep = 256 * 1024;
+// 按图形计数的进度间隔
+static constexpr qint64 kProgressShapes = 4096;
+// 不小于该大小的 JSON 文件并行解析
+static constexpr qint64 kParallelMinBytes = 4 * 1024 * 1024;
+
+static QString cancelledMessage() { return QObject::tr("操作已取消"); }
+
+// 读取一个点对象 {"x":..,"y":..}；缺失或非数字的分量为 0（与 PointList::FromJson 相同）
+static QPointF readPoint(JsonReader& r) {
+    double x = 0.0, y = 0.0;
+    if (r.peekType() != JsonReader::Type::Object) {
+        r.skipValue();
+        return {};
+    }
+    r.beginObject();
+    while (r.nextKey()) {
+        const bool isX = r.key() == "x", isY = r.key() == "y";
+        if ((isX || isY) && r.peekType() == JsonReader::Type::Number) (isX ? x : y) = r.readNumber();
+        else r.skipValue();
+    }
+    return {x, y};
+}
+
+// 读取一个图形对象。geom.points 直接读入 points（调用方复用其容量；扁平数组与点对象两种写法），
+// 其余字段都很小，仍组装为 QJsonObject 交给注册表中的构造函数。
+// 版本 2 的 style 为样式表下标，存入 styleRef（样式表可能在 shapes 之后，由调用方最后应用），否则为 -1
+static std::unique_ptr<Shape> readShape(JsonReader& r, std::vector<QPointF>& points, int& styleRef) {
+    styleRef = -1;
+    if (r.peekType() != JsonReader::Type::Object) {
+        r.skipValue();
+        return nullptr;
+    }
+    QJsonObject obj, geom;
+    bool hasPoints = false;
+    points.clear();
+    r.beginObject();
+    while (r.nextKey()) {
+        if (r.key() == "style" && r.peekType() == JsonReader::Type::Number) {
+            styleRef = static_cast<int>(r.readNumber());
+            continue;
+        }
+        if (r.key() != "geom" || r.peekType() != JsonReader::Type::Object) {
+            const QString k = QString::fromUtf8(r.key());
+            obj.insert(k, r.readValue());
+            continue;
+        }
+        geom = QJsonObject();
+        hasPoints = false;
+        points.clear();
+        r.beginObject();
+        while (r.nextKey()) {
+            if (r.key() == "points" && r.peekType() == JsonReader::Type::Array) {
+                hasPoints = true;
+                points.clear();
+                r.beginArray();
+                while (r.nextElement()) {
+                    if (r.peekType() != JsonReader::Type::Number) {
+                        points.push_back(readPoint(r));
+                        continue;
+                    }
+                    // 扁平数组：x 与 y 依次出现；奇数个数时末尾的 x 被忽略（与 Deserialize 相同）
+                    const double x = r.readNumber();
+                    if (!r.nextElement()) break;
+                    double y = 0.0;
+                    if (r.peekType() == JsonReader::Type::Number) y = r.readNumber();
+                    else r.skipValue();
+                    points.push_back(QPointF(x, y));
+                }
+            } else {
+                const QString k = QString::fromUtf8(r.key());
+                geom.insert(k, r.readValue());
+            }
+        }
+    }
+    if (r.hasError()) return nullptr;
+
+    const auto* codec = ShapeRegistry::instance().find(obj["type"].toString());
+    if (!codec) return nullptr;
+    if (hasPoints && codec->fromPoints) {
+        // 按实际点数一次分配
+        auto s = codec->fromPoints(QVector<QPointF>(points.begin(), points.end()));
+        s->FromJsonCommon(obj);
+        return s;
+    }
+    obj.insert(QStringLiteral("geom"), geom);
+    return codec->fromJson(obj);
+}
+
+// 根对象：shapes 数组由 readShapes 读取（停在数组之前调用；返回 false 表示取消，立即停止），
+// 样式表（版本 2，体积很小）读入 styles，其余键跳过；非对象的合法文档（如数组）结果为空，与 Deserialize 相同
+template <class ReadShapes>
+static bool readDocument(JsonReader& r, QJsonArray& styles, ReadShapes&& readShapes) {
+    if (r.peekType() == JsonReader::Type::Object) {
+        r.beginObject();
+        while (r.nextKey()) {
+            const bool isArray = r.peekType() == JsonReader::Type::Array;
+            if (isArray && r.key() == "styles") styles = r.readValue().toArray();
+            else if (!isArray || r.key() != "shapes") r.skipValue();
+            else if (!readShapes()) return false;
+        }
+    } else {
+        r.skipValue();
+    }
+    return r.atDocumentEnd();
+}
+
+// 读完整个文档后按样式表下标应用样式（refs 与 shapes 一一对应）。
+// 新构造的图形均为默认样式：每个文档样式只驻留一次，之后各图形只改指下标
+static void applyStyles(std::vector<std::unique_ptr<Shape>>& shapes, const std::vector<int>& refs,
+                        const QJsonArray& styles) {
+    std::vector<quint32> interned;
+    interned.reserve(static_cast<size_t>(styles.size()));
+    for (const auto& st : styles) interned.push_back(StyleTable::instance().internJson(st.toObject()));
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        const int ref = refs[i];
+        if (ref >= 0 && ref < static_cast<int>(interned.size())) shapes[i]->setStyleIndex(interned[static_cast<size_t>(ref)]);
+    }
+}
+
+std::vector<std::unique_ptr<Shape>> ReadJson(QIODevice& in, QString* error, const Progress& progress) {
+    std::vector<std::unique_ptr<Shape>> out;
+    std::vector<int> refs;
+    QJsonArray styles;
+    const qint64 total = in.isSequential() ? 0 : in.size();
+    qint64 reported = 0;
+    JsonReader r(in);
+    std::vector<QPointF> points;
+    const bool ok = readDocument(r, styles, [&] {
+        out.clear();
+        refs.clear();
+        r.beginArray();
+        int ref = -1;
+        while (r.nextElement()) {
+            if (auto s = readShape(r, points, ref)) {
+                out.push_back(std::move(s));
+                refs.push_back(ref);
+            }
+            if (progress && r.bytesConsumed() - reported >= kProgressStep) {
+                reported = r.bytesConsumed();
+                if (!progress(reported, total)) return false;
+            }
+        }
+        return true;
+    });
+    if (!ok || (progress && !progress(r.bytesConsumed(), total))) {
+        if (error) *error = r.hasError() ? r.errorString() : cancelledMessage();
+        return {};
+    }
+    applyStyles(out, refs, styles);
+    return out;
+}
+
+// 并行解析：每线程的分段数（多于线程数以均衡负载）与单段最小字节数
+static constexpr int kChunksPerThread = 4;
+static constexpr qint64 kMinChunkBytes = 64 * 1024;
+
+// 从 data[begin] 处的 '[' 找到匹配的闭括号（跳过字符串，只数括号），途中在深度 1 的逗号处
+// 约每 chunkBytes 切一段；splits 为各段起始偏移（首段紧随 '['）。返回闭括号偏移，未闭合时为 -1
+static qint64 splitArray(const char* data, qint64 size, qint64 begin, qint64 chunkBytes, std::vector<qint64>& splits) {
+    splits.assign(1, begin + 1);
+    qint64 next = begin + 1 + chunkBytes;
+    int depth = 0;
+    for (qint64 i = begin; i < size; ++i) {
+        switch (data[i]) {
+        case '"':
+            for (++i; i < size && data[i] != '"'; ++i) {
+                if (data[i] == '\\') ++i;
+            }
+            break;
+        case '[': case '{':
+            ++depth;
+            break;
+        case ']': case '}':
+            if (--depth == 0) return i;
+            break;
+        case ',':
+            if (depth == 1 && i >= next) {
+                splits.push_back(i + 1);
+                next = i + 1 + chunkBytes;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return -1;
+}
+
+// 各段由工作线程按序领取并解析为图形；调用线程同样参与，并在每段完成后报告进度（可取消）。
+// 每段是逗号分隔的元素序列，语法仍由 JsonReader 严格检查
+static std::vector<std::unique_ptr<Shape>> parseChunks(const char* data, const std::vector<qint64>& splits, qint64 end,
+                                                       int threads, const Progress& progress, qint64 total,
+                                                       std::vector<int>& refs, QString& error) {
+    const size_t n = splits.size();
+    std::atomic<bool> stop {false};
+    std::vector<std::vector<std::unique_ptr<Shape>>> parts(n);
+    std::vector<std::vector<int>> partRefs(n);
+    std::vector<QString> errors(n);
+    std::atomic<size_t> nextChunk {0};
+    std::atomic<qint64> doneBytes {splits.front()};
+    auto work = [&](bool report) {
+        std::vector<QPointF> points;
+        for (size_t c = nextChunk++; c < n && !stop; c = nextChunk++) {
+            const qint64 b = splits[c];
+            const qint64 e = c + 1 < n ? splits[c + 1] - 1 : end; // 不含分段处的逗号
+            JsonReader r(data + b, e - b, b);
+            r.beginSequence();
+            qint64 values = 0;
+            int ref = -1;
+            while (!stop.load(std::memory_order_relaxed) && r.nextInSequence()) {
+                ++values;
+                if (auto s = readShape(r, points, ref)) {
+                    parts[c].push_back(std::move(s));
+                    partRefs[c].push_back(ref);
+                }
+            }
+            if (r.hasError()) {
+                errors[c] = r.errorString();
+            } else if (values == 0 && n > 1) {
+                errors[c] = QObject::tr("JSON 解析错误（第 %1 字节）：%2").arg(b).arg(QObject::tr("多余的逗号"));
+            }
+            doneBytes += e - b + 1;
+            if (report && progress && !progress(doneBytes.load(), total)) stop = true;
+        }
+    };
+    threads = std::max(1, std::min<int>(threads, static_cast<int>(n)));
+    std::vector<std::thread> workers;
+    workers.reserve(static_cast<size_t>(threads - 1));
+    for (int t = 1; t < threads; ++t) workers.emplace_back(work, false);
+    work(true);
+    for (auto& w : workers) w.join();
+    if (stop) {
+        error = cancelledMessage();
+        return {};
+    }
+
+    std::vector<std::unique_ptr<Shape>> out;
+    size_t count = 0;
+    for (size_t c = 0; c < n; ++c) {
+        // 按文档顺序取第一个错误
+        if (!errors[c].isEmpty()) {
+            error = errors[c];
+            return {};
+        }
+        count += parts[c].size();
+    }
+    out.reserve(count);
+    refs.clear();
+    refs.reserve(count);
+    for (size_t c = 0; c < n; ++c) {
+        for (auto& s : parts[c]) out.push_back(std::move(s));
+        refs.insert(refs.end(), partRefs[c].begin(), partRefs[c].end());
+    }
+    return out;
+}
+
+std::vector<std::unique_ptr<Shape>> ParseJson(const char* data, qint64 size, QString* error,
+                                              const Progress& progress, int threads) {
+    if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::unique_ptr<Shape>> out;
+    std::vector<int> refs;
+    QJsonArray styles;
+    QString chunkError;
+    JsonReader r(data, size);
+    const bool ok = readDocument(r, styles, [&] {
+        const qint64 begin = r.bytesConsumed();
+        const qint64 chunkBytes = std::max(kMinChunkBytes, (size - begin) / (qint64(threads) * kChunksPerThread));
+        std::vector<qint64> splits;
+        const qint64 end = splitArray(data, size, begin, chunkBytes, splits);
+        if (end < 0 || data[end] != ']') {
+            // 括号不匹配：按顺序读取，由解析器报告准确的错误位置
+            r.skipValue();
+            return true;
+        }
+        out = parseChunks(data, splits, end, threads, progress, size, refs, chunkError);
+        if (!chunkError.isEmpty()) return false;
+        r.skipBytes(end + 1 - begin);
+        return true;
+    });
+    if (!ok || (progress && !progress(size, size))) {
+        if (error) *error = !chunkError.isEmpty() ? chunkError : r.hasError() ? r.errorString() : cancelledMessage();
+        return {};
+    }
+    applyStyles(out, refs, styles);
+    return out;
+}
+
+// 写出 shapes 数组与样式表：emit(i, w) 写第 i 个图形（可跳过）；每 kProgressShapes 个图形报告一次进度
+template <class EmitShape>
+static bool writeJsonDocument(QIODevice& out, qint64 count, const QJsonArray& styles, EmitShape&& emitShape,
+                              QJsonDocument::JsonFormat format, QString* error, const Progress& progress) {
+    // 根对象的键按字典序：shapes、styles、version；内存中每次只保留一个图形的 JSON
+    JsonWriter w(out, format);
+    w.beginObject();
+    w.key(QStringLiteral("shapes"));
+    w.beginArray();
+    for (qint64 i = 0; i < count && w.ok(); ++i) {
+        emitShape(i, w);
+        if (progress && (i + 1) % kProgressShapes == 0 && !progress(i + 1, count)) {
+            if (error) *error = cancelledMessage();
+            return false;
+        }
+    }
+    w.endArray();
+    w.key(QStringLiteral("styles"));
+    w.value(styles);
+    w.key(QStringLiteral("version"));
+    w.value(kJsonVersion);
+    w.endObject();
+    if (!w.flush()) {
+        if (error) *error = w.errorString();
+        return false;
+    }
+    if (progress && !progress(count, count)) {
+        if (error) *error = cancelledMessage();
+        return false;
+    }
+    return true;
+}
+
+bool WriteJson(QIODevice& out, const std::vector<Shape*>& shapes, QJsonDocument::JsonFormat format, QString* error,
+               const Progress& progress) {
+    std::vector<int> refs;
+    const QJsonArray styles = styleTable(shapes, refs);
+    return writeJsonDocument(out, static_cast<qint64>(shapes.size()), styles, [&](qint64 i, JsonWriter& w) {
+        if (const Shape* s = shapes[size_t(i)]) w.value(ShapeStore::CompactJson(*s, refs[size_t(i)]));
+    }, format, error, progress);
+}
+
+bool WriteJson(QIODevice& out, const ShapeStore& store, QJsonDocument::JsonFormat format, QString* error,
+               const Progress& progress) {
+    std::vector<int> refs;
+    const QJsonArray styles = styleTable(store, refs);
+    return writeJsonDocument(out, store.size(), styles, [&](qint64 row, JsonWriter& w) {
+        const int r = static_cast<int>(row);
+        w.value(store.toCompactJson(r, refs[store.styleIndex(r)]));
+    }, format, error, progress);
+}
+
+// 经 QSaveFile 写入临时文件，全部成功后才替换目标文件；失败或取消时原文件保持不变
+template <class Write>
+static bool saveAtomically(const QString& path, QString* error, Write&& write) {
+    QSaveFile f(path);
     if (!f.open(QIODevice::WriteOnly)) {
         if (error) *error = f.errorString();
         return false;
     }
-    auto doc = Serialize(shapes);
-    f.write(doc.toJson(QJsonDocument::Indented));
+    if (!write(f)) {
+        f.cancelWriting();
+        return false;
+    }
+    if (!f.commit()) {
+        if (error) *error = f.errorString();
+        return false;
+    }
     return true;
 }
 
-std::vector<std::unique_ptr<Shape>> LoadFromFile(const QString& path, QString* error) {
+static bool isBinaryPath(const QString& path) { return path.endsWith(QStringLiteral(".fcadb"), Qt::CaseInsensitive); }
+
+bool SaveToFile(const QString& path, const std::vector<Shape*>& shapes, QString* error,
+                QJsonDocument::JsonFormat format, const Progress& progress) {
+    if (isBinaryPath(path)) return SaveToFile(path, ShapeStore::FromShapes(shapes), error, format, progress);
+    return saveAtomically(path, error, [&](QIODevice& f) { return WriteJson(f, shapes, format, error, progress); });
+}
+
+bool SaveToFile(const QString& path, const ShapeStore& store, QString* error,
+                QJsonDocument::JsonFormat format, const Progress& progress) {
+    if (isBinaryPath(path)) {
+        return saveAtomically(path, error, [&](QIODevice& f) {
+            if (!store.writeBinary(f, error)) return false;
+            // 二进制按列整段写出，只在提交前询问一次是否取消
+            if (progress && !progress(store.size(), store.size())) {
+                if (error) *error = cancelledMessage();
+                return false;
+            }
+            return true;
+        });
+    }
+    return saveAtomically(path, error, [&](QIODevice& f) { return WriteJson(f, store, format, error, progress); });
+}
+
+std::vector<std::unique_ptr<Shape>> LoadFromFile(const QString& path, QString* error, const Progress& progress) {
     QFile f(path);
     if (!f.open(QIODevice::ReadOnly)) {
         if (error) *error = f.errorString();
         return {};
     }
-    auto data = f.readAll();
-    QJsonParseError perr{};
-    auto doc = QJsonDocument::fromJson(data, &perr);
-    if (perr.error != QJsonParseError::NoError) {
-        if (error) *error = perr.errorString();
-        return {};
+    if (BinaryFormat::IsBinary(f.peek(sizeof(BinaryFormat::kMagic)))) {
+        f.close();
+        return LoadBinaryFile(path, error, progress);
     }
-    return Deserialize(doc);
+    // 较大的文件映射到内存后并行解析；映射失败或单核时流式读取
+    if (f.size() >= kParallelMinBytes && std::thread::hardware_concurrency() > 1) {
+        if (uchar* mapped = f.map(0, f.size())) {
+            auto out = ParseJson(reinterpret_cast<const char*>(mapped), f.size(), error, progress);
+            f.unmap(mapped);
+            return out;
+        }
+    }
+    return ReadJson(f, error, progress);
 }
 
-bool ApplyJsonToShape(Shape* s, const QJsonObject& obj) {
-    if (!s) return false;
-    if (obj["type"].toString() != s->typeName()) return false;
-    s->FromJsonCommon(obj);
-    auto g = obj["geom"].toObject();
-    if (auto* ls = dynamic_cast<LineSegment*>(s)) {
-        QPointF p1(g["x1"].toDouble(), g["y1"].toDouble());
-        QPointF p2(g["x2"].toDouble(), g["y2"].toDouble());
-        ls->setP1(p1); ls->setP2(p2);
-        return true;
-    }
-    if (auto* rc = dynamic_cast<Rectangle*>(s)) {
-        QRectF r(g["x"].toDouble(), g["y"].toDouble(), g["w"].toDouble(), g["h"].toDouble());
-        rc->setRect(r);
-        return true;
-    }
-    if (auto* cc = dynamic_cast<Circle*>(s)) {
-        QPointF c(g["cx"].toDouble(), g["cy"].toDouble());
-        double r = g["r"].toDouble();
-        cc->setCenter(c); cc->setRadius(r);
-        return true;
-    }
-    if (auto* tr = dynamic_cast<Triangle*>(s)) {
-        QPointF a(g["x1"].toDouble(), g["y1"].toDouble());
-        QPointF b(g["x2"].toDouble(), g["y2"].toDouble());
-        QPointF c(g["x3"].toDouble(), g["y3"].toDouble());
-        tr->setP1(a); tr->setP2(b); tr->setP3(c);
-        return true;
+bool SaveBinaryFile(const QString& path, const std::vector<Shape*>& shapes, QString* error) {
+    return SaveToFile(path, ShapeStore::FromShapes(shapes), error);
+}
+
+std::vector<std::unique_ptr<Shape>> LoadBinaryFile(const QString& path, QString* error, const Progress& progress) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        if (error) *error = f.errorString();
+        return {};
     }
-    if (auto* pg = dynamic_cast<Polygon*>(s)) {
-        QVector<QPointF> pts; for (const auto& v : g["points"].toArray()) { auto o = v.toObject(); pts.push_back(QPointF(o["x"].toDouble(), o["y"].toDouble())); }
-        pg->setPoints(pts);
-        return true;
+    ShapeStore store;
+    bool ok = false;
+    if (uchar* mapped = f.size() > 0 ? f.map(0, f.size()) : nullptr) {
+        ok = ShapeStore::ReadBinary(mapped, f.size(), store, error);
+        f.unmap(mapped);
+    } else {
+        // 无法映射（如某些虚拟文件系统）时退回整体读取
+        const QByteArray bytes = f.readAll();
+        ok = ShapeStore::ReadBinary(reinterpret_cast<const uchar*>(bytes.constData()), bytes.size(), store, error);
     }
-    if (auto* pl = dynamic_cast<Polyline*>(s)) {
-        QVector<QPointF> pts; for (const auto& v : g["points"].toArray()) { auto o = v.toObject(); pts.push_back(QPointF(o["x"].toDouble(), o["y"].toDouble())); }
-        pl->setPoints(pts);
-        return true;
+    if (!ok) return {};
+    std::vector<std::unique_ptr<Shape>> out;
+    out.reserve(static_cast<size_t>(store.size()));
+    for (int row = 0; row < store.size(); ++row) {
+        if (auto s = store.makeShape(row)) out.push_back(std::move(s));
+        if (progress && (row + 1) % kProgressShapes == 0 && !progress(row + 1, store.size())) {
+            if (error) *error = cancelledMessage();
+            return {};
+        }
     }
-    if (auto* el = dynamic_cast<Ellipse*>(s)) {
-        QPointF c(g["cx"].toDouble(), g["cy"].toDouble());
-        double rx = g["rx"].toDouble();
-        double ry = g["ry"].toDouble();
-        el->setCenter(c); el->setRx(rx); el->setRy(ry);
-        return true;
+    if (progress && !progress(store.size(), store.size())) {
+        if (error) *error = cancelledMessage();
+        return {};
     }
-    return false;
+    return out;
+}
+
+bool ApplyJsonToShape(Shape* s, const QJsonObject& obj) {
+    if (!s) return false;
+    const auto* codec = ShapeRegistry::instance().find(s->kind());
+    if (!codec || obj["type"].toString() != codec->typeName) return false;
+    s->FromJsonCommon(obj);
+    codec->applyGeometryJson(*s, obj["geom"].toObject());
+    return true;
 }
 
 } // namespace Ser
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <vector>
 #include <QString>
 #include <QJsonDocument>
 #include "Shape.h"
+#include "ShapeStore.h"
 #include "shapes/LineSegment.h"
 #include "shapes/Rectangle.h"
 #include "shapes/Circle.h"
@@ -13,13 +15,57 @@
 #include "shapes/Polyline.h"
 #include "shapes/Ellipse.h"
 
+class QIODevice;
+
 namespace Ser {
 
+// 生成版本 2 文档：顶点为扁平数组 [x0,y0,x1,y1,...]，样式去重后放在 styles 表中，图形只存下标
 QJsonDocument Serialize(const std::vector<Shape*>& shapes);
+// 从列式存储顺序生成（输出与逐对象 Serialize 相同）
+QJsonDocument Serialize(const ShapeStore& store);
+// 版本 1（与 Shape::ToJson 相同的图形对象）与版本 2 均可读取
 std::vector<std::unique_ptr<Shape>> Deserialize(const QJsonDocument& doc);
 
-bool SaveToFile(const QString& path, const std::vector<Shape*>& shapes, QString* error = nullptr);
-std::vector<std::unique_ptr<Shape>> LoadFromFile(const QString& path, QString* error = nullptr);
+// 读写进度：已完成量与总量（JSON 读取按字节，写出与二进制读取按图形数；总量未知时为 0）。
+// 返回 false 请求取消：操作尽快停止，返回失败/空结果，error 为“操作已取消”
+using Progress = std::function<bool(qint64 done, qint64 total)>;
+
+// 流式写出：逐个图形直接写入 out（内部缓冲），不构造整个文档；
+// 输出与 Serialize(shapes).toJson(format) 逐字节一致
+bool WriteJson(QIODevice& out, const std::vector<Shape*>& shapes,
+               QJsonDocument::JsonFormat format = QJsonDocument::Indented, QString* error = nullptr,
+               const Progress& progress = {});
+// 从列式快照写出（可在后台线程进行）
+bool WriteJson(QIODevice& out, const ShapeStore& store,
+               QJsonDocument::JsonFormat format = QJsonDocument::Indented, QString* error = nullptr,
+               const Progress& progress = {});
+
+// 流式读取：以拉取式解析器逐个读出 shapes 中的图形并直接构造，不建立整个文档的 DOM；
+// 顶点数组直接读入 QVector<QPointF>。解析内存与文件大小无关。结果与 Deserialize 相同，
+// JSON 语法错误时返回空并设置 error
+std::vector<std::unique_ptr<Shape>> ReadJson(QIODevice& in, QString* error = nullptr,
+                                             const Progress& progress = {});
+
+// 并行读取内存中的整个文档：先快速扫描 shapes 数组（只识别字符串与括号），在元素边界处切段，
+// 各段由 threads 个线程（<= 0 时为硬件线程数）解析，结果按文档顺序合并；其余行为同 ReadJson。
+// progress 只在调用线程上回调。LoadFromFile 对较大的 JSON 文件映射后走此路径
+std::vector<std::unique_ptr<Shape>> ParseJson(const char* data, qint64 size, QString* error = nullptr,
+                                              const Progress& progress = {}, int threads = 0);
+
+// 文件名以 .fcadb 结尾时保存为二进制格式，否则为 JSON（流式写出，format 选择缩进或紧凑）；
+// 经 QSaveFile 写出，失败或取消时原文件不变。读取时按文件头自动识别
+bool SaveToFile(const QString& path, const std::vector<Shape*>& shapes, QString* error = nullptr,
+                QJsonDocument::JsonFormat format = QJsonDocument::Indented, const Progress& progress = {});
+// 保存列式快照：后台保存时由 GUI 线程先取快照，之后不再访问 Shape 对象
+bool SaveToFile(const QString& path, const ShapeStore& store, QString* error = nullptr,
+                QJsonDocument::JsonFormat format = QJsonDocument::Indented, const Progress& progress = {});
+std::vector<std::unique_ptr<Shape>> LoadFromFile(const QString& path, QString* error = nullptr,
+                                                 const Progress& progress = {});
+
+// .fcadb 二进制文档（见 BinaryFormat.h）；读取时以 QFile::map 映射整个文件
+bool SaveBinaryFile(const QString& path, const std::vector<Shape*>& shapes, QString* error = nullptr);
+std::vector<std::unique_ptr<Shape>> LoadBinaryFile(const QString& path, QString* error = nullptr,
+                                                   const Progress& progress = {});
 
 // 工具：从单个对象构造 Shape；将 JSON 应用到现有 Shape（类型需匹配）
 std::unique_ptr<Shape> FromJsonObject(const QJsonObject& obj);
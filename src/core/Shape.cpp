@@ -1,14 +1,34 @@
 #include "Shape.h"
 
 #include <QtMath>
+#include <algorithm>
 #include <cmath>
 
+#include "GeometryKernels.h"
+
+void Shape::setColor(const QColor& c) { style_ = StyleTable::instance().intern(c, pen()); }
+
+void Shape::setPen(const QPen& p) { style_ = StyleTable::instance().intern(color(), p); }
+
+void Shape::setPenColor(const QColor& c) {
+    QPen p = pen();
+    p.setColor(c);
+    setPen(p);
+}
+
+void Shape::setPenWidth(double w) {
+    QPen p = pen();
+    p.setWidthF(w);
+    setPen(p);
+}
+
 QJsonObject Shape::ToJson() const {
+    const auto& st = StyleTable::instance().at(style_);
     QJsonObject obj;
     obj["name"] = name_;
     obj["style"] = QJsonObject{
-        {"color", color_.name(QColor::HexArgb)},
-        {"pen", QJsonObject{{"width", pen_.widthF()}}}
+        {"color", st.color.name(QColor::HexArgb)},
+        {"pen", QJsonObject{{"width", st.pen.widthF()}}}
     };
     // 变换：平移 + 旋转（度）
     obj["transform"] = QJsonObject{{"tx", transform_.m31()}, {"ty", transform_.m32()}, {"rot", rotation_deg_}};
@@ -17,17 +37,8 @@ QJsonObject Shape::ToJson() const {
 
 void Shape::FromJsonCommon(const QJsonObject& obj) {
     if (obj.contains("name")) name_ = obj["name"].toString();
-    if (obj.contains("style")) {
-        auto s = obj["style"].toObject();
-        if (s.contains("color")) {
-            color_.setNamedColor(s["color"].toString());
-            pen_.setColor(color_);
-        }
-        if (s.contains("pen")) {
-            auto p = s["pen"].toObject();
-            if (p.contains("width")) pen_.setWidthF(p["width"].toDouble());
-        }
-    }
+    // 同一 (样式, 颜色字符串, 线宽) 只解析一次，之后为样式表中的一次哈希查找
+    if (obj.contains("style")) style_ = StyleTable::instance().internJson(obj["style"].toObject(), style_);
     if (obj.contains("transform")) {
         auto t = obj["transform"].toObject();
         auto tx = t["tx"].toDouble();
@@ -38,17 +49,62 @@ void Shape::FromJsonCommon(const QJsonObject& obj) {
                        newT.m21(), newT.m22(), newT.m23(),
                        tx,          ty,          newT.m33());
         transform_ = newT;
+        invalidateTransform();
+    }
+}
+
+bool Shape::MovePointInBounds(QRectF& bounds, const QPointF& from, const QPointF& to) {
+    // from 在某条边上而 to 向内移动：该边可能收缩，需整体重算
+    if ((from.x() <= bounds.left() && to.x() > from.x()) || (from.x() >= bounds.right() && to.x() < from.x())
+        || (from.y() <= bounds.top() && to.y() > from.y()) || (from.y() >= bounds.bottom() && to.y() < from.y())) {
+        return false;
+    }
+    bounds = QRectF(QPointF(std::min(bounds.left(), to.x()), std::min(bounds.top(), to.y())),
+                    QPointF(std::max(bounds.right(), to.x()), std::max(bounds.bottom(), to.y())));
+    return true;
+}
+
+const QRectF& Shape::LocalBounds() const {
+    if (!cache_.localValid) {
+        cache_.local = ComputeLocalBounds().normalized();
+        cache_.localValid = true;
+    }
+    return cache_.local;
+}
+
+QRectF Shape::BoundingBox() const {
+    if (!cache_.worldValid) {
+        cache_.world = transform_.mapRect(LocalBounds());
+        cache_.worldValid = true;
     }
+    return cache_.world;
+}
+
+double AreaShape::Area() const {
+    auto& c = cache();
+    if (!c.areaValid) { c.area = ComputeArea(); c.areaValid = true; }
+    return c.area;
+}
+
+double AreaShape::Perimeter() const {
+    auto& c = cache();
+    if (!c.perimeterValid) { c.perimeter = ComputePerimeter(); c.perimeterValid = true; }
+    return c.perimeter;
 }
 
 double LineShape::Length() const {
+    auto& c = cache();
+    if (!c.lengthValid) { c.length = ComputeLength(); c.lengthValid = true; }
+    return c.length;
+}
+
+double LineShape::ComputeLength() const {
     const auto pts = Vertices();
-    if (pts.size() < 2) return 0.0;
-    double sum = 0.0;
-    for (int i = 1; i < pts.size(); ++i) {
-        const auto dx = pts[i].x() - pts[i - 1].x();
-        const auto dy = pts[i].y() - pts[i - 1].y();
-        sum += std::hypot(dx, dy);
-    }
-    return sum;
+    return PathLength(pts.constData(), pts.size());
+}
+
+double LineShape::PathLength(const QPointF* pts, qsizetype n) {
+    if (n < 2) return 0.0;
+    static_assert(sizeof(QPointF) == 2 * sizeof(double), "QPointF must be two packed doubles");
+    return Kernels::PathLength(reinterpret_cast<const double*>(pts), static_cast<std::size_t>(n));
 }
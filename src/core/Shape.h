@@ -9,10 +9,19 @@
 #include <QVector>
 #include <QPointF>
 
+#include "ShapeKind.h"
+#include "ObjectPool.h"
+#include "StyleTable.h"
+
 class Shape {
 public:
+    // 从对象池分配：批量加载/清场时避免逐个向系统申请与归还小块内存
+    FAKECAD_POOL_ALLOCATED
     virtual ~Shape() = default;
 
+    // 类型标签（构造时确定，热路径按此查表分派，避免 dynamic_cast 链）
+    ShapeKind kind() const { return kind_; }
+
     // 类型名（运行时标识）
     virtual QString typeName() const = 0;
 
@@ -20,17 +29,23 @@ public:
     const QString& name() const { return name_; }
     void setName(const QString& n) { name_ = n; }
 
-    const QColor& color() const { return color_; }
-    void setColor(const QColor& c) { color_ = c; }
+    // 颜色与画笔存放在共享样式表（StyleTable）中，图形只保存下标；setter 按新值驻留后改指下标
+    const QColor& color() const { return StyleTable::instance().at(style_).color; }
+    void setColor(const QColor& c);
 
-    const QPen& pen() const { return pen_; }
-    void setPen(const QPen& p) { pen_ = p; }
+    const QPen& pen() const { return StyleTable::instance().at(style_).pen; }
+    void setPen(const QPen& p);
+    void setPenColor(const QColor& c);
+    void setPenWidth(double w);
+
+    quint32 styleIndex() const { return style_; }
+    void setStyleIndex(quint32 index) { style_ = index; }
 
     const QTransform& transform() const { return transform_; }
-    void setTransform(const QTransform& t) { transform_ = t; }
+    void setTransform(const QTransform& t) { transform_ = t; invalidateTransform(); }
 
     // 变换操作
-    virtual void Move(double dx, double dy) { transform_.translate(dx, dy); }
+    virtual void Move(double dx, double dy) { transform_.translate(dx, dy); invalidateTransform(); }
     virtual void MoveTo(double x, double y) {
         // 将平移部分设置为 (x, y)，其余变换保持
         QTransform t = transform_;
@@ -38,6 +53,7 @@ public:
                     t.m21(), t.m22(), t.m23(),
                     x,       y,       t.m33());
         transform_ = t;
+        invalidateTransform();
     }
     virtual void Rotate(double angleDeg) {
         rotation_deg_ += angleDeg;
@@ -46,20 +62,56 @@ public:
     // 度量接口
     virtual double Length() const { return 0.0; }
 
-    // 包围盒（局部+变换后）
-    virtual QRectF BoundingBox() const = 0;
+    // 包围盒（变换后）；结果缓存，几何或变换变化后才重新计算
+    QRectF BoundingBox() const;
+    // 局部坐标包围盒（未变换，已 normalized）；同样缓存
+    const QRectF& LocalBounds() const;
+
+    // 几何版本号：每次几何变化递增，供外部缓存（如显示层）判断是否失效
+    quint32 geometryRevision() const { return geometryRevision_; }
 
     // 序列化（通用字段）
     virtual QJsonObject ToJson() const;
     virtual void FromJsonCommon(const QJsonObject& obj);
 
 protected:
+    explicit Shape(ShapeKind kind) : kind_(kind) {}
+
+    // 子类计算局部包围盒（不含变换）
+    virtual QRectF ComputeLocalBounds() const = 0;
+
+    // 几何缓存：子类的几何 setter 修改后必须调用 invalidateGeometry()
+    // 注意：缓存在 const 查询中惰性填充，同一对象不可跨线程并发查询
+    struct MetricCache {
+        QRectF local;
+        QRectF world;
+        double area {0.0};
+        double perimeter {0.0};
+        double length {0.0};
+        bool localValid {false};
+        bool worldValid {false};
+        bool areaValid {false};
+        bool perimeterValid {false};
+        bool lengthValid {false};
+    };
+    void invalidateGeometry() { cache_ = MetricCache{}; ++geometryRevision_; }
+    void invalidateTransform() { cache_.worldValid = false; }
+    // 局部原位编辑：递增几何版本但保留缓存，由子类增量修正各项（无法修正的项自行置为失效）
+    void beginIncrementalEdit() { ++geometryRevision_; cache_.worldValid = false; }
+    // 点 from 移动到 to 后就地修正包围盒 bounds；from 位于边界且向内移动时无法确定，返回 false
+    static bool MovePointInBounds(QRectF& bounds, const QPointF& from, const QPointF& to);
+    MetricCache& cache() const { return cache_; }
+
     QString name_;
-    QColor color_{Qt::black};
-    QPen pen_{QPen(Qt::black)};
-    QTransform transform_{};
     double rotation_deg_ {0.0};
 
+private:
+    QTransform transform_{};
+    ShapeKind kind_;
+    quint32 style_ {StyleTable::kDefault};
+    quint32 geometryRevision_ {0};
+    mutable MetricCache cache_;
+
 public:
     double rotationDegrees() const { return rotation_deg_; }
     void setRotationDegrees(double deg) { rotation_deg_ = deg; }
@@ -72,13 +124,28 @@ public:
     virtual int VertexCount() const = 0;
     virtual QVector<QPointF> Vertices() const = 0;
 
+    // 路径长度（缓存）
     double Length() const override;
+
+    // 折线路径长度（相邻顶点距离之和）
+    static double PathLength(const QPointF* pts, qsizetype n);
+
+protected:
+    using Shape::Shape;
+    // 默认按 Vertices() 计算；持有连续顶点的子类可重写以避免拷贝
+    virtual double ComputeLength() const;
 };
 
 class AreaShape : public Shape {
 public:
     ~AreaShape() override = default;
-    virtual double Area() const = 0;
-    virtual double Perimeter() const = 0;
+    // 面积与周长（缓存）
+    double Area() const;
+    double Perimeter() const;
     double Length() const override { return Perimeter(); }
+
+protected:
+    using Shape::Shape;
+    virtual double ComputeArea() const = 0;
+    virtual double ComputePerimeter() const = 0;
 };
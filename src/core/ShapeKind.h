@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QtGlobal>
+
+// 具体图形的类型标签（紧凑，可直接作为数组下标）
+enum class ShapeKind : quint8 {
+    LineSegment,
+    Rectangle,
+    Circle,
+    Triangle,
+    Polygon,
+    Polyline,
+    Ellipse,
+    Count
+};
+
+constexpr int kShapeKindCount = static_cast<int>(ShapeKind::Count);
@@ -0,0 +1,14 @@
+#include "ShapeRegistry.h"
+
+ShapeRegistry& ShapeRegistry::instance() {
+    // 函数内静态：各图形 .cpp 的静态注册对象可能先于本单元初始化
+    static ShapeRegistry registry;
+    return registry;
+}
+
+void ShapeRegistry::add(const ShapeCodec& codec) {
+    const auto i = static_cast<int>(codec.kind);
+    if (i < 0 || i >= kShapeKindCount) return;
+    codecs_[i] = codec;
+    byName_.insert(codec.typeName, codec.kind);
+}
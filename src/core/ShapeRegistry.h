@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <type_traits>
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+
+#include "Shape.h"
+#include "ShapeKind.h"
+
+// 单个图形类型的构造与 JSON 编解码函数（.fcadb 直接按 ShapeStore 的列读写，不经此表）
+struct ShapeCodec {
+    ShapeKind kind {ShapeKind::Count};
+    QString typeName;
+    // 从完整 JSON 对象构造（含通用字段）
+    std::unique_ptr<Shape> (*fromJson)(const QJsonObject& obj) {nullptr};
+    // 将 geom 应用到同类型的已有对象
+    void (*applyGeometryJson)(Shape& s, const QJsonObject& geom) {nullptr};
+    QJsonObject (*toJson)(const Shape& s) {nullptr};
+    // 顶点列表类图形（geom 为 points）：由已解析的顶点直接构造，流式读取时不经 QJsonArray；其余类型为空
+    std::unique_ptr<Shape> (*fromPoints)(const QVector<QPointF>& pts) {nullptr};
+};
+
+// 图形类型注册表：类型名经一次哈希查找得到类型标签（ShapeKind），
+// 其余查询按标签直接下标访问。各具体图形在自身 .cpp 中用 Registrar 注册；
+// 这些目标文件均被 ShapeStore 等引用，静态库链接时不会被丢弃。
+class ShapeRegistry {
+public:
+    static ShapeRegistry& instance();
+
+    void add(const ShapeCodec& codec);
+
+    const ShapeCodec* find(ShapeKind kind) const {
+        const auto i = static_cast<int>(kind);
+        return (i >= 0 && i < kShapeKindCount && codecs_[i].fromJson) ? &codecs_[i] : nullptr;
+    }
+    const ShapeCodec* find(const QString& typeName) const {
+        auto it = byName_.constFind(typeName);
+        return it == byName_.constEnd() ? nullptr : &codecs_[static_cast<int>(it.value())];
+    }
+
+    struct Registrar {
+        explicit Registrar(const ShapeCodec& codec) { instance().add(codec); }
+    };
+
+private:
+    ShapeRegistry() = default;
+
+    std::array<ShapeCodec, kShapeKindCount> codecs_ {};
+    QHash<QString, ShapeKind> byName_;
+};
+
+// 由具体类型 T 的 FromJson / ApplyGeometryJson 生成编解码表项；
+// T 可由 QVector<QPointF> 构造时同时生成 fromPoints。各图形类声明这组成员：
+// ApplyGeometryJson 将 geom 应用到本对象
+template <class T>
+ShapeCodec MakeShapeCodec(const QString& typeName) {
+    ShapeCodec c;
+    c.kind = T::kKind;
+    c.typeName = typeName;
+    c.fromJson = [](const QJsonObject& obj) -> std::unique_ptr<Shape> { return T::FromJson(obj); };
+    c.applyGeometryJson = [](Shape& s, const QJsonObject& geom) { static_cast<T&>(s).ApplyGeometryJson(geom); };
+    c.toJson = [](const Shape& s) { return static_cast<const T&>(s).ToJson(); };
+    if constexpr (std::is_constructible_v<T, const QVector<QPointF>&>) {
+        c.fromPoints = [](const QVector<QPointF>& pts) -> std::unique_ptr<Shape> { return std::make_unique<T>(pts); };
+    }
+    return c;
+}
@@ -0,0 +1,363 @@
+#include "ShapeStore.h"
+
+#include <QJsonArray>
+#include <QPolygonF>
+#include <cmath>
+
+#include "shapes/LineSegment.h"
+#include "shapes/Rectangle.h"
+#include "shapes/Circle.h"
+#include "shapes/Triangle.h"
+#include "shapes/Polygon.h"
+#include "shapes/Polyline.h"
+#include "shapes/Ellipse.h"
+
+size_t qHash(const ShapeStore::Style& s, size_t seed) noexcept {
+    return qHashMulti(seed, s.color, s.penColor, s.penWidth);
+}
+
+static QJsonArray pointsToJson(const QPointF* pts, qsizetype n, bool flat) {
+    QJsonArray arr;
+    if (flat) {
+        for (qsizetype i = 0; i < n; ++i) {
+            arr.append(pts[i].x());
+            arr.append(pts[i].y());
+        }
+        return arr;
+    }
+    for (qsizetype i = 0; i < n; ++i) arr.append(QJsonObject{{"x", pts[i].x()}, {"y", pts[i].y()}});
+    return arr;
+}
+
+ShapeStore ShapeStore::FromShapes(const std::vector<Shape*>& shapes) {
+    ShapeStore store;
+    store.reserve(static_cast<qsizetype>(shapes.size()));
+    for (auto* s : shapes) {
+        if (s) store.append(*s);
+    }
+    return store;
+}
+
+void ShapeStore::reserve(qsizetype rows) {
+    const auto n = static_cast<size_t>(rows);
+    kind_.reserve(n);
+    slot_.reserve(n);
+    styleIndex_.reserve(n);
+    name_.reserve(n);
+    tx_.reserve(n);
+    ty_.reserve(n);
+    rot_.reserve(n);
+}
+
+void ShapeStore::clear() {
+    *this = ShapeStore();
+}
+
+quint32 ShapeStore::internStyle(const Style& s) {
+    // 相邻图形大多同样式，先比较最近一条
+    if (!styles_.empty() && styles_.back() == s) return static_cast<quint32>(styles_.size() - 1);
+    auto it = styleLookup_.constFind(s);
+    if (it != styleLookup_.constEnd()) return it.value();
+    const auto idx = static_cast<quint32>(styles_.size());
+    styles_.push_back(s);
+    styleLookup_.insert(s, idx);
+    return idx;
+}
+
+ShapeStore::VertexRange ShapeStore::appendVertices(const QVector<QPointF>& pts) {
+    VertexRange r{static_cast<qsizetype>(vertices_.size()), pts.size()};
+    vertices_.insert(vertices_.end(), pts.cbegin(), pts.cend());
+    return r;
+}
+
+int ShapeStore::append(const Shape& s) {
+    quint32 slot = 0;
+    const ShapeKind kind = s.kind();
+    switch (kind) {
+    case ShapeKind::LineSegment: {
+        const auto& ls = static_cast<const LineSegment&>(s);
+        slot = static_cast<quint32>(segments_.size());
+        segments_.push_back({ls.p1(), ls.p2()});
+        break;
+    }
+    case ShapeKind::Rectangle:
+        slot = static_cast<quint32>(rects_.size());
+        rects_.push_back(static_cast<const Rectangle&>(s).rect());
+        break;
+    case ShapeKind::Circle: {
+        const auto& cc = static_cast<const Circle&>(s);
+        slot = static_cast<quint32>(circles_.size());
+        circles_.push_back({cc.center(), cc.radius()});
+        break;
+    }
+    case ShapeKind::Triangle: {
+        const auto& tr = static_cast<const Triangle&>(s);
+        slot = static_cast<quint32>(triangles_.size());
+        triangles_.push_back({tr.p1(), tr.p2(), tr.p3()});
+        break;
+    }
+    case ShapeKind::Polygon:
+        slot = static_cast<quint32>(polygonRanges_.size());
+        polygonRanges_.push_back(appendVertices(static_cast<const Polygon&>(s).points()));
+        break;
+    case ShapeKind::Polyline:
+        slot = static_cast<quint32>(polylineRanges_.size());
+        polylineRanges_.push_back(appendVertices(static_cast<const Polyline&>(s).points()));
+        break;
+    case ShapeKind::Ellipse: {
+        const auto& el = static_cast<const Ellipse&>(s);
+        slot = static_cast<quint32>(ellipses_.size());
+        ellipses_.push_back({el.center(), el.rx(), el.ry()});
+        break;
+    }
+    default:
+        return -1;
+    }
+
+    kind_.push_back(kind);
+    slot_.push_back(slot);
+    styleIndex_.push_back(internStyle(StyleOf(s)));
+    name_.push_back(s.name());
+    tx_.push_back(s.transform().m31());
+    ty_.push_back(s.transform().m32());
+    rot_.push_back(s.rotationDegrees());
+    return size() - 1;
+}
+
+QString ShapeStore::typeName(int row) const { return KindName(kind_[row]); }
+
+QString ShapeStore::KindName(ShapeKind kind) {
+    switch (kind) {
+    case ShapeKind::LineSegment: return QStringLiteral("LineSegment");
+    case ShapeKind::Rectangle:   return QStringLiteral("Rectangle");
+    case ShapeKind::Circle:      return QStringLiteral("Circle");
+    case ShapeKind::Triangle:    return QStringLiteral("Triangle");
+    case ShapeKind::Polygon:     return QStringLiteral("Polygon");
+    case ShapeKind::Polyline:    return QStringLiteral("Polyline");
+    case ShapeKind::Ellipse:     return QStringLiteral("Ellipse");
+    default: break;
+    }
+    return {};
+}
+
+QRectF ShapeStore::boundingBox(int row) const {
+    const auto k = slot_[row];
+    QRectF local;
+    switch (kind_[row]) {
+    case ShapeKind::LineSegment:
+        local = QRectF(segments_[k].p1, segments_[k].p2).normalized();
+        break;
+    case ShapeKind::Rectangle:
+        local = rects_[k].normalized();
+        break;
+    case ShapeKind::Circle: {
+        const auto& c = circles_[k];
+        local = QRectF(c.center.x() - c.radius, c.center.y() - c.radius, c.radius * 2.0, c.radius * 2.0).normalized();
+        break;
+    }
+    case ShapeKind::Ellipse: {
+        const auto& e = ellipses_[k];
+        local = QRectF(e.center.x() - e.rx, e.center.y() - e.ry, e.rx * 2, e.ry * 2).normalized();
+        break;
+    }
+    case ShapeKind::Triangle: {
+        const auto& t = triangles_[k];
+        QPolygonF poly; poly << t.a << t.b << t.c;
+        local = poly.boundingRect();
+        break;
+    }
+    case ShapeKind::Polygon:
+    case ShapeKind::Polyline: {
+        const auto& r = (kind_[row] == ShapeKind::Polygon) ? polygonRanges_[k] : polylineRanges_[k];
+        if (r.count == 0) { local = QRectF(); break; }
+        const QPointF* p = vertexData(r);
+        double minX = p[0].x(), maxX = p[0].x(), minY = p[0].y(), maxY = p[0].y();
+        for (qsizetype i = 1; i < r.count; ++i) {
+            minX = std::min(minX, p[i].x()); maxX = std::max(maxX, p[i].x());
+            minY = std::min(minY, p[i].y()); maxY = std::max(maxY, p[i].y());
+        }
+        local = QRectF(QPointF(minX, minY), QPointF(maxX, maxY));
+        break;
+    }
+    default:
+        break;
+    }
+    // 模型中的变换仅含平移
+    return local.translated(tx_[row], ty_[row]);
+}
+
+double ShapeStore::length(int row) const {
+    const auto k = slot_[row];
+    switch (kind_[row]) {
+    case ShapeKind::LineSegment: {
+        const QPointF pts[2] = {segments_[k].p1, segments_[k].p2};
+        return LineShape::PathLength(pts, 2);
+    }
+    case ShapeKind::Polyline: {
+        const auto& r = polylineRanges_[k];
+        return LineShape::PathLength(vertexData(r), r.count);
+    }
+    default:
+        return perimeter(row);
+    }
+}
+
+double ShapeStore::area(int row) const {
+    const auto k = slot_[row];
+    switch (kind_[row]) {
+    case ShapeKind::Rectangle:
+        return std::abs(rects_[k].width() * rects_[k].height());
+    case ShapeKind::Circle:
+        return 3.14159265358979323846 * circles_[k].radius * circles_[k].radius;
+    case ShapeKind::Ellipse:
+        return 3.14159265358979323846 * ellipses_[k].rx * ellipses_[k].ry;
+    case ShapeKind::Triangle:
+        return Triangle::AreaOf(triangles_[k].a, triangles_[k].b, triangles_[k].c);
+    case ShapeKind::Polygon: {
+        const auto& r = polygonRanges_[k];
+        return Polygon::AreaOf(vertexData(r), r.count);
+    }
+    default:
+        return 0.0;
+    }
+}
+
+double ShapeStore::perimeter(int row) const {
+    const auto k = slot_[row];
+    switch (kind_[row]) {
+    case ShapeKind::Rectangle:
+        return 2.0 * (std::abs(rects_[k].width()) + std::abs(rects_[k].height()));
+    case ShapeKind::Circle:
+        return 2.0 * 3.14159265358979323846 * circles_[k].radius;
+    case ShapeKind::Ellipse:
+        return Ellipse::PerimeterOf(ellipses_[k].rx, ellipses_[k].ry);
+    case ShapeKind::Triangle:
+        return Triangle::PerimeterOf(triangles_[k].a, triangles_[k].b, triangles_[k].c);
+    case ShapeKind::Polygon: {
+        const auto& r = polygonRanges_[k];
+        return Polygon::PerimeterOf(vertexData(r), r.count);
+    }
+    default:
+        return 0.0;
+    }
+}
+
+QJsonObject ShapeStore::StyleJson(const Style& st) {
+    return QJsonObject{
+        {"color", QColor::fromRgba(st.color).name(QColor::HexArgb)},
+        {"pen", QJsonObject{{"width", st.penWidth}}}
+    };
+}
+
+QJsonObject ShapeStore::toJson(int row) const { return toJson(row, false, StyleJson(style(row))); }
+
+QJsonObject ShapeStore::toCompactJson(int row, int styleRef) const { return toJson(row, true, styleRef); }
+
+QJsonObject ShapeStore::CompactJson(const Shape& s, int styleRef) {
+    const ShapeKind kind = s.kind();
+    QJsonObject obj;
+    if (kind == ShapeKind::Polygon || kind == ShapeKind::Polyline) {
+        // 顶点直接写成扁平数组，不先生成版本 1 的点对象
+        const QVector<QPointF>& pts = kind == ShapeKind::Polygon ? static_cast<const Polygon&>(s).points()
+                                                                 : static_cast<const Polyline&>(s).points();
+        obj = s.Shape::ToJson();
+        obj["type"] = KindName(kind);
+        obj["geom"] = QJsonObject{{"points", pointsToJson(pts.constData(), pts.size(), true)}};
+    } else {
+        obj = s.ToJson();
+    }
+    obj["style"] = styleRef;
+    return obj;
+}
+
+QJsonObject ShapeStore::toJson(int row, bool flatPoints, const QJsonValue& style) const {
+    QJsonObject obj;
+    obj["name"] = name_[row];
+    obj["style"] = style;
+    obj["transform"] = QJsonObject{{"tx", tx_[row]}, {"ty", ty_[row]}, {"rot", rot_[row]}};
+    obj["type"] = typeName(row);
+
+    const auto k = slot_[row];
+    switch (kind_[row]) {
+    case ShapeKind::LineSegment: {
+        const auto& g = segments_[k];
+        obj["geom"] = QJsonObject{{"x1", g.p1.x()}, {"y1", g.p1.y()}, {"x2", g.p2.x()}, {"y2", g.p2.y()}};
+        break;
+    }
+    case ShapeKind::Rectangle: {
+        const auto r = rects_[k].normalized();
+        obj["geom"] = QJsonObject{{"x", r.x()}, {"y", r.y()}, {"w", r.width()}, {"h", r.height()}};
+        break;
+    }
+    case ShapeKind::Circle: {
+        const auto& g = circles_[k];
+        obj["geom"] = QJsonObject{{"cx", g.center.x()}, {"cy", g.center.y()}, {"r", g.radius}};
+        break;
+    }
+    case ShapeKind::Ellipse: {
+        const auto& g = ellipses_[k];
+        obj["geom"] = QJsonObject{{"cx", g.center.x()}, {"cy", g.center.y()}, {"rx", g.rx}, {"ry", g.ry}};
+        break;
+    }
+    case ShapeKind::Triangle: {
+        const auto& g = triangles_[k];
+        obj["geom"] = QJsonObject{{"x1", g.a.x()}, {"y1", g.a.y()}, {"x2", g.b.x()}, {"y2", g.b.y()}, {"x3", g.c.x()}, {"y3", g.c.y()}};
+        break;
+    }
+    case ShapeKind::Polygon: {
+        const auto& r = polygonRanges_[k];
+        obj["geom"] = QJsonObject{{"points", pointsToJson(vertexData(r), r.count, flatPoints)}};
+        break;
+    }
+    case ShapeKind::Polyline: {
+        const auto& r = polylineRanges_[k];
+        obj["geom"] = QJsonObject{{"points", pointsToJson(vertexData(r), r.count, flatPoints)}};
+        break;
+    }
+    default:
+        break;
+    }
+    return obj;
+}
+
+std::unique_ptr<Shape> ShapeStore::makeShape(int row) const {
+    const auto k = slot_[row];
+    std::unique_ptr<Shape> s;
+    switch (kind_[row]) {
+    case ShapeKind::LineSegment:
+        s = std::make_unique<LineSegment>(segments_[k].p1, segments_[k].p2);
+        break;
+    case ShapeKind::Rectangle:
+        s = std::make_unique<Rectangle>(rects_[k]);
+        break;
+    case ShapeKind::Circle:
+        s = std::make_unique<Circle>(circles_[k].center, circles_[k].radius);
+        break;
+    case ShapeKind::Ellipse:
+        s = std::make_unique<Ellipse>(ellipses_[k].center, ellipses_[k].rx, ellipses_[k].ry);
+        break;
+    case ShapeKind::Triangle:
+        s = std::make_unique<Triangle>(triangles_[k].a, triangles_[k].b, triangles_[k].c);
+        break;
+    case ShapeKind::Polygon:
+    case ShapeKind::Polyline: {
+        const auto& r = (kind_[row] == ShapeKind::Polygon) ? polygonRanges_[k] : polylineRanges_[k];
+        const QPointF* p = vertexData(r);
+        QVector<QPointF> pts(p, p + r.count);
+        if (kind_[row] == ShapeKind::Polygon) s = std::make_unique<Polygon>(pts);
+        else s = std::make_unique<Polyline>(pts);
+        break;
+    }
+    default:
+        return {};
+    }
+
+    const auto& st = style(row);
+    s->setName(name_[row]);
+    QPen pen(QColor::fromRgba(st.penColor));
+    pen.setWidthF(st.penWidth);
+    s->setStyleIndex(StyleTable::instance().intern(QColor::fromRgba(st.color), pen));
+    s->MoveTo(tx_[row], ty_[row]);
+    s->setRotationDegrees(rot_[row]);
+    return s;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <QString>
+#include <QColor>
+#include <QRectF>
+#include <QPointF>
+#include <QJsonObject>
+#include <QHash>
+
+#include "Shape.h"
+#include "ShapeKind.h"
+
+class QIODevice;
+
+// 列式（结构数组）图形存储：
+// - 通用列（类型/名称/样式/平移/旋转）按行（文档顺序）稠密排列；
+// - 几何按类型分表，圆心与半径等连续存放；
+// - 多边形/折线的全部顶点放在同一块连续缓冲中，按 [begin, begin+count) 区间引用。
+// 交互编辑仍使用 Shape 对象，ShapeStore 是其紧凑快照，供度量统计与保存等批量遍历使用。
+class ShapeStore {
+public:
+    struct Style {
+        QRgb color;      // Shape::color()
+        QRgb penColor;   // Shape::pen().color()
+        double penWidth; // Shape::pen().widthF()
+        bool operator==(const Style& o) const {
+            return color == o.color && penColor == o.penColor && penWidth == o.penWidth;
+        }
+    };
+
+    struct SegmentGeom  { QPointF p1, p2; };
+    struct CircleGeom   { QPointF center; double radius; };
+    struct EllipseGeom  { QPointF center; double rx, ry; };
+    struct TriangleGeom { QPointF a, b, c; };
+    struct VertexRange  { qsizetype begin; qsizetype count; };
+
+    ShapeStore() = default;
+    static ShapeStore FromShapes(const std::vector<Shape*>& shapes);
+
+    void reserve(qsizetype rows);
+    void clear();
+    // 追加一个图形，返回行号
+    int append(const Shape& s);
+
+    int size() const { return static_cast<int>(kind_.size()); }
+    bool empty() const { return kind_.empty(); }
+
+    // 通用列
+    ShapeKind kind(int row) const { return kind_[row]; }
+    QString typeName(int row) const;
+    // 类型标签对应的类型名（与 Shape::typeName 一致）
+    static QString KindName(ShapeKind kind);
+    const QString& name(int row) const { return name_[row]; }
+    const Style& style(int row) const { return styles_[styleIndex_[row]]; }
+    quint32 styleIndex(int row) const { return styleIndex_[row]; }
+    const std::vector<Style>& styles() const { return styles_; }
+    double tx(int row) const { return tx_[row]; }
+    double ty(int row) const { return ty_[row]; }
+    double rotation(int row) const { return rot_[row]; }
+
+    // 行在对应类型表中的下标
+    quint32 slot(int row) const { return slot_[row]; }
+
+    // 类型表
+    const std::vector<SegmentGeom>& segments() const { return segments_; }
+    const std::vector<QRectF>& rects() const { return rects_; }
+    const std::vector<CircleGeom>& circles() const { return circles_; }
+    const std::vector<EllipseGeom>& ellipses() const { return ellipses_; }
+    const std::vector<TriangleGeom>& triangles() const { return triangles_; }
+    const std::vector<VertexRange>& polygonRanges() const { return polygonRanges_; }
+    const std::vector<VertexRange>& polylineRanges() const { return polylineRanges_; }
+    // 多边形与折线共用的顶点缓冲
+    const std::vector<QPointF>& vertices() const { return vertices_; }
+    const QPointF* vertexData(const VertexRange& r) const { return vertices_.data() + r.begin; }
+
+    // 度量（结果与对应 Shape 子类一致）
+    QRectF boundingBox(int row) const;
+    double length(int row) const;
+    double area(int row) const;
+    double perimeter(int row) const;
+
+    // 与 Shape::ToJson 输出一致
+    QJsonObject toJson(int row) const;
+    // JSON 版本 2 的图形对象：points 为扁平的 [x0,y0,x1,y1,...]，style 为文档样式表下标 styleRef
+    QJsonObject toCompactJson(int row, int styleRef) const;
+    // 同一格式直接由 Shape 生成（与先 append 再 toCompactJson 结果相同），流式保存时不建快照
+    static QJsonObject CompactJson(const Shape& s, int styleRef);
+    // Shape 在快照中的样式
+    static Style StyleOf(const Shape& s) { return {s.color().rgba(), s.pen().color().rgba(), s.pen().widthF()}; }
+    // 样式在 JSON 中的写法（版本 1 内嵌于图形，版本 2 为样式表的一项）
+    static QJsonObject StyleJson(const Style& st);
+    // 还原为可编辑的 Shape 对象
+    std::unique_ptr<Shape> makeShape(int row) const;
+
+    // .fcadb 二进制快照（格式见 BinaryFormat.h）：各列原样写出；
+    // 读取时从内存（通常为文件映射）按段整块复制回各列并校验下标，不逐点解析
+    bool writeBinary(QIODevice& out, QString* error = nullptr) const;
+    static bool ReadBinary(const uchar* data, qint64 size, ShapeStore& out, QString* error = nullptr);
+
+private:
+    QJsonObject toJson(int row, bool flatPoints, const QJsonValue& style) const;
+    quint32 internStyle(const Style& s);
+    VertexRange appendVertices(const QVector<QPointF>& pts);
+
+    // 通用列
+    std::vector<ShapeKind> kind_;
+    std::vector<quint32> slot_;
+    std::vector<quint32> styleIndex_;
+    std::vector<QString> name_;
+    std::vector<double> tx_;
+    std::vector<double> ty_;
+    std::vector<double> rot_;
+
+    // 样式表（去重）
+    std::vector<Style> styles_;
+    QHash<Style, quint32> styleLookup_;
+
+    // 类型表
+    std::vector<SegmentGeom> segments_;
+    std::vector<QRectF> rects_;
+    std::vector<CircleGeom> circles_;
+    std::vector<EllipseGeom> ellipses_;
+    std::vector<TriangleGeom> triangles_;
+    std::vector<VertexRange> polygonRanges_;
+    std::vector<VertexRange> polylineRanges_;
+    std::vector<QPointF> vertices_;
+};
+
+size_t qHash(const ShapeStore::Style& s, size_t seed = 0) noexcept;
@@ -0,0 +1,126 @@
+#include "Simplify.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+// 点 p 到线段 ab 的距离平方
+double segmentDistance2(const QPointF& p, const QPointF& a, const QPointF& b) {
+    const double dx = b.x() - a.x(), dy = b.y() - a.y();
+    const double len2 = dx * dx + dy * dy;
+    double t = 0.0;
+    if (len2 > 0.0) t = std::clamp(((p.x() - a.x()) * dx + (p.y() - a.y()) * dy) / len2, 0.0, 1.0);
+    const double ex = p.x() - (a.x() + t * dx), ey = p.y() - (a.y() + t * dy);
+    return ex * ex + ey * ey;
+}
+
+// 对下标区间 (first, last) 内的顶点做 Douglas–Peucker 细分，写入重要度。
+// 下标按 n 取模（闭合环的第二段跨越末尾）；子段重要度不超过父段，保证按阈值截取与逐次化简一致。
+// 用显式栈代替递归，10^5 级顶点也不会栈溢出。
+void subdivide(const QPointF* pts, qsizetype n, qsizetype first, qsizetype last, std::vector<double>& imp) {
+    struct Span { qsizetype first, last; double cap; };
+    std::vector<Span> stack;
+    stack.push_back({first, last, kInf});
+    while (!stack.empty()) {
+        const Span s = stack.back();
+        stack.pop_back();
+        if (s.last - s.first < 2) continue;
+        const QPointF& a = pts[s.first % n];
+        const QPointF& b = pts[s.last % n];
+        double best = -1.0;
+        qsizetype bestIdx = s.first + 1;
+        for (qsizetype i = s.first + 1; i < s.last; ++i) {
+            const double d2 = segmentDistance2(pts[i % n], a, b);
+            if (d2 > best) { best = d2; bestIdx = i; }
+        }
+        const double d = std::min(std::sqrt(best), s.cap);
+        imp[bestIdx % n] = d;
+        stack.push_back({s.first, bestIdx, d});
+        stack.push_back({bestIdx, s.last, d});
+    }
+}
+
+} // namespace
+
+namespace Simplify {
+
+std::vector<double> Importance(const QPointF* pts, qsizetype n, bool closed) {
+    std::vector<double> imp(static_cast<size_t>(std::max<qsizetype>(n, 0)), 0.0);
+    if (n <= 0) return imp;
+    if (!closed || n < 3) {
+        imp.front() = kInf;
+        imp.back() = kInf;
+        subdivide(pts, n, 0, n - 1, imp);
+        return imp;
+    }
+    // 闭合环：以首点和离首点最远的点为锚，分成两条链分别细分
+    qsizetype far = 1;
+    double farD2 = -1.0;
+    for (qsizetype i = 1; i < n; ++i) {
+        const double dx = pts[i].x() - pts[0].x(), dy = pts[i].y() - pts[0].y();
+        const double d2 = dx * dx + dy * dy;
+        if (d2 > farD2) { farD2 = d2; far = i; }
+    }
+    imp[0] = kInf;
+    imp[far] = kInf;
+    subdivide(pts, n, 0, far, imp);
+    subdivide(pts, n, far, n, imp);
+    return imp;
+}
+
+QPolygonF DouglasPeucker(const QPointF* pts, qsizetype n, double tolerance, bool closed) {
+    const auto imp = Importance(pts, n, closed);
+    QPolygonF out;
+    for (qsizetype i = 0; i < n; ++i) {
+        if (imp[i] > tolerance) out.append(pts[i]);
+    }
+    return out;
+}
+
+void LodPyramid::build(const QPointF* pts, qsizetype n, bool closed) {
+    levels_.clear();
+    if (n < kMinVertices) return;
+    const auto imp = Importance(pts, n, closed);
+
+    double maxFinite = 0.0;
+    for (double v : imp) {
+        if (v != kInf) maxFinite = std::max(maxFinite, v);
+    }
+    if (maxFinite <= 0.0) return;
+
+    // 从最粗（仅保留锚点）开始容差逐级减半；只保留比上一保留层至少少一半顶点的层
+    qsizetype lastKept = n;
+    std::vector<std::pair<double, qsizetype>> candidates;
+    for (double t = maxFinite; t > maxFinite * 1e-9; t *= 0.5) {
+        const auto kept = static_cast<qsizetype>(std::count_if(imp.begin(), imp.end(), [t](double v) { return v > t; }));
+        candidates.push_back({t, kept});
+        if (kept * 2 > n) break;
+    }
+    // candidates 由粗到细；自细向粗筛选
+    for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
+        if (it->second * 2 > lastKept) continue;
+        Level lv;
+        lv.tolerance = it->first;
+        lv.points.reserve(it->second);
+        for (qsizetype i = 0; i < n; ++i) {
+            if (imp[i] > it->first) lv.points.append(pts[i]);
+        }
+        lastKept = it->second;
+        levels_.push_back(std::move(lv));
+    }
+}
+
+const QPolygonF* LodPyramid::levelFor(double tolerance) const {
+    const QPolygonF* best = nullptr;
+    for (const auto& lv : levels_) {
+        if (lv.tolerance > tolerance) break;
+        best = &lv.points;
+    }
+    return best;
+}
+
+} // namespace Simplify
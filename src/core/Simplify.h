@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <QPointF>
+#include <QPolygonF>
+
+// 折线/多边形化简（Douglas–Peucker），供显示层按缩放级别选择顶点子集。
+// 只用于绘制：度量、包围盒与控制点始终使用原始几何。
+namespace Simplify {
+
+// 每个顶点的 Douglas–Peucker 重要度：以容差 t 化简时，重要度 > t 的顶点恰好是保留下来的顶点。
+// 端点（闭合时为首点及离首点最远的点）为 +inf。一次计算即可得到任意容差下的结果。
+std::vector<double> Importance(const QPointF* pts, qsizetype n, bool closed);
+
+// 按容差化简（局部单位）；closed 时首尾不重复，按闭合环处理
+QPolygonF DouglasPeucker(const QPointF* pts, qsizetype n, double tolerance, bool closed);
+
+// 多分辨率顶点金字塔：容差按 2 倍递增，每层顶点数至多为上一层（更精细层）的一半。
+class LodPyramid {
+public:
+    // 顶点数少于该值的图形直接按原始几何绘制，不建金字塔
+    static constexpr qsizetype kMinVertices = 256;
+
+    struct Level {
+        double tolerance; // 该层相对原始几何的最大偏差（局部单位）
+        QPolygonF points;
+    };
+
+    void build(const QPointF* pts, qsizetype n, bool closed);
+    void clear() { levels_.clear(); }
+
+    // 偏差不超过 tolerance 的最粗一层；没有（需精确绘制）时返回 nullptr
+    const QPolygonF* levelFor(double tolerance) const;
+
+    // 由精细到粗排列
+    const std::vector<Level>& levels() const { return levels_; }
+
+private:
+    std::vector<Level> levels_;
+};
+
+} // namespace Simplify
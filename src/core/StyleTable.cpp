@@ -0,0 +1,116 @@
+#include "StyleTable.h"
+
+#include <QtGlobal>
+#include <algorithm>
+
+bool StyleTable::JsonKey::operator==(const JsonKey& o) const {
+    return base == o.base && hasColor == o.hasColor && hasWidth == o.hasWidth && color == o.color && width == o.width;
+}
+
+size_t qHash(const StyleTable::JsonKey& k, size_t seed) noexcept {
+    return qHashMulti(seed, k.base, k.color, k.width, k.hasColor, k.hasWidth);
+}
+
+static size_t valueHash(const QColor& color, const QPen& pen) {
+    return qHashMulti(0, color.rgba(), pen.color().rgba(), pen.widthF(), static_cast<int>(pen.style()));
+}
+
+StyleTable& StyleTable::instance() {
+    // 函数内静态：图形可能在其他静态对象初始化期间构造
+    static StyleTable table;
+    return table;
+}
+
+StyleTable::StyleTable() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    internLocked(QColor(Qt::black), QPen(Qt::black));
+}
+
+quint32 StyleTable::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+}
+
+quint32 StyleTable::intern(const QColor& color, const QPen& pen) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return internLocked(color, pen);
+}
+
+quint32 StyleTable::internLocked(const QColor& color, const QPen& pen) {
+    const size_t h = valueHash(color, pen);
+    for (auto it = byValue_.constFind(h); it != byValue_.constEnd() && it.key() == h; ++it) {
+        const Style& s = at(it.value());
+        if (s.color == color && s.pen == pen) return it.value();
+    }
+    const quint32 index = size_;
+    const quint64 v = quint64(index) + (quint64(1) << kChunkBits);
+    const int top = 63 - qCountLeadingZeroBits(v);
+    auto& chunk = chunks_[top - kChunkBits];
+    if (!chunk) chunk = std::make_unique<Style[]>(size_t(1) << top);
+    chunk[v - (quint64(1) << top)] = Style{color, pen};
+    ++size_;
+    byValue_.insert(h, index);
+    return index;
+}
+
+void StyleTable::reset(std::vector<quint32>& keep) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 先复制保留的样式：重新驻留会覆盖原位置
+    QHash<quint32, quint32> remap;
+    std::vector<Style> kept;
+    for (quint32 index : keep) {
+        if (index == kDefault || remap.contains(index)) continue;
+        remap.insert(index, static_cast<quint32>(kept.size()));
+        kept.push_back(at(index));
+    }
+    const Style def = at(kDefault);
+    size_ = 0;
+    byValue_.clear();
+    byJson_.clear();
+    internLocked(def.color, def.pen);
+    std::vector<quint32> fresh;
+    fresh.reserve(kept.size());
+    for (const auto& s : kept) fresh.push_back(internLocked(s.color, s.pen));
+    for (quint32& index : keep) {
+        if (index != kDefault) index = fresh[remap.value(index)];
+    }
+    // 释放不再用到的块（第 0 块保留）
+    const int used = 63 - qCountLeadingZeroBits(quint64(size_ - 1) + (quint64(1) << kChunkBits)) - kChunkBits;
+    for (int k = std::max(used + 1, 1); k < kChunks; ++k) chunks_[k].reset();
+}
+
+QColor StyleTable::parseColorLocked(const QString& name) {
+    auto it = colors_.constFind(name);
+    if (it != colors_.constEnd()) return it.value();
+    QColor c;
+    c.setNamedColor(name);
+    colors_.insert(name, c);
+    return c;
+}
+
+quint32 StyleTable::internJson(const QJsonObject& style, quint32 base) {
+    JsonKey key {base, {}, 0.0, false, false};
+    if (style.contains(QLatin1String("color"))) {
+        key.hasColor = true;
+        key.color = style[QLatin1String("color")].toString();
+    }
+    const QJsonObject pen = style[QLatin1String("pen")].toObject();
+    if (pen.contains(QLatin1String("width"))) {
+        key.hasWidth = true;
+        key.width = pen[QLatin1String("width")].toDouble();
+    }
+    if (!key.hasColor && !key.hasWidth) return base;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = byJson_.constFind(key);
+    if (it != byJson_.constEnd()) return it.value();
+    Style s = at(base);
+    if (key.hasColor) {
+        s.color = parseColorLocked(key.color);
+        s.pen.setColor(s.color);
+    }
+    if (key.hasWidth) s.pen.setWidthF(key.width);
+    const quint32 index = internLocked(s.color, s.pen);
+    byJson_.insert(key, index);
+    return index;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QColor>
+#include <QHash>
+#include <QJsonObject>
+#include <QPen>
+#include <QString>
+#include <QtAlgorithms>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// 共享样式表：图形只保存样式下标，颜色与画笔存放在驻留（intern）的不可变记录中。
+// 相同的 (颜色, 画笔) 只有一条记录，大量图形共用少数样式时也只有少数几个 QPen；
+// 修改样式为写时复制——按新值查找或新建记录后改指下标，原记录不变，其他图形不受影响。
+// 文档打开期间记录只增不删，关闭文档时整体重置（reset）。按块分配，块长逐块加倍、数量不设上限，
+// 已有记录地址不变：读取不加锁，驻留加锁，可在任意线程调用（并行解析）
+class StyleTable {
+public:
+    struct Style {
+        QColor color; // Shape::color()
+        QPen pen;     // Shape::pen()
+    };
+
+    // 默认样式（黑色填充、黑色画笔）固定为 0 号
+    static constexpr quint32 kDefault = 0;
+
+    static StyleTable& instance();
+
+    // 第 k 块长 2^(kChunkBits+k)：index + 2^kChunkBits 的最高位给出块号，其余位为块内下标
+    const Style& at(quint32 index) const {
+        const quint64 v = quint64(index) + (quint64(1) << kChunkBits);
+        const int top = 63 - qCountLeadingZeroBits(v);
+        return chunks_[top - kChunkBits][v - (quint64(1) << top)];
+    }
+
+    quint32 intern(const QColor& color, const QPen& pen);
+    // 在 base 上应用 JSON 的 style 对象（{"color":..,"pen":{"width":..}}，颜色同时用于画笔）后驻留。
+    // 结果按 (base, 颜色字符串, 线宽) 缓存：加载时每个图形一次哈希查找，不复制 QPen；
+    // 每个不同的颜色字符串只解析一次
+    quint32 internJson(const QJsonObject& style, quint32 base = kDefault);
+
+    quint32 size() const;
+
+    // 丢弃默认样式以外的全部记录，只保留 keep 中引用的样式，keep 中的下标就地改写为新下标。
+    // 用于关闭文档：调用方保证其余图形都已销毁，且没有其他线程在使用样式表
+    void reset(std::vector<quint32>& keep);
+
+private:
+    StyleTable();
+
+    quint32 internLocked(const QColor& color, const QPen& pen);
+    QColor parseColorLocked(const QString& name);
+
+    struct JsonKey {
+        quint32 base;
+        QString color;
+        double width;
+        bool hasColor;
+        bool hasWidth;
+        bool operator==(const JsonKey& o) const;
+    };
+    friend size_t qHash(const JsonKey& k, size_t seed) noexcept;
+
+    static constexpr int kChunkBits = 10;
+    // 覆盖全部 32 位下标所需的块数
+    static constexpr int kChunks = 33 - kChunkBits;
+
+    mutable std::mutex mutex_;
+    std::array<std::unique_ptr<Style[]>, kChunks> chunks_;
+    quint32 size_ {0};
+    QMultiHash<size_t, quint32> byValue_;
+    QHash<JsonKey, quint32> byJson_;
+    QHash<QString, QColor> colors_;
+};
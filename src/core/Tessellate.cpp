@@ -0,0 +1,54 @@
+#include "Tessellate.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Tessellate {
+
+int EllipseSegments(double rx, double ry, double tolerance) {
+    // 椭圆是半径 R = max(rx, ry) 的圆经逐轴收缩得到，弦高误差不超过该圆的误差：
+    // R (1 - cos(π / n)) <= tolerance
+    const double r = std::max(std::abs(rx), std::abs(ry));
+    if (!(r > 0.0) || !(tolerance > 0.0)) return kMinSegments;
+    if (tolerance >= r) return kMinSegments;
+    const double halfStep = std::acos(1.0 - tolerance / r);
+    const double n = std::ceil(3.14159265358979323846 / halfStep);
+    if (!(n < kMaxSegments)) return kMaxSegments;
+    const int segments = (static_cast<int>(n) + 3) & ~3;
+    return std::clamp(segments, kMinSegments, kMaxSegments);
+}
+
+QPolygonF EllipsePolygon(const QPointF& center, double rx, double ry, int segments) {
+    segments = std::max(segments, 3);
+    QPolygonF poly;
+    poly.reserve(segments);
+    const double step = 2.0 * 3.14159265358979323846 / segments;
+    for (int i = 0; i < segments; ++i) {
+        const double t = step * i;
+        poly.append(QPointF(center.x() + rx * std::cos(t), center.y() + ry * std::sin(t)));
+    }
+    return poly;
+}
+
+int CurveCache::ScaleBucket(double pixelScale) {
+    if (!(pixelScale > 0.0)) return 0;
+    return static_cast<int>(std::ceil(2.0 * std::log2(pixelScale)));
+}
+
+double CurveCache::BucketScale(int bucket) {
+    return std::exp2(0.5 * bucket);
+}
+
+const QPolygonF& CurveCache::get(const QPointF& center, double rx, double ry, quint32 revision,
+                                 double pixelScale, double pixelTolerance) {
+    const int bucket = ScaleBucket(pixelScale);
+    if (valid_ && revision_ == revision && bucket_ == bucket) return poly_;
+    const int n = EllipseSegments(rx, ry, pixelTolerance / BucketScale(bucket));
+    poly_ = EllipsePolygon(center, rx, ry, n);
+    revision_ = revision;
+    bucket_ = bucket;
+    valid_ = true;
+    return poly_;
+}
+
+} // namespace Tessellate
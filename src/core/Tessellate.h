@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QPointF>
+#include <QPolygonF>
+
+// 圆/椭圆的折线细分，供绘制与导出复用：段数由弦高误差上界确定，
+// 屏幕上与解析曲线的偏差不超过给定像素数，且不随曲线实际大小无谓增长。
+namespace Tessellate {
+
+constexpr int kMinSegments = 8;
+constexpr int kMaxSegments = 4096;
+
+// 半轴为 rx/ry 的椭圆按参数角等分、弦高误差不超过 tolerance（局部单位）所需的段数；
+// 结果为 4 的倍数（保证落在四个轴端点上），限定在 [kMinSegments, kMaxSegments]
+int EllipseSegments(double rx, double ry, double tolerance);
+
+// 参数角等分的闭合折线（首尾不重复），自 +x 轴端点起
+QPolygonF EllipsePolygon(const QPointF& center, double rx, double ry, int segments);
+
+// 单个图形的细分缓存：以像素比例所在的档位（每档 √2 倍）与几何版本号为键。
+// 同一档内缩放不重建；档位按上界取误差，任何缩放下偏差都不超过 pixelTolerance。
+// 几何 setter（setCenter/setRadius/setRx/setRy）会递增版本号，使缓存失效。
+class CurveCache {
+public:
+    // pixelScale：设备像素/局部单位（如 levelOfDetailFromTransform）
+    const QPolygonF& get(const QPointF& center, double rx, double ry, quint32 revision,
+                         double pixelScale, double pixelTolerance);
+    void clear() { valid_ = false; poly_.clear(); }
+
+    static int ScaleBucket(double pixelScale);
+    // 档位对应的像素比例（不小于落在该档的任何比例）
+    static double BucketScale(int bucket);
+
+private:
+    QPolygonF poly_;
+    quint32 revision_ {0};
+    int bucket_ {0};
+    bool valid_ {false};
+};
+
+} // namespace Tessellate
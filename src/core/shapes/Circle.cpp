@@ -1,6 +1,10 @@
 #include "Circle.h"
 
-Circle::Circle(const QPointF& c, double r) : center_(c), radius_(r) { ++kCount; }
+#include "../ShapeRegistry.h"
+
+static const ShapeRegistry::Registrar kRegistrar(MakeShapeCodec<Circle>(QStringLiteral("Circle")));
+
+Circle::Circle(const QPointF& c, double r) : AreaShape(kKind), center_(c), radius_(r) { ++kCount; }
 
 Circle::~Circle() { --kCount; }
 
@@ -19,3 +23,8 @@ std::unique_ptr<Circle> Circle::FromJson(const QJsonObject& obj) {
     s->FromJsonCommon(obj);
     return s;
 }
+
+void Circle::ApplyGeometryJson(const QJsonObject& g) {
+    setCenter(QPointF(g["cx"].toDouble(), g["cy"].toDouble()));
+    setRadius(g["r"].toDouble());
+}
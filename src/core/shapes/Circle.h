@@ -8,29 +8,31 @@
 
 class Circle : public AreaShape {
 public:
+    static constexpr ShapeKind kKind = ShapeKind::Circle;
+
     Circle(const QPointF& c = {}, double r = 0.0);
     ~Circle() override;
 
     QString typeName() const override { return QStringLiteral("Circle"); }
 
-    QRectF BoundingBox() const override {
-        QRectF local(center_.x() - radius_, center_.y() - radius_, radius_ * 2.0, radius_ * 2.0);
-        return transform().mapRect(local.normalized());
-    }
-
-    double Area() const override { return 3.14159265358979323846 * radius_ * radius_; }
-    double Perimeter() const override { return 2.0 * 3.14159265358979323846 * radius_; }
-
     const QPointF& center() const { return center_; }
     double radius() const { return radius_; }
-    void setCenter(const QPointF& c) { center_ = c; }
-    void setRadius(double r) { radius_ = std::max(0.0, r); }
+    void setCenter(const QPointF& c) { center_ = c; invalidateGeometry(); }
+    void setRadius(double r) { radius_ = std::max(0.0, r); invalidateGeometry(); }
 
     QJsonObject ToJson() const override;
     static std::unique_ptr<Circle> FromJson(const QJsonObject& obj);
+    void ApplyGeometryJson(const QJsonObject& geom);
 
     static int Count() { return kCount.load(); }
 
+protected:
+    QRectF ComputeLocalBounds() const override {
+        return QRectF(center_.x() - radius_, center_.y() - radius_, radius_ * 2.0, radius_ * 2.0);
+    }
+    double ComputeArea() const override { return 3.14159265358979323846 * radius_ * radius_; }
+    double ComputePerimeter() const override { return 2.0 * 3.14159265358979323846 * radius_; }
+
 private:
     QPointF center_{};
     double radius_{};
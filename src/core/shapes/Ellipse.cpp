@@ -2,15 +2,19 @@
 
 #include <cmath>
 
+#include "../ShapeRegistry.h"
+
+static const ShapeRegistry::Registrar kRegistrar(MakeShapeCodec<Ellipse>(QStringLiteral("Ellipse")));
+
 Ellipse::Ellipse(const QPointF& c, double rx, double ry)
-    : center_(c), rx_(rx), ry_(ry) { ++kCount; }
+    : AreaShape(kKind), center_(c), rx_(rx), ry_(ry) { ++kCount; }
 
 Ellipse::~Ellipse() { --kCount; }
 
-double Ellipse::Perimeter() const {
+double Ellipse::PerimeterOf(double rx, double ry) {
     // Ramanujan approximation: pi [3(a+b) - sqrt{(3a+b)(a+3b)}]
-    const double a = std::max(rx_, ry_);
-    const double b = std::min(rx_, ry_);
+    const double a = std::max(rx, ry);
+    const double b = std::min(rx, ry);
     if (a <= 0.0 || b <= 0.0) return 0.0;
     const double h = (3*(a+b) - std::sqrt((3*a + b)*(a + 3*b)));
     return 3.14159265358979323846 * h;
@@ -33,3 +37,8 @@ std::unique_ptr<Ellipse> Ellipse::FromJson(const QJsonObject& obj) {
     return s;
 }
 
+void Ellipse::ApplyGeometryJson(const QJsonObject& g) {
+    setCenter(QPointF(g["cx"].toDouble(), g["cy"].toDouble()));
+    setRx(g["rx"].toDouble());
+    setRy(g["ry"].toDouble());
+}
@@ -7,31 +7,34 @@
 
 class Ellipse : public AreaShape {
 public:
+    static constexpr ShapeKind kKind = ShapeKind::Ellipse;
+
     Ellipse(const QPointF& c = {}, double rx = 0.0, double ry = 0.0);
     ~Ellipse() override;
 
     QString typeName() const override { return QStringLiteral("Ellipse"); }
 
-    QRectF BoundingBox() const override {
-        QRectF local(center_.x()-rx_, center_.y()-ry_, rx_*2, ry_*2);
-        return transform().mapRect(local.normalized());
-    }
-
-    double Area() const override { return 3.14159265358979323846 * rx_ * ry_; }
-    double Perimeter() const override; // Ramanujan approximation
+    // Ramanujan approximation
+    static double PerimeterOf(double rx, double ry);
 
     const QPointF& center() const { return center_; }
-    void setCenter(const QPointF& c) { center_ = c; }
+    void setCenter(const QPointF& c) { center_ = c; invalidateGeometry(); }
     double rx() const { return rx_; }
     double ry() const { return ry_; }
-    void setRx(double v) { rx_ = std::max(0.0, v); }
-    void setRy(double v) { ry_ = std::max(0.0, v); }
+    void setRx(double v) { rx_ = std::max(0.0, v); invalidateGeometry(); }
+    void setRy(double v) { ry_ = std::max(0.0, v); invalidateGeometry(); }
 
     QJsonObject ToJson() const override;
     static std::unique_ptr<Ellipse> FromJson(const QJsonObject& obj);
+    void ApplyGeometryJson(const QJsonObject& geom);
 
     static int Count() { return kCount.load(); }
 
+protected:
+    QRectF ComputeLocalBounds() const override { return QRectF(center_.x()-rx_, center_.y()-ry_, rx_*2, ry_*2); }
+    double ComputeArea() const override { return 3.14159265358979323846 * rx_ * ry_; }
+    double ComputePerimeter() const override { return PerimeterOf(rx_, ry_); }
+
 private:
     QPointF center_{};
     double rx_{};
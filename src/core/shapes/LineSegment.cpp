@@ -1,19 +1,16 @@
 #include "LineSegment.h"
 
-#include <QTransform>
+#include "../ShapeRegistry.h"
+
+static const ShapeRegistry::Registrar kRegistrar(MakeShapeCodec<LineSegment>(QStringLiteral("LineSegment")));
 
 LineSegment::LineSegment(const QPointF& p1, const QPointF& p2)
-    : p1_(p1), p2_(p2) {
+    : LineShape(kKind), p1_(p1), p2_(p2) {
     ++kCount;
 }
 
 LineSegment::~LineSegment() { --kCount; }
 
-QRectF LineSegment::BoundingBox() const {
-    QRectF localRect = QRectF(p1_, p2_).normalized();
-    return transform().mapRect(localRect);
-}
-
 QJsonObject LineSegment::ToJson() const {
     QJsonObject obj = Shape::ToJson();
     obj["type"] = QStringLiteral("LineSegment");
@@ -29,3 +26,8 @@ std::unique_ptr<LineSegment> LineSegment::FromJson(const QJsonObject& obj) {
     s->FromJsonCommon(obj);
     return s;
 }
+
+void LineSegment::ApplyGeometryJson(const QJsonObject& g) {
+    setP1(QPointF(g["x1"].toDouble(), g["y1"].toDouble()));
+    setP2(QPointF(g["x2"].toDouble(), g["y2"].toDouble()));
+}
@@ -1,12 +1,15 @@
 #pragma once
 
 #include <atomic>
+#include <cmath>
 #include <QPointF>
 #include <QRectF>
 #include "../Shape.h"
 
 class LineSegment : public LineShape {
 public:
+    static constexpr ShapeKind kKind = ShapeKind::LineSegment;
+
     LineSegment(const QPointF& p1 = {}, const QPointF& p2 = {});
     ~LineSegment() override;
 
@@ -15,19 +18,22 @@ public:
     int VertexCount() const override { return 2; }
     QVector<QPointF> Vertices() const override { return {p1_, p2_}; }
 
-    QRectF BoundingBox() const override;
-
     QJsonObject ToJson() const override;
     static std::unique_ptr<LineSegment> FromJson(const QJsonObject& obj);
+    void ApplyGeometryJson(const QJsonObject& geom);
 
     // 端点访问
     const QPointF& p1() const { return p1_; }
     const QPointF& p2() const { return p2_; }
-    void setP1(const QPointF& p) { p1_ = p; }
-    void setP2(const QPointF& p) { p2_ = p; }
+    void setP1(const QPointF& p) { p1_ = p; invalidateGeometry(); }
+    void setP2(const QPointF& p) { p2_ = p; invalidateGeometry(); }
 
     static int Count() { return kCount.load(); }
 
+protected:
+    QRectF ComputeLocalBounds() const override { return QRectF(p1_, p2_); }
+    double ComputeLength() const override { return std::hypot(p2_.x() - p1_.x(), p2_.y() - p1_.y()); }
+
 private:
     QPointF p1_;
     QPointF p2_;
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <algorithm>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QPointF>
+#include <QVector>
+
+// Polygon / Polyline 共用的顶点列表编解码
+namespace PointList {
+
+inline QVector<QPointF> FromJson(const QJsonArray& arr) {
+    QVector<QPointF> pts; pts.reserve(arr.size());
+    for (const auto& v : arr) {
+        auto o = v.toObject();
+        pts.append(QPointF(o["x"].toDouble(), o["y"].toDouble()));
+    }
+    return pts;
+}
+
+inline QJsonArray ToJson(const QVector<QPointF>& pts) {
+    QJsonArray arr;
+    for (const auto& p : pts) arr.append(QJsonObject{{"x", p.x()}, {"y", p.y()}});
+    return arr;
+}
+
+// 点数不变时只原位写回变化的区间，单点编辑的撤销/重做不重建数组、缓存可增量修正
+template <class T>
+void Apply(T& s, const QVector<QPointF>& pts) {
+    const auto& cur = s.points();
+    if (pts.size() != cur.size()) { s.setPoints(pts); return; }
+    // 精确比较（QPointF::operator== 为模糊比较）
+    auto same = [](const QPointF& a, const QPointF& b) { return a.x() == b.x() && a.y() == b.y(); };
+    qsizetype lo = 0, hi = pts.size();
+    while (lo < hi && same(pts[lo], cur[lo])) ++lo;
+    while (hi > lo && same(pts[hi - 1], cur[hi - 1])) --hi;
+    if (lo < hi) s.setPointRange(static_cast<int>(lo), pts.constData() + lo, hi - lo);
+}
+
+} // namespace PointList
@@ -1,51 +1,94 @@
 #include "Polygon.h"
-#include <QJsonArray>
 
+#include <algorithm>
 #include <cmath>
 
-static double poly_perimeter(const QVector<QPointF>& pts) {
-    if (pts.size() < 2) return 0.0;
-    double sum = 0.0;
-    for (int i = 0; i < pts.size(); ++i) {
-        const auto& a = pts[i];
-        const auto& b = pts[(i + 1) % pts.size()];
-        sum += std::hypot(b.x() - a.x(), b.y() - a.y());
-    }
-    return sum;
+#include "../GeometryKernels.h"
+#include "../ShapeRegistry.h"
+#include "PointList.h"
+
+static const ShapeRegistry::Registrar kRegistrar(MakeShapeCodec<Polygon>(QStringLiteral("Polygon")));
+
+// QPointF 在内存中即为连续的 (x, y) 双精度对，可直接按交错坐标数组交给内核
+static_assert(sizeof(QPointF) == 2 * sizeof(double), "QPointF must be two packed doubles");
+
+static double poly_perimeter(const QPointF* pts, qsizetype n) {
+    if (n < 2) return 0.0;
+    return Kernels::PolygonPerimeter(reinterpret_cast<const double*>(pts), static_cast<std::size_t>(n));
 }
 
-static double poly_area(const QVector<QPointF>& pts) {
-    if (pts.size() < 3) return 0.0;
-    double sum = 0.0;
-    for (int i = 0; i < pts.size(); ++i) {
-        const auto& a = pts[i];
-        const auto& b = pts[(i + 1) % pts.size()];
-        sum += a.x() * b.y() - b.x() * a.y();
-    }
-    return std::abs(sum) * 0.5;
+static double poly_signed_area(const QPointF* pts, qsizetype n) {
+    if (n < 3) return 0.0;
+    return Kernels::SignedPolygonArea(reinterpret_cast<const double*>(pts), static_cast<std::size_t>(n));
 }
 
-double Polygon::Area() const { return poly_area(points_); }
-double Polygon::Perimeter() const { return poly_perimeter(points_); }
+double Polygon::AreaOf(const QPointF* pts, qsizetype n) { return std::abs(poly_signed_area(pts, n)); }
+double Polygon::PerimeterOf(const QPointF* pts, qsizetype n) { return poly_perimeter(pts, n); }
+
+double Polygon::ComputeArea() const {
+    signedArea_ = poly_signed_area(points_.constData(), points_.size());
+    return std::abs(signedArea_);
+}
+double Polygon::ComputePerimeter() const { return poly_perimeter(points_.constData(), points_.size()); }
+
+void Polygon::setPointRange(int first, const QPointF* pts, qsizetype count) {
+    const qsizetype n = points_.size();
+    if (first < 0 || count <= 0 || first + count > n) return;
+    // 替换范围占比较大时直接整体失效，惰性重算比逐边修正更省
+    if (count * 4 >= n) {
+        std::copy(pts, pts + count, points_.begin() + first);
+        invalidateGeometry();
+        return;
+    }
+
+    // 受影响的边为 [first-1, first+count-1]（首尾相连）；叉积以编辑前的首点为原点，
+    // 闭合多边形的叉积和与原点无关，相减时大坐标不会放大误差
+    const QPointF o = points_.at(0);
+    auto edgeSums = [&](double& len, double& cross) {
+        len = 0.0; cross = 0.0;
+        for (qsizetype e = first - 1; e < first + count; ++e) {
+            const qsizetype i = (e + n) % n, j = (i + 1) % n;
+            const QPointF a = points_.at(i) - o, b = points_.at(j) - o;
+            const QPointF d = b - a;
+            len += std::sqrt(d.x() * d.x() + d.y() * d.y());
+            cross += a.x() * b.y() - b.x() * a.y();
+        }
+    };
+    double oldLen, oldCross, newLen, newCross;
+    edgeSums(oldLen, oldCross);
+
+    auto& c = cache();
+    bool boundsOk = c.localValid;
+    QPointF* dst = points_.data() + first;
+    for (qsizetype k = 0; k < count; ++k) {
+        if (boundsOk) boundsOk = MovePointInBounds(c.local, dst[k], pts[k]);
+        dst[k] = pts[k];
+    }
+    edgeSums(newLen, newCross);
+
+    beginIncrementalEdit();
+    c.localValid = boundsOk;
+    if (c.perimeterValid) c.perimeter += newLen - oldLen;
+    if (c.areaValid) {
+        signedArea_ += 0.5 * (newCross - oldCross);
+        c.area = std::abs(signedArea_);
+    }
+}
 
 QJsonObject Polygon::ToJson() const {
     QJsonObject obj = Shape::ToJson();
     obj["type"] = QStringLiteral("Polygon");
-    QJsonArray arr;
-    for (const auto& p : points_) arr.append(QJsonObject{{"x", p.x()}, {"y", p.y()}});
-    obj["geom"] = QJsonObject{{"points", arr}};
+    obj["geom"] = QJsonObject{{"points", PointList::ToJson(points_)}};
     return obj;
 }
 
 std::unique_ptr<Polygon> Polygon::FromJson(const QJsonObject& obj) {
     auto g = obj["geom"].toObject();
-    auto arr = g["points"].toArray();
-    QVector<QPointF> pts; pts.reserve(arr.size());
-    for (const auto& v : arr) {
-        auto o = v.toObject();
-        pts.append(QPointF(o["x"].toDouble(), o["y"].toDouble()));
-    }
-    auto s = std::make_unique<Polygon>(pts);
+    auto s = std::make_unique<Polygon>(PointList::FromJson(g["points"].toArray()));
     s->FromJsonCommon(obj);
     return s;
 }
+
+void Polygon::ApplyGeometryJson(const QJsonObject& g) {
+    PointList::Apply(*this, PointList::FromJson(g["points"].toArray()));
+}
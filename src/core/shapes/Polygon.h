@@ -8,28 +8,39 @@
 
 class Polygon : public AreaShape {
 public:
-    Polygon() { ++kCount; }
-    explicit Polygon(const QVector<QPointF>& pts) : points_(pts) { ++kCount; }
+    static constexpr ShapeKind kKind = ShapeKind::Polygon;
+
+    Polygon() : AreaShape(kKind) { ++kCount; }
+    explicit Polygon(const QVector<QPointF>& pts) : AreaShape(kKind), points_(pts) { ++kCount; }
     ~Polygon() override { --kCount; }
 
     QString typeName() const override { return QStringLiteral("Polygon"); }
 
-    QRectF BoundingBox() const override { return transform().mapRect(QPolygonF(points_).boundingRect()); }
-
-    double Area() const override;
-    double Perimeter() const override;
+    // 基于顶点区间的度量（供列式存储等批量场景复用）
+    static double AreaOf(const QPointF* pts, qsizetype n);
+    static double PerimeterOf(const QPointF* pts, qsizetype n);
 
     const QVector<QPointF>& points() const { return points_; }
-    void setPoints(const QVector<QPointF>& pts) { points_ = pts; }
-    void setPoint(int i, const QPointF& p) { if (i>=0 && i<points_.size()) points_[i]=p; }
+    void setPoints(const QVector<QPointF>& pts) { points_ = pts; invalidateGeometry(); }
+    // 原位修改单个顶点 / 一段连续顶点：不重建数组，度量与包围盒缓存按受影响的边增量修正
+    // （pts 不可指向本图形自身的顶点缓冲）
+    void setPoint(int i, const QPointF& p) { setPointRange(i, &p, 1); }
+    void setPointRange(int first, const QPointF* pts, qsizetype count);
 
     QJsonObject ToJson() const override;
     static std::unique_ptr<Polygon> FromJson(const QJsonObject& obj);
+    void ApplyGeometryJson(const QJsonObject& geom);
 
     static int Count() { return kCount.load(); }
 
+protected:
+    QRectF ComputeLocalBounds() const override { return QPolygonF(points_).boundingRect(); }
+    double ComputeArea() const override;
+    double ComputePerimeter() const override;
+
 private:
     QVector<QPointF> points_{};
+    mutable double signedArea_ {0.0}; // 与缓存的面积同时有效，供增量修正
     inline static std::atomic<int> kCount{0};
 };
 
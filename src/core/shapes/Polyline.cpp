@@ -1,24 +1,64 @@
 #include "Polyline.h"
-#include <QJsonArray>
+
+#include <algorithm>
+#include <cmath>
+
+#include "../ShapeRegistry.h"
+#include "PointList.h"
+
+static const ShapeRegistry::Registrar kRegistrar(MakeShapeCodec<Polyline>(QStringLiteral("Polyline")));
+
+void Polyline::setPointRange(int first, const QPointF* pts, qsizetype count) {
+    const qsizetype n = points_.size();
+    if (first < 0 || count <= 0 || first + count > n) return;
+    // 替换范围占比较大时直接整体失效，惰性重算比逐边修正更省
+    if (count * 4 >= n) {
+        std::copy(pts, pts + count, points_.begin() + first);
+        invalidateGeometry();
+        return;
+    }
+
+    // 受影响的边为 [first-1, first+count-1] 与 [0, n-2] 的交集
+    const qsizetype e0 = std::max<qsizetype>(first - 1, 0);
+    const qsizetype e1 = std::min<qsizetype>(first + count - 1, n - 2);
+    auto edgeLength = [&] {
+        double len = 0.0;
+        for (qsizetype i = e0; i <= e1; ++i) {
+            const QPointF d = points_.at(i + 1) - points_.at(i);
+            len += std::sqrt(d.x() * d.x() + d.y() * d.y());
+        }
+        return len;
+    };
+    const double oldLen = edgeLength();
+
+    auto& c = cache();
+    bool boundsOk = c.localValid;
+    QPointF* dst = points_.data() + first;
+    for (qsizetype k = 0; k < count; ++k) {
+        if (boundsOk) boundsOk = MovePointInBounds(c.local, dst[k], pts[k]);
+        dst[k] = pts[k];
+    }
+    const double newLen = edgeLength();
+
+    beginIncrementalEdit();
+    c.localValid = boundsOk;
+    if (c.lengthValid) c.length += newLen - oldLen;
+}
 
 QJsonObject Polyline::ToJson() const {
     QJsonObject obj = Shape::ToJson();
     obj["type"] = QStringLiteral("Polyline");
-    QJsonArray arr;
-    for (const auto& p : points_) arr.append(QJsonObject{{"x", p.x()}, {"y", p.y()}});
-    obj["geom"] = QJsonObject{{"points", arr}};
+    obj["geom"] = QJsonObject{{"points", PointList::ToJson(points_)}};
     return obj;
 }
 
 std::unique_ptr<Polyline> Polyline::FromJson(const QJsonObject& obj) {
     auto g = obj["geom"].toObject();
-    auto arr = g["points"].toArray();
-    QVector<QPointF> pts; pts.reserve(arr.size());
-    for (const auto& v : arr) {
-        auto o = v.toObject();
-        pts.append(QPointF(o["x"].toDouble(), o["y"].toDouble()));
-    }
-    auto s = std::make_unique<Polyline>(pts);
+    auto s = std::make_unique<Polyline>(PointList::FromJson(g["points"].toArray()));
     s->FromJsonCommon(obj);
     return s;
 }
+
+void Polyline::ApplyGeometryJson(const QJsonObject& g) {
+    PointList::Apply(*this, PointList::FromJson(g["points"].toArray()));
+}
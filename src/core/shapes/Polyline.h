@@ -8,8 +8,10 @@
 
 class Polyline : public LineShape {
 public:
-    Polyline() { ++kCount; }
-    explicit Polyline(const QVector<QPointF>& pts) : points_(pts) { ++kCount; }
+    static constexpr ShapeKind kKind = ShapeKind::Polyline;
+
+    Polyline() : LineShape(kKind) { ++kCount; }
+    explicit Polyline(const QVector<QPointF>& pts) : LineShape(kKind), points_(pts) { ++kCount; }
     ~Polyline() override { --kCount; }
 
     QString typeName() const override { return QStringLiteral("Polyline"); }
@@ -17,17 +19,23 @@ public:
     int VertexCount() const override { return points_.size(); }
     QVector<QPointF> Vertices() const override { return points_; }
 
-    QRectF BoundingBox() const override { return transform().mapRect(QPolygonF(points_).boundingRect()); }
-
     const QVector<QPointF>& points() const { return points_; }
-    void setPoints(const QVector<QPointF>& pts) { points_ = pts; }
-    void setPoint(int i, const QPointF& p) { if (i>=0 && i<points_.size()) points_[i]=p; }
+    void setPoints(const QVector<QPointF>& pts) { points_ = pts; invalidateGeometry(); }
+    // 原位修改单个顶点 / 一段连续顶点：不重建数组，度量与包围盒缓存按受影响的边增量修正
+    // （pts 不可指向本图形自身的顶点缓冲）
+    void setPoint(int i, const QPointF& p) { setPointRange(i, &p, 1); }
+    void setPointRange(int first, const QPointF* pts, qsizetype count);
 
     QJsonObject ToJson() const override;
     static std::unique_ptr<Polyline> FromJson(const QJsonObject& obj);
+    void ApplyGeometryJson(const QJsonObject& geom);
 
     static int Count() { return kCount.load(); }
 
+protected:
+    QRectF ComputeLocalBounds() const override { return QPolygonF(points_).boundingRect(); }
+    double ComputeLength() const override { return PathLength(points_.constData(), points_.size()); }
+
 private:
     QVector<QPointF> points_{};
     inline static std::atomic<int> kCount{0};
@@ -1,6 +1,10 @@
 #include "Rectangle.h"
 
-Rectangle::Rectangle(const QRectF& r) : rect_(r) { ++kCount; }
+#include "../ShapeRegistry.h"
+
+static const ShapeRegistry::Registrar kRegistrar(MakeShapeCodec<Rectangle>(QStringLiteral("Rectangle")));
+
+Rectangle::Rectangle(const QRectF& r) : AreaShape(kKind), rect_(r) { ++kCount; }
 
 Rectangle::~Rectangle() { --kCount; }
 
@@ -19,3 +23,7 @@ std::unique_ptr<Rectangle> Rectangle::FromJson(const QJsonObject& obj) {
     s->FromJsonCommon(obj);
     return s;
 }
+
+void Rectangle::ApplyGeometryJson(const QJsonObject& g) {
+    setRect(QRectF(g["x"].toDouble(), g["y"].toDouble(), g["w"].toDouble(), g["h"].toDouble()));
+}
@@ -6,24 +6,27 @@
 
 class Rectangle : public AreaShape {
 public:
+    static constexpr ShapeKind kKind = ShapeKind::Rectangle;
+
     explicit Rectangle(const QRectF& r = QRectF());
     ~Rectangle() override;
 
     QString typeName() const override { return QStringLiteral("Rectangle"); }
 
-    QRectF BoundingBox() const override { return transform().mapRect(rect_.normalized()); }
-
-    double Area() const override { return std::abs(rect_.width() * rect_.height()); }
-    double Perimeter() const override { return 2.0 * (std::abs(rect_.width()) + std::abs(rect_.height())); }
-
     const QRectF& rect() const { return rect_; }
-    void setRect(const QRectF& r) { rect_ = r; }
+    void setRect(const QRectF& r) { rect_ = r; invalidateGeometry(); }
 
     QJsonObject ToJson() const override;
     static std::unique_ptr<Rectangle> FromJson(const QJsonObject& obj);
+    void ApplyGeometryJson(const QJsonObject& geom);
 
     static int Count() { return kCount.load(); }
 
+protected:
+    QRectF ComputeLocalBounds() const override { return rect_.normalized(); }
+    double ComputeArea() const override { return std::abs(rect_.width() * rect_.height()); }
+    double ComputePerimeter() const override { return 2.0 * (std::abs(rect_.width()) + std::abs(rect_.height())); }
+
 private:
     QRectF rect_;
     inline static std::atomic<int> kCount{0};
@@ -2,26 +2,33 @@
 
 #include <cmath>
 
+#include "../ShapeRegistry.h"
+
+static const ShapeRegistry::Registrar kRegistrar(MakeShapeCodec<Triangle>(QStringLiteral("Triangle")));
+
 Triangle::Triangle(const QPointF& a, const QPointF& b, const QPointF& c)
-    : a_(a), b_(b), c_(c) { ++kCount; }
+    : AreaShape(kKind), a_(a), b_(b), c_(c) { ++kCount; }
 
 Triangle::~Triangle() { --kCount; }
 
-QRectF Triangle::BoundingBox() const {
+QRectF Triangle::ComputeLocalBounds() const {
     QPolygonF poly; poly << a_ << b_ << c_;
-    return transform().mapRect(poly.boundingRect());
+    return poly.boundingRect();
 }
 
-double Triangle::Area() const {
+double Triangle::AreaOf(const QPointF& a, const QPointF& b, const QPointF& c) {
     // Shoelace for triangle
-    return std::abs(a_.x()*b_.y() + b_.x()*c_.y() + c_.x()*a_.y() - a_.y()*b_.x() - b_.y()*c_.x() - c_.y()*a_.x()) * 0.5;
+    return std::abs(a.x()*b.y() + b.x()*c.y() + c.x()*a.y() - a.y()*b.x() - b.y()*c.x() - c.y()*a.x()) * 0.5;
 }
 
-double Triangle::Perimeter() const {
+double Triangle::PerimeterOf(const QPointF& a, const QPointF& b, const QPointF& c) {
     auto d = [](const QPointF& u, const QPointF& v){ return std::hypot(u.x()-v.x(), u.y()-v.y()); };
-    return d(a_, b_) + d(b_, c_) + d(c_, a_);
+    return d(a, b) + d(b, c) + d(c, a);
 }
 
+double Triangle::ComputeArea() const { return AreaOf(a_, b_, c_); }
+double Triangle::ComputePerimeter() const { return PerimeterOf(a_, b_, c_); }
+
 QJsonObject Triangle::ToJson() const {
     QJsonObject obj = Shape::ToJson();
     obj["type"] = QStringLiteral("Triangle");
@@ -39,3 +46,8 @@ std::unique_ptr<Triangle> Triangle::FromJson(const QJsonObject& obj) {
     return s;
 }
 
+void Triangle::ApplyGeometryJson(const QJsonObject& g) {
+    setP1(QPointF(g["x1"].toDouble(), g["y1"].toDouble()));
+    setP2(QPointF(g["x2"].toDouble(), g["y2"].toDouble()));
+    setP3(QPointF(g["x3"].toDouble(), g["y3"].toDouble()));
+}
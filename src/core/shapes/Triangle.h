@@ -7,27 +7,34 @@
 
 class Triangle : public AreaShape {
 public:
+    static constexpr ShapeKind kKind = ShapeKind::Triangle;
+
     Triangle(const QPointF& a = {}, const QPointF& b = {}, const QPointF& c = {});
     ~Triangle() override;
 
     QString typeName() const override { return QStringLiteral("Triangle"); }
 
-    QRectF BoundingBox() const override;
-    double Area() const override;
-    double Perimeter() const override;
+    static double AreaOf(const QPointF& a, const QPointF& b, const QPointF& c);
+    static double PerimeterOf(const QPointF& a, const QPointF& b, const QPointF& c);
 
     const QPointF& p1() const { return a_; }
     const QPointF& p2() const { return b_; }
     const QPointF& p3() const { return c_; }
-    void setP1(const QPointF& p) { a_ = p; }
-    void setP2(const QPointF& p) { b_ = p; }
-    void setP3(const QPointF& p) { c_ = p; }
+    void setP1(const QPointF& p) { a_ = p; invalidateGeometry(); }
+    void setP2(const QPointF& p) { b_ = p; invalidateGeometry(); }
+    void setP3(const QPointF& p) { c_ = p; invalidateGeometry(); }
 
     QJsonObject ToJson() const override;
     static std::unique_ptr<Triangle> FromJson(const QJsonObject& obj);
+    void ApplyGeometryJson(const QJsonObject& geom);
 
     static int Count() { return kCount.load(); }
 
+protected:
+    QRectF ComputeLocalBounds() const override;
+    double ComputeArea() const override;
+    double ComputePerimeter() const override;
+
 private:
     QPointF a_, b_, c_;
     inline static std::atomic<int> kCount{0};
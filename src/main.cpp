@@ -1,4 +1,5 @@
 #include <QApplication>
+#include <QTimer>
 #include "MainWindow.h"
 
 #if defined(FAKECAD_SINGLE_EXE) && defined(QT_STATIC) && defined(Q_OS_WIN)
@@ -11,5 +12,7 @@ int main(int argc, char* argv[]) {
     MainWindow w;
     w.resize(1024, 768);
     w.show();
+    // 窗口显示后再检查崩溃恢复（可能弹出询问）
+    QTimer::singleShot(0, &w, &MainWindow::startSession);
     return app.exec();
 }
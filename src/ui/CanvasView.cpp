@@ -3,9 +3,11 @@
 #include <QWheelEvent>
 #include <QMouseEvent>
 #include <QKeyEvent>
+#include <QPainterPath>
 #include <algorithm>
 
 #include "ControlPointItem.h"
+#include "DrawingScene.h"
 
 bool CanvasView::viewportEvent(QEvent* event) {
     if (event->type() == QEvent::MouseButtonPress || event->type() == QEvent::MouseButtonRelease || event->type() == QEvent::MouseMove) {
@@ -31,6 +33,8 @@ CanvasView::CanvasView(QWidget* parent)
     setRenderHint(QPainter::Antialiasing, true);
     setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
     setViewportUpdateMode(QGraphicsView::BoundingRectViewportUpdate);
+    // 网格背景缓存为视口大小的像素图：平移时只补画新露出的条带，缩放或网格设置改变时整体重画
+    setCacheMode(QGraphicsView::CacheBackground);
 }
 
 CanvasView::CanvasView(QGraphicsScene* scene, QWidget* parent)
@@ -38,6 +42,8 @@ CanvasView::CanvasView(QGraphicsScene* scene, QWidget* parent)
     setRenderHint(QPainter::Antialiasing, true);
     setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
     setViewportUpdateMode(QGraphicsView::BoundingRectViewportUpdate);
+    // 网格背景缓存为视口大小的像素图：平移时只补画新露出的条带，缩放或网格设置改变时整体重画
+    setCacheMode(QGraphicsView::CacheBackground);
 }
 
 void CanvasView::wheelEvent(QWheelEvent* event) {
@@ -72,7 +78,16 @@ void CanvasView::mouseReleaseEvent(QMouseEvent* event) {
     if (spacePanning_ && event->button() == Qt::LeftButton) {
         setCursor(Qt::OpenHandCursor);
     }
+    // 拉框只选中场景中的项；停放在静态层中的图形在松开时按同一区域补选
+    QPainterPath band;
+    if (dragMode() == QGraphicsView::RubberBandDrag && event->button() == Qt::LeftButton && !rubberBandRect().isNull()) {
+        band.addPolygon(mapToScene(rubberBandRect()));
+        band.closeSubpath();
+    }
     QGraphicsView::mouseReleaseEvent(event);
+    if (!band.isEmpty()) {
+        if (auto* ds = dynamic_cast<DrawingScene*>(scene())) ds->selectStaticInArea(band);
+    }
 }
 
 void CanvasView::mouseMoveEvent(QMouseEvent* event) {
@@ -116,10 +131,20 @@ void CanvasView::zoomBy(qreal factor) {
     next = std::clamp(next, minScale_, maxScale_);
     const qreal apply = next / cur;
     scale(apply, apply);
+    resetCachedContent();
+    updatePickTolerance();
 }
 
 void CanvasView::resetZoom() {
     resetTransform();
+    resetCachedContent();
+    updatePickTolerance();
+}
+
+void CanvasView::updatePickTolerance() {
+    if (auto* ds = qobject_cast<DrawingScene*>(scene())) {
+        ds->setPickTolerance(DrawingScene::kPickTolerancePx / transform().m11());
+    }
 }
 
 void CanvasView::focusOutEvent(QFocusEvent* event) {
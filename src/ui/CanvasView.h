@@ -31,6 +31,8 @@ private:
 
     void beginPan();
     void endPan();
+    // 按当前缩放把像素拾取容差换算到场景单位
+    void updatePickTolerance();
 
 public:
     void zoomBy(qreal factor);
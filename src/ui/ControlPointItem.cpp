@@ -42,7 +42,8 @@ void ControlPointItem::mousePressEvent(QGraphicsSceneMouseEvent* event) {
         owner_->setHandlesFrozen(true);
     } else {
         if (owner_ && owner_->model()) {
-            oldJson_ = owner_->model()->ToJson();
+            if (vertexListEdit()) oldVertex_ = vertexPos();
+            else oldJson_ = owner_->model()->ToJson();
         }
     }
 }
@@ -88,22 +89,34 @@ void ControlPointItem::mouseReleaseEvent(QGraphicsSceneMouseEvent* event) {
         const QPointF local = owner_->mapFromScene(sp);
         owner_->handleMoved(static_cast<ShapeItem::HandleKind>(kind_), index_, local, event->scenePos(), true);
         if (owner_ && owner_->model()) {
-            QJsonObject neo = owner_->model()->ToJson();
             if (auto ds = dynamic_cast<class DrawingScene*>(owner_->scene())) {
                 if (auto st = ds->undoStack()) {
                     // 不能在控制点自身的鼠标事件回调里同步 push：
                     // QUndoStack::push() 会立即 redo()，命令里会 updateHandles() 并删除当前控制点，
                     // 造成“delete this”式的概率崩溃。延后一拍让事件先返回。
-                    const auto oldJ = oldJson_;
-                    QTimer::singleShot(0, st, [st, owner = owner_, oldJ, neo]() {
-                        st->push(new UndoCmd::EditShapeJsonCommand(owner, oldJ, neo));
-                    });
+                    if (vertexListEdit()) {
+                        // 多边形/折线顶点：只记录该顶点，避免整形 JSON 快照
+                        const QPointF oldP = oldVertex_;
+                        const QPointF neoP = vertexPos();
+                        const int idx = index_;
+                        QTimer::singleShot(0, st, [st, owner = owner_, idx, oldP, neoP]() {
+                            st->push(new UndoCmd::MoveVertexCommand(owner, idx, oldP, neoP));
+                        });
+                    } else {
+                        QJsonObject neo = owner_->model()->ToJson();
+                        const auto oldJ = oldJson_;
+                        QTimer::singleShot(0, st, [st, owner = owner_, oldJ, neo]() {
+                            st->push(new UndoCmd::EditShapeJsonCommand(owner, oldJ, neo));
+                        });
+                    }
                 }
             }
         }
         if (owner_) {
             // 拖拽过程中已实时同步控制点，松手不再重建（避免删除当前对象导致随机崩溃）
-            owner_->syncHandlesPositions(static_cast<ShapeItem::HandleKind>(kind_), index_);
+            // 顶点列表只动了当前顶点，其余控制点无需逐个同步
+            if (vertexListEdit()) owner_->syncRotationHandle();
+            else owner_->syncHandlesPositions(static_cast<ShapeItem::HandleKind>(kind_), index_);
             return;
         }
     } else {
@@ -130,6 +143,19 @@ void ControlPointItem::mouseReleaseEvent(QGraphicsSceneMouseEvent* event) {
     }
 }
 
+bool ControlPointItem::vertexListEdit() const {
+    if (kind_ != Kind::Vertex || !owner_ || !owner_->model()) return false;
+    const auto k = owner_->model()->kind();
+    return k == ShapeKind::Polygon || k == ShapeKind::Polyline;
+}
+
+QPointF ControlPointItem::vertexPos() const {
+    const Shape* s = owner_->model();
+    const auto& pts = (s->kind() == ShapeKind::Polygon) ? static_cast<const Polygon*>(s)->points()
+                                                         : static_cast<const Polyline*>(s)->points();
+    return (index_ >= 0 && index_ < pts.size()) ? pts[index_] : QPointF{};
+}
+
 void ControlPointItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
     if (kind_ != Kind::Rotation) {
         QGraphicsRectItem::paint(painter, option, widget);
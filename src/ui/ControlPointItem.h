@@ -32,4 +32,8 @@ private:
     qreal initialOwnerRotation_ { 0.0 };
 
     QJsonObject oldJson_{}; // for geometry edits
+    QPointF oldVertex_{};   // 多边形/折线顶点编辑：按下时的顶点（局部坐标）
+
+    bool vertexListEdit() const;
+    QPointF vertexPos() const;
 };
@@ -6,12 +6,16 @@
 #include <QGraphicsEllipseItem>
 #include <QGraphicsPathItem>
 #include <QGraphicsView>
+#include <QStyleOptionGraphicsItem>
+#include <QTimer>
 #include <QtMath>
 #include <QPainter>
 #include <QPainterPath>
+#include <algorithm>
 #include <cmath>
 
 #include "ShapeItem.h"
+#include "StaticLayer.h"
 #include "../core/shapes/LineSegment.h"    
 #include "../core/shapes/Rectangle.h"      
 #include "../core/shapes/Circle.h"
@@ -42,8 +46,162 @@ static QPainterPath pathFromClosedPoints(const QVector<QPointF>& pts) {
     return path;
 }
 
+// 事件所在视图的视口变换（用于按像素容差拾取）；无视图时为单位变换
+static QTransform viewTransformOf(QGraphicsSceneMouseEvent* event) {
+    if (auto* w = event->widget()) {
+        if (auto* view = qobject_cast<QGraphicsView*>(w->parentWidget())) return view->viewportTransform();
+    }
+    return {};
+}
+
 DrawingScene::DrawingScene(QObject* parent)
     : QGraphicsScene(parent) {
+    // 取消选中后把提升的图形放回静态层
+    connect(this, &QGraphicsScene::selectionChanged, this, &DrawingScene::scheduleStaticDemote);
+}
+
+DrawingScene::~DrawingScene() {
+    // 先于基类析构删除静态层：层析构时会回调本对象
+    delete layer_;
+}
+
+void DrawingScene::addShapes(std::vector<std::unique_ptr<Shape>>& shapes) {
+    std::vector<ShapeItem*> items;
+    items.reserve(shapes.size());
+    createItems(shapes, 0, shapes.size(), items);
+    shapes.clear();
+    insertCreated(items);
+}
+
+void DrawingScene::createItems(std::vector<std::unique_ptr<Shape>>& shapes, size_t begin, size_t end,
+                               std::vector<ShapeItem*>& items) {
+    for (size_t i = begin; i < end; ++i) {
+        if (!shapes[i]) continue;
+        auto* item = new ShapeItem(std::move(shapes[i]));
+        // 停放的项不经过 addItem，在此分配编号（按文档顺序）
+        registerShapeId(item);
+        items.push_back(item);
+    }
+}
+
+void DrawingScene::insertCreated(std::vector<ShapeItem*>& items) {
+    if (staticLayerEnabled_) {
+        if (!layer_) {
+            layer_ = new StaticLayer(this);
+            addItem(layer_);
+        }
+        layer_->park(items);
+        items.clear();
+        return;
+    }
+    const auto method = itemIndexMethod();
+    setItemIndexMethod(NoIndex);
+    for (auto* item : items) addItem(item);
+    items.clear();
+    setItemIndexMethod(method);
+}
+
+// 尚未加入的项随状态一起删除（取消，或场景先被销毁使排队的下一批不再执行）
+struct DrawingScene::PendingInsert {
+    std::vector<std::unique_ptr<Shape>> shapes;
+    std::vector<ShapeItem*> items;
+    size_t next {0};
+    std::function<bool(qint64, qint64)> progress;
+    std::function<void(bool)> done;
+    void discard() {
+        for (auto* it : items) delete it;
+        items.clear();
+        shapes.clear();
+    }
+    ~PendingInsert() { discard(); }
+};
+
+void DrawingScene::addShapesInBatches(std::vector<std::unique_ptr<Shape>> shapes, std::function<bool(qint64, qint64)> progress,
+                                      std::function<void(bool)> done) {
+    auto pending = std::make_shared<PendingInsert>();
+    pending->shapes = std::move(shapes);
+    pending->items.reserve(pending->shapes.size());
+    pending->progress = std::move(progress);
+    pending->done = std::move(done);
+    insertBatch(pending);
+}
+
+void DrawingScene::insertBatch(const std::shared_ptr<PendingInsert>& p) {
+    const size_t total = p->shapes.size();
+    const size_t end = std::min(total, p->next + kInsertBatch);
+    createItems(p->shapes, p->next, end, p->items);
+    p->next = end;
+    if (p->progress && !p->progress(qint64(end), qint64(total))) {
+        p->discard();
+        if (p->done) p->done(false);
+        return;
+    }
+    if (end < total) {
+        QTimer::singleShot(0, this, [this, p] { insertBatch(p); });
+        return;
+    }
+    p->shapes.clear();
+    insertCreated(p->items);
+    if (p->done) p->done(true);
+}
+
+std::vector<ShapeItem*> DrawingScene::shapeItems() const {
+    std::vector<ShapeItem*> out;
+    if (layer_) out = layer_->shapeItems();
+    for (auto* it : items(Qt::AscendingOrder)) {
+        auto* si = dynamic_cast<ShapeItem*>(it);
+        if (si && !si->staticLayer()) out.push_back(si);
+    }
+    return out;
+}
+
+void DrawingScene::insertShapeItem(ShapeItem* item, int index) {
+    const auto items = shapeItems();
+    ShapeItem* next = (index >= 0 && index < static_cast<int>(items.size())) ? items[index] : nullptr;
+    // 原先停放的图形回到静态层中留空的位置；其余的排在下一个场景图形之下
+    if (layer_ && (!next || next->staticLayer()) && layer_->adoptBefore(item, next)) return;
+    addItem(item);
+    if (next && !next->staticLayer()) item->stackBefore(next);
+}
+
+void DrawingScene::selectStaticInArea(const QPainterPath& area) {
+    if (!layer_) return;
+    // 停放的项仍保留位置与旋转，直接按精确形状判定，只提升命中的
+    for (auto* item : layer_->parkedIn(area.boundingRect())) {
+        if (!item->collidesWithPath(item->mapFromScene(area), Qt::IntersectsItemShape)) continue;
+        layer_->promote(item);
+        item->setSelected(true);
+    }
+}
+
+void DrawingScene::scheduleStaticDemote() {
+    if (!layer_ || demotePending_) return;
+    demotePending_ = true;
+    QTimer::singleShot(0, this, [this] {
+        demotePending_ = false;
+        if (layer_) layer_->demoteIdle();
+    });
+}
+
+void DrawingScene::promoteStaticAt(QGraphicsSceneMouseEvent* event) {
+    if (!layer_ || layer_->parkedCount() == 0) return;
+    const QTransform deviceTransform = viewTransformOf(event);
+    // 场景中的项（已提升的图形、控制点）在静态层之上
+    if (!pickItems(event->scenePos(), deviceTransform).isEmpty()) return;
+    const qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(deviceTransform);
+    if (auto* item = layer_->itemAt(event->scenePos(), kPickTolerancePx / (lod > 0 ? lod : 1.0))) layer_->promote(item);
+}
+
+void DrawingScene::registerShapeId(ShapeItem* item) {
+    if (item->shapeId() == 0) item->setShapeId(nextShapeId_++);
+    else nextShapeId_ = std::max(nextShapeId_, item->shapeId() + 1);
+}
+
+void DrawingScene::setLodSettings(const LodSettings& s) {
+    lod_ = s;
+    // 静态层的瓦片按旧设置绘制
+    if (layer_) layer_->clearTiles();
+    update();
 }
 
 void DrawingScene::setMode(Mode m) {
@@ -111,6 +269,36 @@ void DrawingScene::updateTrianglePreview(const QPointF& cur) {
     previewTriangle_->setPath(path);
 }
 
+QList<QGraphicsItem*> DrawingScene::pickItems(const QPointF& scenePos, const QTransform& deviceTransform) const {
+    const qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(deviceTransform);
+    const qreal tol = kPickTolerancePx / (lod > 0 ? lod : 1.0);
+    // 先按包围盒粗筛容差范围内的候选，再逐项精确判定
+    const QRectF probe(scenePos - QPointF(tol, tol), QSizeF(2 * tol, 2 * tol));
+    const QPointF devicePos = deviceTransform.map(scenePos);
+    QList<QGraphicsItem*> hits;
+    for (auto* it : items(probe, Qt::IntersectsItemBoundingRect, Qt::DescendingOrder, deviceTransform)) {
+        if (auto* si = dynamic_cast<ShapeItem*>(it)) {
+            // 图形项只有平移/旋转，局部单位与场景单位一致
+            if (si->hitTest(si->mapFromScene(scenePos), tol)) hits.push_back(it);
+            continue;
+        }
+        // 控制点忽略视图变换，经设备坐标映射回局部坐标
+        bool invertible = false;
+        const QTransform toLocal = it->deviceTransform(deviceTransform).inverted(&invertible);
+        if (invertible && it->contains(toLocal.map(devicePos))) hits.push_back(it);
+    }
+    return hits;
+}
+
+bool DrawingScene::pressHitsSelectedShape(QGraphicsSceneMouseEvent* event) const {
+    for (auto* it : pickItems(event->scenePos(), viewTransformOf(event))) {
+        for (auto* p = it; p; p = p->parentItem()) {
+            if (auto* si = dynamic_cast<ShapeItem*>(p); si && si->isSelected()) return true;
+        }
+    }
+    return false;
+}
+
 void DrawingScene::mousePressEvent(QGraphicsSceneMouseEvent* event) {       
     if (mode_ == Mode::Polygon) {
         if (event->button() == Qt::RightButton && drawing_) {
@@ -121,20 +309,9 @@ void DrawingScene::mousePressEvent(QGraphicsSceneMouseEvent* event) {
         if (event->button() == Qt::LeftButton) {
             // 如果点到已选中的现有图形，允许直接拖拽/编辑，不开始新绘制
             if (!drawing_) {
-                QTransform deviceTransform;
-                if (auto* w = event->widget()) {
-                    if (auto* view = qobject_cast<QGraphicsView*>(w->parentWidget())) {
-                        deviceTransform = view->viewportTransform();
-                    }
-                }
-                const auto hit = items(event->scenePos(), Qt::IntersectsItemShape, Qt::DescendingOrder, deviceTransform);
-                for (auto* it : hit) {
-                    for (auto* p = it; p; p = p->parentItem()) {
-                        if (auto* si = dynamic_cast<ShapeItem*>(p); si && si->isSelected()) {
-                            QGraphicsScene::mousePressEvent(event);
-                            return;
-                        }
-                    }
+                if (pressHitsSelectedShape(event)) {
+                    QGraphicsScene::mousePressEvent(event);
+                    return;
                 }
             }
 
@@ -165,20 +342,9 @@ void DrawingScene::mousePressEvent(QGraphicsSceneMouseEvent* event) {
         if (event->button() == Qt::LeftButton) {
             // 如果点到已选中的现有图形，允许直接拖拽/编辑，不开始新绘制
             if (!drawing_) {
-                QTransform deviceTransform;
-                if (auto* w = event->widget()) {
-                    if (auto* view = qobject_cast<QGraphicsView*>(w->parentWidget())) {
-                        deviceTransform = view->viewportTransform();
-                    }
-                }
-                const auto hit = items(event->scenePos(), Qt::IntersectsItemShape, Qt::DescendingOrder, deviceTransform);
-                for (auto* it : hit) {
-                    for (auto* p = it; p; p = p->parentItem()) {
-                        if (auto* si = dynamic_cast<ShapeItem*>(p); si && si->isSelected()) {
-                            QGraphicsScene::mousePressEvent(event);
-                            return;
-                        }
-                    }
+                if (pressHitsSelectedShape(event)) {
+                    QGraphicsScene::mousePressEvent(event);
+                    return;
                 }
             }
 
@@ -216,20 +382,9 @@ void DrawingScene::mousePressEvent(QGraphicsSceneMouseEvent* event) {
 
     if (event->button() == Qt::LeftButton && mode_ != Mode::None) {
         // 绘制模式下，如果点到现有图形（含其控制点/子项），应允许选择/编辑而不是开始新绘制
-        QTransform deviceTransform;
-        if (auto* w = event->widget()) {
-            if (auto* view = qobject_cast<QGraphicsView*>(w->parentWidget())) {
-                deviceTransform = view->viewportTransform();
-            }
-        }
-        const auto hit = items(event->scenePos(), Qt::IntersectsItemShape, Qt::DescendingOrder, deviceTransform);
-        for (auto* it : hit) {
-            for (auto* p = it; p; p = p->parentItem()) {
-                if (auto* si = dynamic_cast<ShapeItem*>(p); si && si->isSelected()) {
-                    QGraphicsScene::mousePressEvent(event);
-                    return;
-                }
-            }
+        if (pressHitsSelectedShape(event)) {
+            QGraphicsScene::mousePressEvent(event);
+            return;
         }
         drawing_ = true;
         startPos_ = snapPoint(event->scenePos());
@@ -255,6 +410,7 @@ void DrawingScene::mousePressEvent(QGraphicsSceneMouseEvent* event) {
         event->accept();
         return;
     }
+    if (event->button() == Qt::LeftButton) promoteStaticAt(event);
     QGraphicsScene::mousePressEvent(event);
 }
 
@@ -423,17 +579,43 @@ QPointF DrawingScene::snapPoint(const QPointF& p) const {
     return QPointF(x, y);
 }
 
+qreal DrawingScene::gridStep(qreal gridSize, qreal pixelScale) {
+    qreal step = gridSize <= 0 ? 20.0 : gridSize;
+    if (!(pixelScale > 0)) return step;
+    while (step * pixelScale < kGridMinSpacingPx) step *= kGridMajorEvery;
+    return step;
+}
+
+void DrawingScene::invalidateGrid() {
+    for (auto* v : views()) v->resetCachedContent();
+    update();
+}
+
 void DrawingScene::drawBackground(QPainter* painter, const QRectF& rect) {
     QGraphicsScene::drawBackground(painter, rect);
     if (!showGrid_) return;
-    const qreal s = gridSize_ <= 0 ? 20.0 : gridSize_;
+    // 步长随缩放合并，可见线数与缩放无关（约为视口像素 / kGridMinSpacingPx）；
+    // 按下标取坐标，避免累加误差，且主线位置与绘制区域无关
+    const qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    const qreal s = gridStep(gridSize_, lod);
+    std::vector<QLineF> minor;
+    std::vector<QLineF> major;
+    for (qint64 i = static_cast<qint64>(std::floor(rect.left() / s)); i * s < rect.right(); ++i) {
+        const qreal x = i * s;
+        (i % kGridMajorEvery == 0 ? major : minor).emplace_back(x, rect.top(), x, rect.bottom());
+    }
+    for (qint64 i = static_cast<qint64>(std::floor(rect.top() / s)); i * s < rect.bottom(); ++i) {
+        const qreal y = i * s;
+        (i % kGridMajorEvery == 0 ? major : minor).emplace_back(rect.left(), y, rect.right(), y);
+    }
     painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, false);
     QPen gridPen(QColor(230,230,230));
     gridPen.setCosmetic(true); // width not scaled by zoom
     painter->setPen(gridPen);
-    const qreal left = std::floor(rect.left() / s) * s;
-    const qreal top  = std::floor(rect.top() / s) * s;
-    for (qreal x = left; x < rect.right(); x += s) painter->drawLine(QPointF(x, rect.top()), QPointF(x, rect.bottom()));
-    for (qreal y = top;  y < rect.bottom(); y += s) painter->drawLine(QPointF(rect.left(), y), QPointF(rect.right(), y));
+    painter->drawLines(minor.data(), static_cast<int>(minor.size()));
+    gridPen.setColor(QColor(205,205,205));
+    painter->setPen(gridPen);
+    painter->drawLines(major.data(), static_cast<int>(major.size()));
     painter->restore();
 }
@@ -1,16 +1,24 @@
 #pragma once
 
 #include <QGraphicsScene>
+#include <QPainterPath>
 #include <QPointF>
 #include <QVector>
+#include <functional>
+#include <memory>
+#include <vector>
 
 class QUndoStack;
+class QGraphicsSceneMouseEvent;
 
 class QGraphicsLineItem;
 class QGraphicsRectItem;
 class QGraphicsEllipseItem;
 class QGraphicsPathItem;
 class ShapeItem;
+class Shape;
+class EditJournal;
+class StaticLayer;
 
 class DrawingScene : public QGraphicsScene {
     Q_OBJECT
@@ -18,6 +26,7 @@ class DrawingScene : public QGraphicsScene {
     enum class Mode { None, Line, Rect, Circle, Ellipse, Polygon, Triangle, RegularPolygon };
 
     explicit DrawingScene(QObject* parent = nullptr);
+    ~DrawingScene() override;
 
     void setMode(Mode m);
     Mode mode() const { return mode_; }
@@ -26,16 +35,67 @@ class DrawingScene : public QGraphicsScene {
     int regularPolygonSides() const { return regularPolygonSides_; }
 
     // Grid & snapping
-    void setShowGrid(bool v) { showGrid_ = v; update(); }
+    void setShowGrid(bool v) { showGrid_ = v; invalidateGrid(); }
     bool showGrid() const { return showGrid_; }
     void setSnapToGrid(bool v) { snapToGrid_ = v; }
     bool snapToGrid() const { return snapToGrid_; }
-    void setGridSize(qreal s) { gridSize_ = s; update(); }
+    void setGridSize(qreal s) { gridSize_ = s; invalidateGrid(); }
     qreal gridSize() const { return gridSize_; }
     QPointF snapPoint(const QPointF& p) const;
+    // 自适应网格：屏幕间距小于 kGridMinSpacingPx 的网格线按 kGridMajorEvery 倍合并，每 kGridMajorEvery 格一条主线
+    static constexpr qreal kGridMinSpacingPx = 6.0;
+    static constexpr int kGridMajorEvery = 5;
+    // 给定像素比例（设备像素/场景单位）下实际绘制的细线步长（场景单位）
+    static qreal gridStep(qreal gridSize, qreal pixelScale);
+
+    // 细节层次（设备像素）：屏幕上包围盒长边小于 pointSize 的图形只画一个像素点（skipTiny 时不画），
+    // 小于 aliasedSize 的关闭抗锯齿；阈值为 0 即不做对应简化。选中的图形始终完整绘制
+    struct LodSettings {
+        qreal pointSize {1.0};
+        qreal aliasedSize {3.0};
+        bool skipTiny {false};
+    };
+    void setLodSettings(const LodSettings& s);
+    const LodSettings& lodSettings() const { return lod_; }
     void setUndoStack(QUndoStack* s) { undo_ = s; }
     QUndoStack* undoStack() const { return undo_; }
     void notifyShapeMetricsChanged(ShapeItem* item) { emit shapeMetricsChanged(item); }
+    // 撤销命令执行时把效果追加到编辑日志（为空则不记录）
+    void setJournal(EditJournal* j) { journal_ = j; }
+    EditJournal* journal() const { return journal_; }
+
+    // 图形编号：加入场景的 ShapeItem 若无编号则取下一个，已有编号（回放日志）则推进计数器
+    void registerShapeId(ShapeItem* item);
+    // 关闭文档后重新从 1 编号，使打开的文档按文件顺序编为 1..N
+    void resetShapeIds() { nextShapeId_ = 1; }
+
+    // 批量加入（如打开文档）：为每个图形创建 ShapeItem 并停放到静态层（见 StaticLayer），
+    // 停用静态层时插入期间停用场景索引，结束后一次重建；shapes 中的对象被移走
+    void addShapes(std::vector<std::unique_ptr<Shape>>& shapes);
+    // 分批加入（打开大文档）：每轮事件循环为 kInsertBatch 个图形创建 ShapeItem，其间界面保持响应，
+    // 全部创建后与 addShapes 相同地一次加入。progress(已创建, 总数) 返回 false 时停止并删除已创建的项；
+    // 结束时调用 done(是否全部加入)。场景先被销毁时两者都不再调用
+    static constexpr int kInsertBatch = 20000;
+    void addShapesInBatches(std::vector<std::unique_ptr<Shape>> shapes, std::function<bool(qint64, qint64)> progress,
+                            std::function<void(bool)> done);
+    // 静态层开关（默认开启），只影响之后的 addShapes
+    void setStaticLayerEnabled(bool on) { staticLayerEnabled_ = on; }
+    StaticLayer* staticLayer() const { return layer_; }
+    // 文档中的全部图形项：静态层的条目（含已提升的）按文档顺序在前，其余场景中的图形自下而上在后
+    std::vector<ShapeItem*> shapeItems() const;
+    // 把新建的 item 插到 shapeItems() 的第 index 位（撤销删除时恢复原来的堆叠次序）；越界时放在最上层
+    void insertShapeItem(ShapeItem* item, int index);
+    // 框选结束时选中 area（场景坐标）内停放的图形：按 Qt::IntersectsItemShape 判定，只提升并选中命中的
+    void selectStaticInArea(const QPainterPath& area);
+    // 下一轮事件循环把已提升且不再选中的图形放回静态层（多次调用合并为一次）
+    void scheduleStaticDemote();
+
+    // 拾取容差（设备像素）；场景单位的容差随视图缩放由 CanvasView 更新，供 ShapeItem::contains 使用
+    static constexpr qreal kPickTolerancePx = 3.0;
+    void setPickTolerance(qreal sceneUnits) { pickTolerance_ = sceneUnits; }
+    qreal pickTolerance() const { return pickTolerance_; }
+    // scenePos 处命中的全部项（自上而下）：ShapeItem 按精确几何加像素容差判定，其余项（控制点等）按自身形状
+    QList<QGraphicsItem*> pickItems(const QPointF& scenePos, const QTransform& deviceTransform) const;
 
 signals:
     void shapeMetricsChanged(ShapeItem* item);
@@ -63,6 +123,20 @@ private:
     QGraphicsPathItem* previewRegularPolygon_ { nullptr };
 
     void clearPreview();
+    // 网格外观改变：丢弃各视图缓存的背景（CanvasView 使用 CacheBackground）
+    void invalidateGrid();
+    // 按下点是否落在已选中的图形（或其控制点）上：是则交给默认处理以拖拽/编辑，而不是开始新绘制
+    bool pressHitsSelectedShape(QGraphicsSceneMouseEvent* event) const;
+    // 按下点没有命中场景中的项时，提升该处停放在静态层中的图形，使默认处理能选中/拖拽它
+    void promoteStaticAt(QGraphicsSceneMouseEvent* event);
+    friend class StaticLayer;
+    void staticLayerDestroyed(StaticLayer* layer) { if (layer_ == layer) layer_ = nullptr; }
+    // 为 shapes[begin, end) 创建项并分配编号（空指针跳过），追加到 items
+    void createItems(std::vector<std::unique_ptr<Shape>>& shapes, size_t begin, size_t end, std::vector<ShapeItem*>& items);
+    // 把已创建的项停放到静态层，或停用场景索引后逐个加入场景；items 随后清空
+    void insertCreated(std::vector<ShapeItem*>& items);
+    struct PendingInsert;
+    void insertBatch(const std::shared_ptr<PendingInsert>& pending);
     void updatePolygonPreview(const QPointF& cur);
     void finishPolygon();
     void updateTrianglePreview(const QPointF& cur);
@@ -71,7 +145,14 @@ private:
     bool showGrid_ { true };
     bool snapToGrid_ { false };
     qreal gridSize_ { 20.0 };
+    qreal pickTolerance_ { kPickTolerancePx };
+    LodSettings lod_ {};
 
     class QUndoStack* undo_ { nullptr };
+    EditJournal* journal_ { nullptr };
+    quint64 nextShapeId_ { 1 };
+    StaticLayer* layer_ { nullptr };
+    bool staticLayerEnabled_ { true };
+    bool demotePending_ { false };
     int regularPolygonSides_ { 5 };
 };
@@ -10,10 +10,14 @@
 #include <QIcon>
 #include <QPixmap>
 #include <QLocale>
+#include <QUndoStack>
 #include <cmath>
 
+#include "DrawingScene.h"
 #include "ShapeItem.h"
 #include "../core/Shape.h"
+#include "../core/StyleTable.h"
+#include "../undo/Commands.h"
 
 PropertyPanel::PropertyPanel(QWidget* parent)
     : QWidget(parent) {
@@ -28,9 +32,12 @@ void PropertyPanel::rebuildUI() {
     penWidthSpin_ = new QDoubleSpinBox(this);
     penWidthSpin_->setRange(0.1, 50.0);
     penWidthSpin_->setSingleStep(0.5);
+    // 输入完成（回车/失去焦点）或按步进时才提交，不为键入途中的每个中间值驻留一条样式
+    penWidthSpin_->setKeyboardTracking(false);
     rotSpin_ = new QDoubleSpinBox(this);
     rotSpin_->setRange(-360.0, 360.0);
     rotSpin_->setSingleStep(1.0);
+    rotSpin_->setKeyboardTracking(false);
     lengthEdit_ = new QLineEdit(this);
     perimeterEdit_ = new QLineEdit(this);
     areaEdit_ = new QLineEdit(this);
@@ -47,7 +54,7 @@ void PropertyPanel::rebuildUI() {
     lay->addRow(tr("周长"), perimeterEdit_);
     lay->addRow(tr("面积"), areaEdit_);
 
-    connect(nameEdit_, &QLineEdit::textEdited, this, &PropertyPanel::onNameEdited);
+    connect(nameEdit_, &QLineEdit::editingFinished, this, &PropertyPanel::onNameEdited);
     connect(penWidthSpin_, qOverload<double>(&QDoubleSpinBox::valueChanged), this, &PropertyPanel::onPenWidthChanged);
     connect(colorBtn_, &QPushButton::clicked, this, &PropertyPanel::onColorClicked);
     connect(rotSpin_, qOverload<double>(&QDoubleSpinBox::valueChanged), this, &PropertyPanel::onRotationChanged);
@@ -118,35 +125,48 @@ void PropertyPanel::applyColorToButton(const QColor& c) {
     colorBtn_->setIcon(QIcon(pm));
 }
 
-void PropertyPanel::onNameEdited(const QString& text) {
+void PropertyPanel::push(QUndoCommand* cmd) {
+    auto* ds = target_ ? dynamic_cast<DrawingScene*>(target_->scene()) : nullptr;
+    if (ds && ds->undoStack()) {
+        ds->undoStack()->push(cmd);
+        return;
+    }
+    cmd->redo();
+    delete cmd;
+}
+
+void PropertyPanel::setStyle(quint32 style) {
+    const quint32 old = target_->model()->styleIndex();
+    if (style != old) push(new UndoCmd::SetStyleCommand(target_, old, style));
+}
+
+void PropertyPanel::onNameEdited() {
     if (updating_ || !target_) return;
-    target_->model()->setName(text);
-    target_->update();
+    const QString text = nameEdit_->text();
+    if (text == target_->model()->name()) return;
+    push(new UndoCmd::RenameShapeCommand(target_, target_->model()->name(), text));
 }
 
 void PropertyPanel::onPenWidthChanged(double w) {
-    if (updating_ || !target_) return;
-    auto p = target_->model()->pen();
-    p.setWidthF(w);
-    target_->model()->setPen(p);
-    target_->update();
+    if (updating_ || !target_ || w == target_->model()->pen().widthF()) return;
+    QPen pen = target_->model()->pen();
+    pen.setWidthF(w);
+    setStyle(StyleTable::instance().intern(target_->model()->color(), pen));
 }
 
 void PropertyPanel::onColorClicked() {
     if (!target_) return;
     const QColor cur = target_->model()->pen().color();
     QColor c = QColorDialog::getColor(cur, this, tr("选择颜色"));
-    if (!c.isValid()) return;
-    auto p = target_->model()->pen();
-    p.setColor(c);
-    target_->model()->setPen(p);
+    if (!c.isValid() || !target_) return;
+    // 与 JSON 的 color 一致：同时设置填充与画笔颜色（描边颜色不单独保存），保存与日志回放后保持一致
+    QPen pen = target_->model()->pen();
+    pen.setColor(c);
+    setStyle(StyleTable::instance().intern(c, pen));
     applyColorToButton(c);
-    target_->update();
 }
 
 void PropertyPanel::onRotationChanged(double deg) {
-    if (updating_ || !target_) return;
-    target_->model()->setRotationDegrees(deg);
-    target_->setRotation(deg);
-    target_->updateHandles();
+    if (updating_ || !target_ || deg == target_->rotation()) return;
+    push(new UndoCmd::TransformShapeCommand(target_, target_->pos(), target_->rotation(), target_->pos(), deg));
 }
@@ -6,6 +6,7 @@ class QLineEdit;
 class QPushButton;
 class QDoubleSpinBox;
 class QLabel;
+class QUndoCommand;
 class ShapeItem;
 
 class PropertyPanel : public QWidget {
@@ -20,7 +21,7 @@ public slots:
     void refresh();
 
  private slots:
-    void onNameEdited(const QString& text);
+    void onNameEdited();
     void onPenWidthChanged(double w);
     void onColorClicked();
     void onRotationChanged(double deg);
@@ -29,6 +30,10 @@ private:
     void rebuildUI();
     void refreshFromTarget();
     void applyColorToButton(const QColor& c);
+    // 修改经撤销命令执行（可撤销，并由命令记入编辑日志）；场景没有撤销栈时直接执行
+    void push(QUndoCommand* cmd);
+    // 目标改指 style（StyleTable 下标）；写时复制，共用原样式的其他图形不变
+    void setStyle(quint32 style);
 
     ShapeItem* target_ { nullptr };
     bool updating_ { false };
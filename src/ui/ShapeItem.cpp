@@ -1,12 +1,272 @@
 #include "ShapeItem.h"
 
 #include <QPainter>
+#include <QStyleOptionGraphicsItem>
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <type_traits>
 
 #include "ControlPointItem.h"
+#include "StaticLayer.h"
 #include <QGraphicsSceneMouseEvent>
 #include "../undo/Commands.h"
+#include "../core/HitTest.h"
+
+namespace {
+
+using HandleKind = ShapeItem::HandleKind;
+
+// 化简绘制允许的最大偏差（设备像素）
+constexpr double kLodPixelTolerance = 0.5;
+// 圆/椭圆细分为折线时允许的最大弦高（设备像素）
+constexpr double kCurvePixelTolerance = 0.25;
+
+// 圆/椭圆的解析参数，供绘制时取细分缓存
+struct EllipseGeom {
+    QPointF center;
+    double rx;
+    double ry;
+};
+
+// 控制点编辑结果：hasFixed 时需保持 fixed（局部坐标）在场景中的位置不变；
+// othersUnchanged 表示其余控制点的局部坐标未变，无需逐个同步
+struct HandleEdit {
+    bool hasFixed;
+    QPointF fixed;
+    bool othersUnchanged {false};
+};
+
+// 每种图形的一组操作；按 ShapeKind 下标查表，热路径只做一次间接调用
+struct KindOps {
+    // 圆/椭圆为空（见 ellipse）
+    void (*paint)(QPainter*, const Shape&);
+    void (*makeHandles)(const Shape&, QVector<std::pair<HandleKind, int>>&);
+    bool (*handlePos)(const Shape&, HandleKind, int, QPointF*);
+    bool (*accepts)(HandleKind);
+    HandleEdit (*moveHandle)(Shape&, HandleKind, int, const QPointF&);
+    // 顶点列表类图形（多边形/折线）：供绘制时按缩放级别取化简层；其余类型为空
+    const QVector<QPointF>* (*pointList)(const Shape&);
+    bool closedPath;
+    // 圆/椭圆：绘制时按缩放级别取缓存的折线细分；其余类型为空
+    EllipseGeom (*ellipse)(const Shape&);
+};
+
+template <class T> struct ItemTraits;
+
+template <> struct ItemTraits<LineSegment> {
+    static void paint(QPainter* p, const LineSegment& s) { p->drawLine(s.p1(), s.p2()); }
+    static void makeHandles(const LineSegment&, QVector<std::pair<HandleKind, int>>& out) {
+        out.push_back({HandleKind::Vertex, 0});
+        out.push_back({HandleKind::Vertex, 1});
+    }
+    static bool handlePos(const LineSegment& s, HandleKind kind, int index, QPointF* pos) {
+        if (kind != HandleKind::Vertex) return false;
+        *pos = index == 0 ? s.p1() : s.p2();
+        return true;
+    }
+    static bool accepts(HandleKind kind) { return kind == HandleKind::Vertex; }
+    static HandleEdit moveHandle(LineSegment& s, HandleKind, int index, const QPointF& p) {
+        const QPointF fixed = (index == 0) ? s.p2() : s.p1();
+        if (index == 0) s.setP1(p); else s.setP2(p);
+        return {true, fixed};
+    }
+};
+
+template <> struct ItemTraits<Triangle> {
+    static void paint(QPainter* p, const Triangle& s) {
+        QPolygonF poly; poly << s.p1() << s.p2() << s.p3();
+        p->drawPolygon(poly);
+    }
+    static void makeHandles(const Triangle&, QVector<std::pair<HandleKind, int>>& out) {
+        for (int i = 0; i < 3; ++i) out.push_back({HandleKind::Vertex, i});
+    }
+    static bool handlePos(const Triangle& s, HandleKind kind, int index, QPointF* pos) {
+        if (kind != HandleKind::Vertex) return false;
+        switch (index) {
+        case 0: *pos = s.p1(); return true;
+        case 1: *pos = s.p2(); return true;
+        case 2: *pos = s.p3(); return true;
+        default: return false;
+        }
+    }
+    static bool accepts(HandleKind kind) { return kind == HandleKind::Vertex; }
+    static HandleEdit moveHandle(Triangle& s, HandleKind, int index, const QPointF& p) {
+        const QPointF fixed = (index == 0) ? s.p2() : s.p1();
+        if (index == 0) s.setP1(p);
+        else if (index == 1) s.setP2(p);
+        else s.setP3(p);
+        return {true, fixed};
+    }
+};
+
+// Polygon / Polyline 共用的顶点列表操作
+template <class T> struct PointListTraits {
+    static const QVector<QPointF>* pointList(const Shape& s) { return &static_cast<const T&>(s).points(); }
+    static void makeHandles(const T& s, QVector<std::pair<HandleKind, int>>& out) {
+        for (int i = 0; i < s.points().size(); ++i) out.push_back({HandleKind::Vertex, i});
+    }
+    static bool handlePos(const T& s, HandleKind kind, int index, QPointF* pos) {
+        const auto& pts = s.points();
+        if (kind != HandleKind::Vertex || index < 0 || index >= pts.size()) return false;
+        *pos = pts[index];
+        return true;
+    }
+    static bool accepts(HandleKind kind) { return kind == HandleKind::Vertex; }
+    static HandleEdit moveHandle(T& s, HandleKind, int index, const QPointF& p) {
+        // 原位修改单个顶点，代价与顶点总数无关
+        const auto& pts = s.points();
+        const int fixedIndex = (pts.size() > 1) ? ((index == 0) ? 1 : 0) : -1;
+        const QPointF fixed = (fixedIndex >= 0) ? pts[fixedIndex] : QPointF{};
+        s.setPoint(index, p);
+        return {fixedIndex >= 0, fixed, true};
+    }
+};
+
+template <> struct ItemTraits<Polygon> : PointListTraits<Polygon> {
+    static constexpr bool kClosedPath = true;
+    static void paint(QPainter* p, const Polygon& s) { p->drawPolygon(QPolygonF(s.points())); }
+};
+
+template <> struct ItemTraits<Polyline> : PointListTraits<Polyline> {
+    static constexpr bool kClosedPath = false;
+    static void paint(QPainter* p, const Polyline& s) { p->drawPolyline(QPolygonF(s.points())); }
+};
+
+template <> struct ItemTraits<Rectangle> {
+    static void paint(QPainter* p, const Rectangle& s) { p->drawRect(s.rect()); }
+    static void makeHandles(const Rectangle&, QVector<std::pair<HandleKind, int>>& out) {
+        for (int i = 0; i < 4; ++i) out.push_back({HandleKind::Corner, i});
+    }
+    static bool handlePos(const Rectangle& s, HandleKind kind, int index, QPointF* pos) {
+        if (kind != HandleKind::Corner) return false;
+        const auto r = s.rect().normalized();
+        switch (index) {
+        case 0: *pos = r.topLeft(); return true;
+        case 1: *pos = r.topRight(); return true;
+        case 2: *pos = r.bottomRight(); return true;
+        case 3: *pos = r.bottomLeft(); return true;
+        default: return false;
+        }
+    }
+    static bool accepts(HandleKind kind) { return kind == HandleKind::Corner; }
+    static HandleEdit moveHandle(Rectangle& s, HandleKind, int index, const QPointF& p) {
+        const QRectF r = s.rect().normalized();
+        QPointF fixed;
+        switch (index) {
+        case 0: fixed = r.bottomRight(); break; // drag TL, fix BR
+        case 1: fixed = r.bottomLeft(); break;  // drag TR, fix BL
+        case 2: fixed = r.topLeft(); break;     // drag BR, fix TL
+        case 3: fixed = r.topRight(); break;    // drag BL, fix TR
+        default: fixed = r.bottomRight(); break;
+        }
+        s.setRect(QRectF(p, fixed).normalized());
+        return {true, fixed};
+    }
+};
+
+// Circle / Ellipse 的标记：提供 ellipse() 解析参数，绘制只走细分缓存（无 paint）
+struct EllipticTraits {};
+
+template <> struct ItemTraits<Circle> : EllipticTraits {
+    static EllipseGeom ellipse(const Shape& s) {
+        const auto& c = static_cast<const Circle&>(s);
+        return {c.center(), c.radius(), c.radius()};
+    }
+    static void makeHandles(const Circle&, QVector<std::pair<HandleKind, int>>& out) {
+        out.push_back({HandleKind::Center, 0});
+        out.push_back({HandleKind::Radius, 0});
+    }
+    static bool handlePos(const Circle& s, HandleKind kind, int, QPointF* pos) {
+        if (kind == HandleKind::Center) { *pos = s.center(); return true; }
+        if (kind == HandleKind::Radius) { *pos = s.center() + QPointF(s.radius(), 0); return true; }
+        return false;
+    }
+    static bool accepts(HandleKind kind) { return kind == HandleKind::Center || kind == HandleKind::Radius; }
+    static HandleEdit moveHandle(Circle& s, HandleKind kind, int, const QPointF& p) {
+        if (kind == HandleKind::Center) {
+            s.setCenter(p);
+        } else {
+            const auto c = s.center();
+            s.setRadius(std::hypot(p.x() - c.x(), p.y() - c.y()));
+        }
+        return {false, {}};
+    }
+};
+
+template <> struct ItemTraits<Ellipse> : EllipticTraits {
+    static EllipseGeom ellipse(const Shape& s) {
+        const auto& e = static_cast<const Ellipse&>(s);
+        return {e.center(), e.rx(), e.ry()};
+    }
+    static void makeHandles(const Ellipse&, QVector<std::pair<HandleKind, int>>& out) {
+        out.push_back({HandleKind::Center, 0});
+        out.push_back({HandleKind::Radius, 0});
+        out.push_back({HandleKind::Radius, 1});
+    }
+    static bool handlePos(const Ellipse& s, HandleKind kind, int index, QPointF* pos) {
+        if (kind == HandleKind::Center) { *pos = s.center(); return true; }
+        if (kind != HandleKind::Radius) return false;
+        if (index == 0) { *pos = s.center() + QPointF(s.rx(), 0); return true; }
+        if (index == 1) { *pos = s.center() + QPointF(0, s.ry()); return true; }
+        return false;
+    }
+    static bool accepts(HandleKind kind) { return kind == HandleKind::Center || kind == HandleKind::Radius; }
+    static HandleEdit moveHandle(Ellipse& s, HandleKind kind, int index, const QPointF& p) {
+        if (kind == HandleKind::Center) {
+            s.setCenter(p);
+        } else {
+            const auto c = s.center();
+            if (index == 0) s.setRx(std::abs(p.x() - c.x()));
+            else s.setRy(std::abs(p.y() - c.y()));
+        }
+        return {false, {}};
+    }
+};
+
+// 将具体类型的操作擦除为以 Shape 为参数的函数指针
+template <class T> struct Thunks {
+    static void paint(QPainter* p, const Shape& s) { ItemTraits<T>::paint(p, static_cast<const T&>(s)); }
+    static void makeHandles(const Shape& s, QVector<std::pair<HandleKind, int>>& out) {
+        ItemTraits<T>::makeHandles(static_cast<const T&>(s), out);
+    }
+    static bool handlePos(const Shape& s, HandleKind kind, int index, QPointF* pos) {
+        return ItemTraits<T>::handlePos(static_cast<const T&>(s), kind, index, pos);
+    }
+    static HandleEdit moveHandle(Shape& s, HandleKind kind, int index, const QPointF& p) {
+        return ItemTraits<T>::moveHandle(static_cast<T&>(s), kind, index, p);
+    }
+};
+
+template <class T> constexpr KindOps opsFor() {
+    KindOps ops {nullptr, &Thunks<T>::makeHandles,
+                 &Thunks<T>::handlePos, &ItemTraits<T>::accepts, &Thunks<T>::moveHandle,
+                 nullptr, false, nullptr};
+    if constexpr (std::is_base_of_v<PointListTraits<T>, ItemTraits<T>>) {
+        ops.pointList = &ItemTraits<T>::pointList;
+        ops.closedPath = ItemTraits<T>::kClosedPath;
+    }
+    if constexpr (std::is_base_of_v<EllipticTraits, ItemTraits<T>>) {
+        ops.ellipse = &ItemTraits<T>::ellipse;
+    } else {
+        ops.paint = &Thunks<T>::paint;
+    }
+    return ops;
+}
+
+// 编译期类型列表：各类型按自身 kKind 落到表中对应位置
+template <class... Ts> constexpr std::array<KindOps, kShapeKindCount> makeOpsTable() {
+    std::array<KindOps, kShapeKindCount> t{};
+    ((t[static_cast<int>(Ts::kKind)] = opsFor<Ts>()), ...);
+    return t;
+}
+
+constexpr auto kOps = makeOpsTable<LineSegment, Rectangle, Circle, Triangle, Polygon, Polyline, Ellipse>();
+static_assert(kOps.size() == 7, "every ShapeKind needs an entry");
+
+const KindOps& kindOps(ShapeKind kind) { return kOps[static_cast<int>(kind)]; }
+
+} // namespace
 
 ShapeItem::ShapeItem(std::unique_ptr<Shape> shape, QGraphicsItem* parent)
     : QGraphicsItem(parent), shape_(std::move(shape)) {
@@ -21,31 +281,82 @@ ShapeItem::ShapeItem(std::unique_ptr<Shape> shape, QGraphicsItem* parent)
     updateTransformOrigin();
 }
 
+ShapeItem::~ShapeItem() {
+    if (staticLayer_) staticLayer_->release(this);
+}
+
 QRectF ShapeItem::boundingRect() const {
-    if (auto* ls = dynamic_cast<LineSegment*>(shape_.get())) {
-        return QRectF(ls->p1(), ls->p2()).normalized().adjusted(-1, -1, 1, 1);
-    }
-    if (auto* rc = dynamic_cast<Rectangle*>(shape_.get())) {
-        return rc->rect().normalized().adjusted(-1, -1, 1, 1);
+    if (!shape_) return {};
+    // 局部包围盒由模型缓存，几何未变时为 O(1)
+    return shape_->LocalBounds().adjusted(-1, -1, 1, 1);
+}
+
+bool ShapeItem::hitTest(const QPointF& localPos, double tolerance) const {
+    return shape_ && HitTest::Hit(*shape_, localPos, tolerance);
+}
+
+bool ShapeItem::contains(const QPointF& point) const {
+    const auto* ds = dynamic_cast<DrawingScene*>(scene());
+    return hitTest(point, ds ? ds->pickTolerance() : DrawingScene::kPickTolerancePx);
+}
+
+QPainterPath ShapeItem::shape() const {
+    if (!shape_) return {};
+    if (shapePenWidth_ == shape_->pen().widthF() && shapeRevision_ == shape_->geometryRevision()) return shapePath_;
+    // 闭合图形取填充轮廓，线类取笔画轮廓；均并上线宽，与 hitTest 的判定范围一致（不含拾取容差）
+    QPainterPath outline;
+    bool closed = true;
+    switch (shape_->kind()) {
+    case ShapeKind::LineSegment: {
+        const auto& s = static_cast<const LineSegment&>(*shape_);
+        outline.moveTo(s.p1());
+        outline.lineTo(s.p2());
+        closed = false;
+        break;
     }
-    if (auto* cc = dynamic_cast<Circle*>(shape_.get())) {
-        const auto r = cc->radius();
-        return QRectF(cc->center().x() - r, cc->center().y() - r, 2 * r, 2 * r).adjusted(-1, -1, 1, 1);
+    case ShapeKind::Polyline:
+        outline.addPolygon(QPolygonF(static_cast<const Polyline&>(*shape_).points()));
+        closed = false;
+        break;
+    case ShapeKind::Rectangle:
+        outline.addRect(static_cast<const Rectangle&>(*shape_).rect().normalized());
+        break;
+    case ShapeKind::Triangle: {
+        const auto& s = static_cast<const Triangle&>(*shape_);
+        outline.addPolygon(QPolygonF({s.p1(), s.p2(), s.p3()}));
+        outline.closeSubpath();
+        break;
     }
-    if (auto* tr = dynamic_cast<Triangle*>(shape_.get())) {
-        QPolygonF poly; poly << tr->p1() << tr->p2() << tr->p3();
-        return poly.boundingRect().adjusted(-1, -1, 1, 1);
+    case ShapeKind::Polygon:
+        outline.addPolygon(QPolygonF(static_cast<const Polygon&>(*shape_).points()));
+        outline.closeSubpath();
+        break;
+    case ShapeKind::Circle: {
+        const auto& s = static_cast<const Circle&>(*shape_);
+        outline.addEllipse(s.center(), s.radius(), s.radius());
+        break;
     }
-    if (auto* pg = dynamic_cast<Polygon*>(shape_.get())) {
-        return QPolygonF(pg->points()).boundingRect().adjusted(-1, -1, 1, 1);
+    case ShapeKind::Ellipse: {
+        const auto& s = static_cast<const Ellipse&>(*shape_);
+        outline.addEllipse(s.center(), s.rx(), s.ry());
+        break;
     }
-    if (auto* pl = dynamic_cast<Polyline*>(shape_.get())) {
-        return QPolygonF(pl->points()).boundingRect().adjusted(-1, -1, 1, 1);
+    case ShapeKind::Count:
+        break;
     }
-    if (auto* el = dynamic_cast<Ellipse*>(shape_.get())) {
-        return QRectF(el->center().x()-el->rx(), el->center().y()-el->ry(), el->rx()*2, el->ry()*2).adjusted(-1,-1,1,1);
+    QPainterPathStroker stroker;
+    stroker.setWidth(std::max<qreal>(1.0, shape_->pen().widthF()));
+    shapePath_ = stroker.createStroke(outline);
+    if (closed) {
+        // 不做布尔并集（顶点多时代价高）：按非零环绕规则把轮廓叠加两次。笔画带的环绕数为 ±1，
+        // 内部为 0；轮廓两次使内部为 ±2，且无论轮廓方向如何，带中落在轮廓内的一半也不会抵消为 0
+        shapePath_.setFillRule(Qt::WindingFill);
+        shapePath_.addPath(outline);
+        shapePath_.addPath(outline);
     }
-    return {};
+    shapeRevision_ = shape_->geometryRevision();
+    shapePenWidth_ = shape_->pen().widthF();
+    return shapePath_;
 }
 
 void ShapeItem::clearHandles() {
@@ -97,34 +408,12 @@ void ShapeItem::updateHandles() {
         return h;
     };
 
-    if (auto* ls = dynamic_cast<LineSegment*>(shape_.get())) {
-        mk(HandleKind::Vertex, 0, ls->p1());
-        mk(HandleKind::Vertex, 1, ls->p2());
-    } else if (auto* tr = dynamic_cast<Triangle*>(shape_.get())) {
-        mk(HandleKind::Vertex, 0, tr->p1());
-        mk(HandleKind::Vertex, 1, tr->p2());
-        mk(HandleKind::Vertex, 2, tr->p3());
-    } else if (auto* pg = dynamic_cast<Polygon*>(shape_.get())) {
-        const auto& pts = pg->points();
-        for (int i=0;i<pts.size();++i) mk(HandleKind::Vertex, i, pts[i]);
-    } else if (auto* pl = dynamic_cast<Polyline*>(shape_.get())) {
-        const auto& pts = pl->points();
-        for (int i=0;i<pts.size();++i) mk(HandleKind::Vertex, i, pts[i]);
-    } else if (auto* rc = dynamic_cast<Rectangle*>(shape_.get())) {
-        const auto r = rc->rect().normalized();
-        mk(HandleKind::Corner, 0, r.topLeft());
-        mk(HandleKind::Corner, 1, r.topRight());
-        mk(HandleKind::Corner, 2, r.bottomRight());
-        mk(HandleKind::Corner, 3, r.bottomLeft());
-    } else if (auto* cc = dynamic_cast<Circle*>(shape_.get())) {
-        const auto c = cc->center();
-        mk(HandleKind::Center, 0, c);
-        mk(HandleKind::Radius, 0, c + QPointF(cc->radius(), 0));
-    } else if (auto* el = dynamic_cast<Ellipse*>(shape_.get())) {
-        const auto c = el->center();
-        mk(HandleKind::Center, 0, c);
-        mk(HandleKind::Radius, 0, c + QPointF(el->rx(), 0));
-        mk(HandleKind::Radius, 1, c + QPointF(0, el->ry()));
+    const auto& ops = kindOps(shape_->kind());
+    QVector<std::pair<HandleKind, int>> specs;
+    ops.makeHandles(*shape_, specs);
+    for (const auto& [kind, idx] : specs) {
+        QPointF p;
+        if (ops.handlePos(*shape_, kind, idx, &p)) mk(kind, idx, p);
     }
 
     // 旋转手柄：放在局部包围盒顶部中心上方 30px
@@ -144,81 +433,26 @@ void ShapeItem::syncHandlesPositions(HandleKind activeKind, int activeIndex) {
         h->setPos(p);
     };
 
-    if (auto* ls = dynamic_cast<LineSegment*>(shape_.get())) {
-        for (auto* it : handles_) {
-            auto* h = dynamic_cast<ControlPointItem*>(it);
-            if (!h) continue;
-            if (h->kind() != ControlPointItem::Kind::Vertex) continue;
-            setIfNotActive(h, h->index() == 0 ? ls->p1() : ls->p2());
-        }
-    } else if (auto* tr = dynamic_cast<Triangle*>(shape_.get())) {
-        for (auto* it : handles_) {
-            auto* h = dynamic_cast<ControlPointItem*>(it);
-            if (!h) continue;
-            if (h->kind() != ControlPointItem::Kind::Vertex) continue;
-            if (h->index() == 0) setIfNotActive(h, tr->p1());
-            else if (h->index() == 1) setIfNotActive(h, tr->p2());
-            else if (h->index() == 2) setIfNotActive(h, tr->p3());
-        }
-    } else if (auto* pg = dynamic_cast<Polygon*>(shape_.get())) {
-        const auto& pts = pg->points();
-        for (auto* it : handles_) {
-            auto* h = dynamic_cast<ControlPointItem*>(it);
-            if (!h) continue;
-            if (h->kind() != ControlPointItem::Kind::Vertex) continue;
-            if (h->index() >= 0 && h->index() < pts.size()) setIfNotActive(h, pts[h->index()]);
-        }
-    } else if (auto* pl = dynamic_cast<Polyline*>(shape_.get())) {
-        const auto& pts = pl->points();
-        for (auto* it : handles_) {
-            auto* h = dynamic_cast<ControlPointItem*>(it);
-            if (!h) continue;
-            if (h->kind() != ControlPointItem::Kind::Vertex) continue;
-            if (h->index() >= 0 && h->index() < pts.size()) setIfNotActive(h, pts[h->index()]);
-        }
-    } else if (auto* rc = dynamic_cast<Rectangle*>(shape_.get())) {
-        const auto r = rc->rect().normalized();
-        for (auto* it : handles_) {
-            auto* h = dynamic_cast<ControlPointItem*>(it);
-            if (!h) continue;
-            if (h->kind() != ControlPointItem::Kind::Corner) continue;
-            switch (h->index()) {
-            case 0: setIfNotActive(h, r.topLeft()); break;
-            case 1: setIfNotActive(h, r.topRight()); break;
-            case 2: setIfNotActive(h, r.bottomRight()); break;
-            case 3: setIfNotActive(h, r.bottomLeft()); break;
-            default: break;
-            }
-        }
-    } else if (auto* cc = dynamic_cast<Circle*>(shape_.get())) {
-        const auto c = cc->center();
-        for (auto* it : handles_) {
-            auto* h = dynamic_cast<ControlPointItem*>(it);
-            if (!h) continue;
-            if (h->kind() == ControlPointItem::Kind::Center) setIfNotActive(h, c);
-            else if (h->kind() == ControlPointItem::Kind::Radius) setIfNotActive(h, c + QPointF(cc->radius(), 0));
-        }
-    } else if (auto* el = dynamic_cast<Ellipse*>(shape_.get())) {
-        const auto c = el->center();
-        for (auto* it : handles_) {
-            auto* h = dynamic_cast<ControlPointItem*>(it);
-            if (!h) continue;
-            if (h->kind() == ControlPointItem::Kind::Center) setIfNotActive(h, c);
-            else if (h->kind() == ControlPointItem::Kind::Radius) {
-                if (h->index() == 0) setIfNotActive(h, c + QPointF(el->rx(), 0));
-                else if (h->index() == 1) setIfNotActive(h, c + QPointF(0, el->ry()));
-            }
-        }
+    const auto& ops = kindOps(shape_->kind());
+    for (auto* it : handles_) {
+        auto* h = static_cast<ControlPointItem*>(it);
+        QPointF p;
+        if (ops.handlePos(*shape_, static_cast<HandleKind>(h->kind()), h->index(), &p)) setIfNotActive(h, p);
     }
 
-    if (rotationHandle_ && !(activeKind == HandleKind::Rotation)) {
-        const auto br = boundingRect();
-        QPointF topCenter = QPointF((br.left()+br.right())/2.0, br.top());
-        rotationHandle_->setPos(topCenter + QPointF(0, -30));
-    }
+    if (!(activeKind == HandleKind::Rotation)) syncRotationHandle();
+}
+
+void ShapeItem::syncRotationHandle() {
+    if (!rotationHandle_) return;
+    const auto br = boundingRect();
+    QPointF topCenter = QPointF((br.left()+br.right())/2.0, br.top());
+    rotationHandle_->setPos(topCenter + QPointF(0, -30));
 }
 
-void ShapeItem::handleMoved(HandleKind kind, int index, const QPointF& localPos, const QPointF& /*scenePos*/, bool /*release*/) {
+void ShapeItem::handleMoved(HandleKind kind, int index, const QPointF& localPos, const QPointF& /*scenePos*/, bool release) {
+    // 拖拽期间几何每次移动都变，不重建化简金字塔；松开后首次绘制时重建一次
+    editing_ = !release;
     auto notifyMetrics = [&] {
         if (scene()) {
             if (auto ds = dynamic_cast<DrawingScene*>(scene())) {
@@ -226,131 +460,36 @@ void ShapeItem::handleMoved(HandleKind kind, int index, const QPointF& localPos,
             }
         }
     };
-    if (auto* ls = dynamic_cast<LineSegment*>(shape_.get())) {
-        if (kind == HandleKind::Vertex) {
-            const QRectF oldBr = boundingRect();
-            prepareGeometryChange();
-            const QPointF fixed = (index == 0) ? ls->p2() : ls->p1();
-            if (index == 0) ls->setP1(localPos); else ls->setP2(localPos);
-            const QRectF newBr = boundingRect();
-            update(oldBr.united(newBr));
-            updateTransformOriginPreservingScenePoint(fixed);
-            syncHandlesPositions(kind, index);
-            notifyMetrics();
-        }
-    } else if (auto* tr = dynamic_cast<Triangle*>(shape_.get())) {        
-        if (kind == HandleKind::Vertex) {
-            const QRectF oldBr = boundingRect();
-            prepareGeometryChange();
-            const QPointF fixed = (index == 0) ? tr->p2() : tr->p1();
-            if (index == 0) tr->setP1(localPos);
-            else if (index == 1) tr->setP2(localPos);
-            else tr->setP3(localPos);
-            const QRectF newBr = boundingRect();
-            update(oldBr.united(newBr));
-            updateTransformOriginPreservingScenePoint(fixed);
-            syncHandlesPositions(kind, index);
-            notifyMetrics();
-        }
-    } else if (auto* pg = dynamic_cast<Polygon*>(shape_.get())) {
-        if (kind == HandleKind::Vertex) {
-            const QRectF oldBr = boundingRect();
-            prepareGeometryChange();
-            auto pts = pg->points();
-            const int fixedIndex = (pts.size() > 1) ? ((index == 0) ? 1 : 0) : -1;
-            const QPointF fixed = (fixedIndex >= 0) ? pts[fixedIndex] : QPointF{};
-            if (index>=0 && index<pts.size()) pts[index] = localPos;      
-            pg->setPoints(pts);
-            const QRectF newBr = boundingRect();
-            update(oldBr.united(newBr));
-            if (fixedIndex >= 0) updateTransformOriginPreservingScenePoint(fixed);
-            else updateTransformOrigin();
-            syncHandlesPositions(kind, index);
-            notifyMetrics();
-        }
-    } else if (auto* pl = dynamic_cast<Polyline*>(shape_.get())) {        
-        if (kind == HandleKind::Vertex) {
-            const QRectF oldBr = boundingRect();
-            prepareGeometryChange();
-            auto pts = pl->points();
-            const int fixedIndex = (pts.size() > 1) ? ((index == 0) ? 1 : 0) : -1;
-            const QPointF fixed = (fixedIndex >= 0) ? pts[fixedIndex] : QPointF{};
-            if (index>=0 && index<pts.size()) pts[index] = localPos;      
-            pl->setPoints(pts);
-            const QRectF newBr = boundingRect();
-            update(oldBr.united(newBr));
-            if (fixedIndex >= 0) updateTransformOriginPreservingScenePoint(fixed);
-            else updateTransformOrigin();
-            syncHandlesPositions(kind, index);
-            notifyMetrics();
-        }
-    } else if (auto* rc = dynamic_cast<Rectangle*>(shape_.get())) {       
-        if (kind == HandleKind::Corner) {
-            const QRectF oldBr = boundingRect();
-            prepareGeometryChange();
-            const QRectF r = rc->rect().normalized();
-            QPointF fixed;
-            switch (index) {
-            case 0: fixed = r.bottomRight(); break; // drag TL, fix BR    
-            case 1: fixed = r.bottomLeft(); break;  // drag TR, fix BL    
-            case 2: fixed = r.topLeft(); break;     // drag BR, fix TL    
-            case 3: fixed = r.topRight(); break;    // drag BL, fix TR    
-            default: fixed = r.bottomRight(); break;
-            }
+    const auto& ops = kindOps(shape_->kind());
+    if (!ops.accepts(kind)) return;
 
-            rc->setRect(QRectF(localPos, fixed).normalized());
-            updateTransformOriginPreservingScenePoint(fixed);
+    const QRectF oldBr = boundingRect();
+    prepareGeometryChange();
+    const HandleEdit edit = ops.moveHandle(*shape_, kind, index, localPos);
+    const QRectF newBr = boundingRect();
+    update(oldBr.united(newBr));
+    if (edit.hasFixed) updateTransformOriginPreservingScenePoint(edit.fixed);
+    else updateTransformOrigin();
+    if (edit.othersUnchanged) syncRotationHandle();
+    else syncHandlesPositions(kind, index);
+    notifyMetrics();
+}
 
-            const QRectF newBr = boundingRect();
-            update(oldBr.united(newBr));
-            syncHandlesPositions(kind, index);
-            notifyMetrics();
-        }
-    } else if (auto* cc = dynamic_cast<Circle*>(shape_.get())) {
-        if (kind == HandleKind::Center) {
-            const QRectF oldBr = boundingRect();
-            prepareGeometryChange();
-            cc->setCenter(localPos);
-            const QRectF newBr = boundingRect();
-            update(oldBr.united(newBr));
-            updateTransformOrigin();
-            syncHandlesPositions(kind, index);
-            notifyMetrics();
-        } else if (kind == HandleKind::Radius) {
-            const QRectF oldBr = boundingRect();
-            prepareGeometryChange();
-            const auto c = cc->center();
-            const double r = std::hypot(localPos.x() - c.x(), localPos.y() - c.y());
-            cc->setRadius(r);
-            const QRectF newBr = boundingRect();
-            update(oldBr.united(newBr));
-            updateTransformOrigin();
-            syncHandlesPositions(kind, index);
-            notifyMetrics();
-        }
-    } else if (auto* el = dynamic_cast<Ellipse*>(shape_.get())) {
-        if (kind == HandleKind::Center) {
-            const QRectF oldBr = boundingRect();
-            prepareGeometryChange();
-            el->setCenter(localPos);
-            const QRectF newBr = boundingRect();
-            update(oldBr.united(newBr));
-            updateTransformOrigin();
-            syncHandlesPositions(kind, index);
-            notifyMetrics();
-        } else if (kind == HandleKind::Radius) {
-            const QRectF oldBr = boundingRect();
-            prepareGeometryChange();
-            const auto c = el->center();
-            if (index == 0) el->setRx(std::abs(localPos.x() - c.x()));    
-            else el->setRy(std::abs(localPos.y() - c.y()));
-            const QRectF newBr = boundingRect();
-            update(oldBr.united(newBr));
-            updateTransformOrigin();
-            syncHandlesPositions(kind, index);
-            notifyMetrics();
-        }
+void ShapeItem::moveHandleTo(HandleKind kind, int index, const QPointF& localPos) {
+    if (!shape_) return;
+    handleMoved(kind, index, localPos, mapToScene(localPos), true);
+    auto matches = [&](QGraphicsItem* it) {
+        auto* h = static_cast<ControlPointItem*>(it);
+        return static_cast<HandleKind>(h->kind()) == kind && h->index() == index;
+    };
+    // 顶点控制点按下标顺序创建，先按下标直接命中，失败再查找
+    QGraphicsItem* h = (index >= 0 && index < handles_.size() && matches(handles_[index])) ? handles_[index] : nullptr;
+    if (!h) {
+        auto it = std::find_if(handles_.begin(), handles_.end(), matches);
+        if (it != handles_.end()) h = *it;
     }
+    QPointF p;
+    if (h && kindOps(shape_->kind()).handlePos(*shape_, kind, index, &p)) h->setPos(p);
 }
 
 void ShapeItem::mousePressEvent(QGraphicsSceneMouseEvent* event) {
@@ -381,43 +520,110 @@ void ShapeItem::mouseReleaseEvent(QGraphicsSceneMouseEvent* event) {
 }
 
 void ShapeItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*, QWidget*) {
-    painter->setRenderHint(QPainter::Antialiasing, true);
+    // 设备像素/局部单位
+    const double lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    const auto* ds = qobject_cast<DrawingScene*>(scene());
+    const DrawingScene::LodSettings lodCfg = ds ? ds->lodSettings() : DrawingScene::LodSettings{};
+    const QRectF& local = shape_->LocalBounds();
+    const double extent = std::max(local.width(), local.height()) * lod;
+    if (extent < lodCfg.pointSize && !isSelected()) {
+        // 缩小到亚像素的图形：完整几何与一个像素点在屏幕上无法区分
+        if (lodCfg.skipTiny) return;
+        painter->setRenderHint(QPainter::Antialiasing, false);
+        painter->fillRect(QRectF(local.center(), QSizeF(1.0 / lod, 1.0 / lod)), shape_->pen().color());
+        return;
+    }
+    painter->setRenderHint(QPainter::Antialiasing, extent >= lodCfg.aliasedSize || isSelected());
     painter->setPen(shape_->pen());
 
-    if (auto* ls = dynamic_cast<LineSegment*>(shape_.get())) {
-        painter->drawLine(ls->p1(), ls->p2());
+    painter->setBrush(Qt::NoBrush);
+    const auto& ops = kindOps(shape_->kind());
+    if (ops.ellipse) {
+        // 圆/椭圆按缩放档位取缓存的折线，避免每帧由 Qt 重新展平曲线
+        painter->drawPolygon(curvePolygon(lod));
         return;
     }
-    if (auto* rc = dynamic_cast<Rectangle*>(shape_.get())) {
-        painter->setBrush(Qt::NoBrush);
-        painter->drawRect(rc->rect());
-        return;
+    if (ops.pointList) {
+        const auto& pts = *ops.pointList(*shape_);
+        if (pts.size() >= Simplify::LodPyramid::kMinVertices && !editing_) {
+            // 偏差小于半个像素的化简层与原始几何在屏幕上无法区分
+            if (const QPolygonF* level = lodLevel(pts, ops.closedPath, kLodPixelTolerance / lod)) {
+                if (ops.closedPath) painter->drawPolygon(*level);
+                else painter->drawPolyline(*level);
+                return;
+            }
+        }
     }
-    if (auto* cc = dynamic_cast<Circle*>(shape_.get())) {
-        painter->setBrush(Qt::NoBrush);
-        const auto r = cc->radius();
-        painter->drawEllipse(cc->center(), r, r);
+    ops.paint(painter, *shape_);
+}
+
+void ShapeItem::appendOutline(double pixelScale, const QTransform& toScene, std::vector<QLineF>& out) {
+    auto ring = [&](const QPointF* pts, int n, bool closed) {
+        if (n < 2) return;
+        QPointF prev = toScene.map(pts[0]);
+        const QPointF first = prev;
+        for (int i = 1; i < n; ++i) {
+            const QPointF cur = toScene.map(pts[i]);
+            out.emplace_back(prev, cur);
+            prev = cur;
+        }
+        if (closed) out.emplace_back(prev, first);
+    };
+    const auto& ops = kindOps(shape_->kind());
+    if (ops.ellipse) {
+        const QPolygonF& poly = curvePolygon(pixelScale);
+        ring(poly.constData(), poly.size(), true);
         return;
     }
-    if (auto* tr = dynamic_cast<Triangle*>(shape_.get())) {
-        painter->setBrush(Qt::NoBrush);
-        QPolygonF poly; poly << tr->p1() << tr->p2() << tr->p3();
-        painter->drawPolygon(poly);
+    if (ops.pointList) {
+        const auto& pts = *ops.pointList(*shape_);
+        if (pts.size() >= Simplify::LodPyramid::kMinVertices) {
+            if (const QPolygonF* level = lodLevel(pts, ops.closedPath, kLodPixelTolerance / pixelScale)) {
+                ring(level->constData(), level->size(), ops.closedPath);
+                return;
+            }
+        }
+        ring(pts.constData(), pts.size(), ops.closedPath);
         return;
     }
-    if (auto* pg = dynamic_cast<Polygon*>(shape_.get())) {
-        painter->setBrush(Qt::NoBrush);
-        painter->drawPolygon(QPolygonF(pg->points()));
-        return;
+    switch (shape_->kind()) {
+    case ShapeKind::LineSegment: {
+        const auto& s = static_cast<const LineSegment&>(*shape_);
+        out.emplace_back(toScene.map(s.p1()), toScene.map(s.p2()));
+        break;
     }
-    if (auto* pl = dynamic_cast<Polyline*>(shape_.get())) {
-        painter->setBrush(Qt::NoBrush);
-        painter->drawPolyline(QPolygonF(pl->points()));
-        return;
+    case ShapeKind::Rectangle: {
+        const QRectF r = static_cast<const Rectangle&>(*shape_).rect().normalized();
+        const QPointF pts[] = {r.topLeft(), r.topRight(), r.bottomRight(), r.bottomLeft()};
+        ring(pts, 4, true);
+        break;
     }
-    if (auto* el = dynamic_cast<Ellipse*>(shape_.get())) {
-        painter->setBrush(Qt::NoBrush);
-        painter->drawEllipse(el->center(), el->rx(), el->ry());
-        return;
+    case ShapeKind::Triangle: {
+        const auto& s = static_cast<const Triangle&>(*shape_);
+        const QPointF pts[] = {s.p1(), s.p2(), s.p3()};
+        ring(pts, 3, true);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+const QPolygonF& ShapeItem::curvePolygon(double pixelScale) {
+    static const QPolygonF kEmpty;
+    const auto& ops = kindOps(shape_->kind());
+    if (!ops.ellipse) return kEmpty;
+    if (!curve_) curve_ = std::make_unique<Tessellate::CurveCache>();
+    const EllipseGeom g = ops.ellipse(*shape_);
+    return curve_->get(g.center, g.rx, g.ry, shape_->geometryRevision(), pixelScale, kCurvePixelTolerance);
+}
+
+const QPolygonF* ShapeItem::lodLevel(const QVector<QPointF>& pts, bool closed, double tolerance) {
+    // 金字塔按几何版本号惰性重建；编辑后首次绘制时重建一次
+    if (!lod_ || lodRevision_ != shape_->geometryRevision()) {
+        if (!lod_) lod_ = std::make_unique<Simplify::LodPyramid>();
+        lod_->build(pts.constData(), pts.size(), closed);
+        lodRevision_ = shape_->geometryRevision();
     }
+    return lod_->levelFor(tolerance);
 }
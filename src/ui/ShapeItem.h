@@ -1,8 +1,14 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <QGraphicsItem>
+#include <QLineF>
+#include <QPainterPath>
 #include "../core/Shape.h"
+#include "../core/ObjectPool.h"
+#include "../core/Simplify.h"
+#include "../core/Tessellate.h"
 #include "DrawingScene.h"
 #include "../core/shapes/LineSegment.h"
 #include "../core/shapes/Rectangle.h"
@@ -12,15 +18,35 @@
 #include "../core/shapes/Polyline.h"
 #include "../core/shapes/Ellipse.h"
 
+class StaticLayer;
+
 class ShapeItem : public QGraphicsItem {
     friend class ControlPointItem;
+    friend class StaticLayer;
 public:
+    // 与模型一样从对象池分配（见 core/ObjectPool.h）
+    FAKECAD_POOL_ALLOCATED
     explicit ShapeItem(std::unique_ptr<Shape> shape, QGraphicsItem* parent = nullptr);
-    ~ShapeItem() override = default;
+    ~ShapeItem() override;
 
     QRectF boundingRect() const override;
+    // 精确命中：按模型几何判定（线类只看笔画，闭合图形含内部），容差取所在 DrawingScene 的拾取容差
+    bool contains(const QPointF& point) const override;
+    QPainterPath shape() const override;
+    // 指定容差（局部单位）的命中测试
+    bool hitTest(const QPointF& localPos, double tolerance) const;
+    // 圆/椭圆在给定像素比例（设备像素/局部单位）下的折线细分（局部坐标，绘制与导出共用）；
+    // 结果按缩放档位与几何版本缓存；其他类型返回空
+    const QPolygonF& curvePolygon(double pixelScale);
     void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+    // 与 paint 相同几何（细分的圆/椭圆、化简的长折线）的轮廓边，经 toScene 变换后追加到 out（静态层批量绘制用）
+    void appendOutline(double pixelScale, const QTransform& toScene, std::vector<QLineF>& out);
+    // 停放在静态层中时不在场景中，由层绘制；选中或编辑前需先提升（StaticLayer::promote）
+    StaticLayer* staticLayer() const { return staticLayer_; }
     Shape* model() const { return shape_.get(); }
+    // 文档内的稳定编号（编辑日志按此引用图形）；加入 DrawingScene 时为 0 则由场景分配
+    quint64 shapeId() const { return shapeId_; }
+    void setShapeId(quint64 id) { shapeId_ = id; }
     QString typeName() const { return shape_ ? shape_->typeName() : QString(); }
     // 控制点支持（公开以便外部刷新）
     void showHandles(bool show);
@@ -31,12 +57,16 @@ public:
     // 控制点移动（提供给 ControlPointItem 调用）
     enum class HandleKind { Vertex, Corner, Center, Radius, Rotation };
     void handleMoved(HandleKind kind, int index, const QPointF& localPos, const QPointF& scenePos, bool release);
+    // 以编程方式移动单个控制点（撤销/重做用）：同 handleMoved，并同步该控制点自身位置
+    void moveHandleTo(HandleKind kind, int index, const QPointF& localPos);
     QVariant itemChange(GraphicsItemChange change, const QVariant &value) override {
         if (change == ItemSelectedHasChanged) {
             bool sel = value.toBool();
             showHandles(sel);
         } else if (change == ItemRotationHasChanged) {
             if (!handlesFrozen_) updateHandles();
+        } else if (change == ItemSceneHasChanged) {
+            if (auto ds = dynamic_cast<class DrawingScene*>(value.value<QGraphicsScene*>())) ds->registerShapeId(this);
         } else if (change == ItemPositionChange) {
             // 位置吸附到网格
             if (!suppressGridSnap_ && scene()) {
@@ -61,6 +91,9 @@ protected:
 
  private:
     std::unique_ptr<Shape> shape_;
+    quint64 shapeId_{0};
+    StaticLayer* staticLayer_{nullptr};
+    int staticSlot_{-1};
     QList<class QGraphicsItem*> handles_;
     class ControlPointItem* rotationHandle_ { nullptr };
     void clearHandles();
@@ -68,6 +101,9 @@ protected:
     void updateTransformOriginPreservingScenePoint(const QPointF& localPoint);
     void setHandlesFrozen(bool on) { handlesFrozen_ = on; }
     void syncHandlesPositions(HandleKind activeKind, int activeIndex);    
+    void syncRotationHandle();
+    // 多边形/折线的化简层（仅绘制用）；不需要化简时返回 nullptr
+    const QPolygonF* lodLevel(const QVector<QPointF>& pts, bool closed, double tolerance);
 
     // move tracking
     QPointF pressPos_{};
@@ -75,5 +111,18 @@ protected:
     bool moving_{false};
 
     bool handlesFrozen_{false};
+    // 控制点拖拽中：绘制原始顶点，不使用（会随每次移动失效的）化简金字塔
+    bool editing_{false};
     bool suppressGridSnap_{false};
+
+    // 绘制用的多分辨率顶点金字塔（按需创建），lodRevision_ 为构建时模型的几何版本号
+    std::unique_ptr<Simplify::LodPyramid> lod_;
+    quint32 lodRevision_{0};
+    // 圆/椭圆的折线细分缓存（按需创建）
+    std::unique_ptr<Tessellate::CurveCache> curve_;
+
+    // shape() 路径缓存（框选/碰撞用），按几何版本号失效
+    mutable QPainterPath shapePath_;
+    mutable quint32 shapeRevision_{0};
+    mutable qreal shapePenWidth_{-1.0};
 };
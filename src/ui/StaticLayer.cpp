@@ -0,0 +1,442 @@
+#include "StaticLayer.h"
+
+#include <QPaintDevice>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <algorithm>
+#include <cmath>
+
+#include "DrawingScene.h"
+#include "ShapeItem.h"
+
+namespace {
+
+// 每个网格格子平均约容纳的条目数
+constexpr double kEntriesPerCell = 4.0;
+constexpr int kMaxGridSide = 1024;
+// 包围盒覆盖的格子超过此数时不登记到格子，放入每次查询都遍历的 large_
+constexpr int kMaxCellsPerEntry = 64;
+
+} // namespace
+
+size_t qHash(const StaticLayer::TileLevel& l, size_t seed) noexcept {
+    return qHashMulti(seed, l.scale, l.dpr);
+}
+
+size_t qHash(const StaticLayer::TileKey& k, size_t seed) noexcept {
+    return qHashMulti(seed, k.scale, k.dpr, k.x, k.y);
+}
+
+StaticLayer::StaticLayer(DrawingScene* owner) : owner_(owner) {
+    setFlag(ItemUsesExtendedStyleOption, true);
+    setAcceptedMouseButtons(Qt::NoButton);
+    setZValue(-1);
+}
+
+StaticLayer::~StaticLayer() {
+    for (auto& e : entries_) {
+        if (!e.item) continue;
+        e.item->staticLayer_ = nullptr;
+        if (!e.promoted) delete e.item;
+    }
+    if (owner_) owner_->staticLayerDestroyed(this);
+}
+
+void StaticLayer::capture(Entry& e) {
+    e.toScene = e.item->sceneTransform();
+    // 含半个线宽：粗线不会越过包围盒，瓦片边缘不被截断
+    const qreal w = e.item->model()->pen().widthF() / 2;
+    e.box = e.item->sceneBoundingRect().adjusted(-w, -w, w, w);
+}
+
+void StaticLayer::park(const std::vector<ShapeItem*>& items) {
+    entries_.reserve(entries_.size() + items.size());
+    for (auto* item : items) {
+        item->staticLayer_ = this;
+        item->staticSlot_ = static_cast<int>(entries_.size());
+        entries_.push_back(Entry{item, {}, {}, false});
+        capture(entries_.back());
+        ++parked_;
+    }
+    rebuildIndex();
+    clearTiles();
+}
+
+void StaticLayer::promote(ShapeItem* item) {
+    if (item->staticLayer_ != this) return;
+    Entry& e = entries_[item->staticSlot_];
+    if (e.promoted) return;
+    indexRemove(item->staticSlot_);
+    e.promoted = true;
+    --parked_;
+    promoted_.push_back(item->staticSlot_);
+    invalidateTiles(e.box);
+    update(e.box);
+    owner_->addItem(item);
+    owner_->scheduleStaticDemote();
+}
+
+int StaticLayer::demoteIdle() {
+    int demoted = 0;
+    std::vector<int> keep;
+    for (int slot : promoted_) {
+        Entry& e = entries_[slot];
+        if (!e.item || !e.promoted) continue;
+        ShapeItem* item = e.item;
+        if (item->scene() == owner_ && (item->isSelected() || owner_->mouseGrabberItem() == item)) {
+            keep.push_back(slot);
+            continue;
+        }
+        if (item->scene()) item->scene()->removeItem(item);
+        e.promoted = false;
+        capture(e);
+        if (!bounds_.contains(e.box)) {
+            prepareGeometryChange();
+            bounds_ |= e.box;
+        }
+        indexInsert(slot);
+        ++parked_;
+        invalidateTiles(e.box);
+        update(e.box);
+        ++demoted;
+    }
+    promoted_.swap(keep);
+    return demoted;
+}
+
+void StaticLayer::release(ShapeItem* item) {
+    Entry& e = entries_[item->staticSlot_];
+    if (!e.promoted) {
+        indexRemove(item->staticSlot_);
+        --parked_;
+        invalidateTiles(e.box);
+        update(e.box);
+    }
+    e.item = nullptr;
+}
+
+bool StaticLayer::adoptBefore(ShapeItem* item, ShapeItem* next) {
+    int end = static_cast<int>(entries_.size());
+    if (next) {
+        if (next->staticLayer_ != this) return false;
+        end = next->staticSlot_;
+    }
+    int slot = end;
+    while (slot > 0 && !entries_[slot - 1].item) --slot;
+    if (slot == end) return false;
+    Entry& e = entries_[slot];
+    e.item = item;
+    e.promoted = true;
+    item->staticLayer_ = this;
+    item->staticSlot_ = slot;
+    if (std::find(promoted_.begin(), promoted_.end(), slot) == promoted_.end()) promoted_.push_back(slot);
+    owner_->addItem(item);
+    owner_->scheduleStaticDemote();
+    return true;
+}
+
+std::vector<ShapeItem*> StaticLayer::shapeItems() const {
+    std::vector<ShapeItem*> out;
+    out.reserve(entries_.size());
+    for (const auto& e : entries_) {
+        if (e.item) out.push_back(e.item);
+    }
+    return out;
+}
+
+ShapeItem* StaticLayer::itemAt(const QPointF& scenePos, double tolerance) const {
+    std::vector<int> hits;
+    query(QRectF(scenePos.x() - tolerance, scenePos.y() - tolerance, 2 * tolerance, 2 * tolerance), hits);
+    for (auto it = hits.rbegin(); it != hits.rend(); ++it) {
+        const Entry& e = entries_[*it];
+        if (e.item->hitTest(e.toScene.inverted().map(scenePos), tolerance)) return e.item;
+    }
+    return nullptr;
+}
+
+std::vector<ShapeItem*> StaticLayer::parkedIn(const QRectF& region) const {
+    std::vector<int> hits;
+    query(region, hits);
+    std::vector<ShapeItem*> out;
+    out.reserve(hits.size());
+    for (int i : hits) out.push_back(entries_[i].item);
+    return out;
+}
+
+StaticLayer::Batch& StaticLayer::batchFor(quint32 style, bool antialiased) {
+    const quint64 key = (quint64(style) << 1) | (antialiased ? 1 : 0);
+    auto it = batchIndex_.constFind(key);
+    if (it != batchIndex_.constEnd()) return batches_[it.value()];
+    batchIndex_.insert(key, static_cast<int>(batches_.size()));
+    batches_.push_back(Batch{style, antialiased, {}, {}});
+    return batches_.back();
+}
+
+void StaticLayer::setTileCacheEnabled(bool on) {
+    tileCacheEnabled_ = on;
+    if (!on) {
+        tiles_.clear();
+        clearTileIndex();
+    }
+    update();
+}
+
+void StaticLayer::clearTiles() {
+    tiles_.clear();
+    clearTileIndex();
+    update();
+}
+
+void StaticLayer::clearTileIndex() {
+    tileIndex_.clear();
+    indexedTiles_ = 0;
+}
+
+void StaticLayer::invalidateTiles(const QRectF& sceneRect) {
+    for (auto lv = tileIndex_.begin(); lv != tileIndex_.end();) {
+        const TileLevel level = lv.key();
+        const double span = kTileSize / level.scale;
+        const double pad = kTilePadPx / level.scale;
+        const QRectF r = sceneRect.adjusted(-pad, -pad, pad, pad);
+        const double x0 = std::floor(r.left() / span), x1 = std::floor(r.right() / span);
+        const double y0 = std::floor(r.top() / span), y1 = std::floor(r.bottom() / span);
+        QSet<QPoint>& cached = lv.value();
+        const qsizetype before = cached.size();
+        // 相交的瓦片比登记的还多（深度放大时的大图形）就改为遍历登记的坐标
+        if ((x1 - x0 + 1) * (y1 - y0 + 1) <= double(cached.size())) {
+            for (int y = int(y0); y <= int(y1); ++y) {
+                for (int x = int(x0); x <= int(x1); ++x) {
+                    if (cached.remove(QPoint(x, y))) tiles_.remove(TileKey{level.scale, level.dpr, x, y});
+                }
+            }
+        } else {
+            for (auto it = cached.begin(); it != cached.end();) {
+                if (it->x() >= x0 && it->x() <= x1 && it->y() >= y0 && it->y() <= y1) {
+                    tiles_.remove(TileKey{level.scale, level.dpr, it->x(), it->y()});
+                    it = cached.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        indexedTiles_ -= before - cached.size();
+        if (cached.isEmpty()) lv = tileIndex_.erase(lv);
+        else ++lv;
+    }
+}
+
+void StaticLayer::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget*) {
+    const QRectF exposed = (option ? option->exposedRect : boundingRect()) & bounds_;
+    if (exposed.isEmpty()) return;
+    const QTransform& wt = painter->worldTransform();
+    const int devType = painter->device()->devType();
+    const bool raster = devType == QInternal::Widget || devType == QInternal::Image || devType == QInternal::Pixmap;
+    // 旋转/非等比视图与矢量设备（打印、导出）直接绘制
+    if (!tileCacheEnabled_ || !raster || wt.type() > QTransform::TxScale || wt.m11() <= 0 || wt.m11() != wt.m22()) {
+        query(exposed, visible_);
+        drawVisible(painter);
+        return;
+    }
+    // 瓦片按场景坐标对齐：同一缩放级别下每块恰为 kTileSize 像素，平移只改变贴图位置
+    const double scale = wt.m11();
+    const double span = kTileSize / scale;
+    const qreal dpr = painter->device()->devicePixelRatioF();
+    // 缩放中的中间级别不再出现，为其切瓦片只会挤掉有用的瓦片
+    const TileLevel level {scale, dpr};
+    const bool settled = level == lastLevel_ || tileIndex_.contains(level);
+    lastLevel_ = level;
+    if (!settled) {
+        query(exposed, visible_);
+        drawVisible(painter);
+        return;
+    }
+    const int x0 = static_cast<int>(std::floor(exposed.left() / span));
+    const int x1 = static_cast<int>(std::floor(exposed.right() / span));
+    const int y0 = static_cast<int>(std::floor(exposed.top() / span));
+    const int y1 = static_cast<int>(std::floor(exposed.bottom() / span));
+    // 场景原点的设备位置取整一次，各瓦片在其上按整数像素排列，相邻瓦片之间无缝
+    const QPoint origin = wt.map(QPointF(0, 0)).toPoint();
+    painter->save();
+    painter->resetTransform();
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            const QImage& img = tile(TileKey{scale, dpr, x, y});
+            if (!img.isNull()) painter->drawImage(origin + QPoint(x * kTileSize, y * kTileSize), img);
+        }
+    }
+    painter->restore();
+}
+
+const QImage& StaticLayer::tile(const TileKey& key) {
+    static const QImage kEmpty;
+    if (const QImage* img = tiles_.object(key)) return *img;
+    const double span = kTileSize / key.scale;
+    const QRectF rect(key.x * span, key.y * span, span, span);
+    const double pad = kTilePadPx / key.scale;
+    query(rect.adjusted(-pad, -pad, pad, pad), visible_);
+    if (visible_.empty()) {
+        // 空白瓦片也缓存（代价按 1 KB 计），下次不再查询
+        tiles_.insert(key, new QImage, 1);
+        indexTile(key);
+        return kEmpty;
+    }
+    const int px = static_cast<int>(std::ceil(kTileSize * key.dpr));
+    auto* img = new QImage(px, px, QImage::Format_ARGB32_Premultiplied);
+    img->setDevicePixelRatio(key.dpr);
+    img->fill(Qt::transparent);
+    {
+        QPainter p(img);
+        p.setTransform(QTransform(key.scale, 0, 0, key.scale, -rect.left() * key.scale, -rect.top() * key.scale));
+        p.setClipRect(rect);
+        drawVisible(&p);
+    }
+    const QImage& out = *img;
+    tiles_.insert(key, img, std::max<qsizetype>(1, img->sizeInBytes() / 1024));
+    indexTile(key);
+    return out;
+}
+
+void StaticLayer::indexTile(const TileKey& key) {
+    QSet<QPoint>& cached = tileIndex_[TileLevel{key.scale, key.dpr}];
+    const qsizetype before = cached.size();
+    cached.insert(QPoint(key.x, key.y));
+    if (cached.size() == before) return;
+    if (++indexedTiles_ <= 2 * tiles_.count() + 64) return;
+    clearTileIndex();
+    for (const auto& k : tiles_.keys()) tileIndex_[TileLevel{k.scale, k.dpr}].insert(QPoint(k.x, k.y));
+    indexedTiles_ = tiles_.count();
+}
+
+void StaticLayer::drawVisible(QPainter* painter) {
+    if (visible_.empty()) return;
+    // 设备像素/场景单位
+    const double lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    const DrawingScene::LodSettings lodCfg = owner_ ? owner_->lodSettings() : DrawingScene::LodSettings{};
+
+    // 逐帧清空但保留各批次的容量
+    for (auto& b : batches_) {
+        b.lines.clear();
+        b.points.clear();
+    }
+    for (int i : visible_) {
+        Entry& e = entries_[i];
+        const Shape* s = e.item->model();
+        const double extent = std::max(s->LocalBounds().width(), s->LocalBounds().height()) * lod;
+        if (extent < lodCfg.pointSize) {
+            if (!lodCfg.skipTiny) batchFor(s->styleIndex(), false).points.push_back(e.box.center());
+            continue;
+        }
+        e.item->appendOutline(lod, e.toScene, batchFor(s->styleIndex(), extent >= lodCfg.aliasedSize).lines);
+    }
+
+    painter->setBrush(Qt::NoBrush);
+    const StyleTable& styles = StyleTable::instance();
+    for (const auto& b : batches_) {
+        if (b.lines.empty() && b.points.empty()) continue;
+        const QPen& pen = styles.at(b.style).pen;
+        painter->setRenderHint(QPainter::Antialiasing, b.antialiased);
+        if (!b.lines.empty()) {
+            painter->setPen(pen);
+            painter->drawLines(b.lines.data(), static_cast<int>(b.lines.size()));
+        }
+        if (!b.points.empty()) {
+            // 亚像素图形：一像素的点
+            painter->setPen(QPen(pen.color(), 0));
+            painter->drawPoints(b.points.data(), static_cast<int>(b.points.size()));
+        }
+    }
+}
+
+void StaticLayer::rebuildIndex() {
+    QRectF bounds;
+    int live = 0;
+    for (const auto& e : entries_) {
+        if (!e.item || e.promoted) continue;
+        bounds |= e.box;
+        ++live;
+    }
+    prepareGeometryChange();
+    bounds_ = bounds;
+    gridRect_ = bounds;
+    // 格子边长按平均每格 kEntriesPerCell 个条目估计
+    const double area = std::max(bounds.width() * bounds.height(), 1.0);
+    cellSize_ = std::max(std::sqrt(area * kEntriesPerCell / std::max(live, 1)), 1e-6);
+    cols_ = std::clamp(static_cast<int>(std::ceil(bounds.width() / cellSize_)), 1, kMaxGridSide);
+    rows_ = std::clamp(static_cast<int>(std::ceil(bounds.height() / cellSize_)), 1, kMaxGridSide);
+    cells_.assign(size_t(cols_) * rows_, {});
+    large_.clear();
+    marks_.assign(entries_.size(), 0);
+    stamp_ = 0;
+    for (int i = 0; i < static_cast<int>(entries_.size()); ++i) {
+        if (entries_[i].item && !entries_[i].promoted) indexInsert(i);
+    }
+}
+
+bool StaticLayer::cellRange(const QRectF& r, int& c0, int& r0, int& c1, int& r1) const {
+    if (cols_ == 0) return false;
+    // 网格外的部分夹到边缘格子：夹取保持区间相交关系，放回到网格外的条目仍可被查到
+    const double cw = gridRect_.width() / cols_;
+    const double ch = gridRect_.height() / rows_;
+    auto cell = [](double v, double origin, double size, int n) {
+        if (!(size > 0)) return 0;
+        return std::clamp(static_cast<int>(std::floor((v - origin) / size)), 0, n - 1);
+    };
+    c0 = cell(r.left(), gridRect_.left(), cw, cols_);
+    c1 = cell(r.right(), gridRect_.left(), cw, cols_);
+    r0 = cell(r.top(), gridRect_.top(), ch, rows_);
+    r1 = cell(r.bottom(), gridRect_.top(), ch, rows_);
+    return true;
+}
+
+void StaticLayer::indexInsert(int i) {
+    if (marks_.size() < entries_.size()) marks_.resize(entries_.size(), 0);
+    int c0, r0, c1, r1;
+    if (!cellRange(entries_[i].box, c0, r0, c1, r1) || (c1 - c0 + 1) * (r1 - r0 + 1) > kMaxCellsPerEntry) {
+        large_.push_back(i);
+        return;
+    }
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) cells_[size_t(r) * cols_ + c].push_back(i);
+    }
+}
+
+void StaticLayer::indexRemove(int i) {
+    auto erase = [i](std::vector<int>& v) {
+        auto it = std::find(v.begin(), v.end(), i);
+        if (it == v.end()) return false;
+        *it = v.back();
+        v.pop_back();
+        return true;
+    };
+    if (erase(large_)) return;
+    int c0, r0, c1, r1;
+    if (!cellRange(entries_[i].box, c0, r0, c1, r1)) return;
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) erase(cells_[size_t(r) * cols_ + c]);
+    }
+}
+
+void StaticLayer::query(const QRectF& region, std::vector<int>& out) const {
+    out.clear();
+    if (parked_ == 0) return;
+    if (++stamp_ == 0) {
+        std::fill(marks_.begin(), marks_.end(), 0);
+        stamp_ = 1;
+    }
+    auto visit = [&](int i) {
+        if (marks_[i] == stamp_) return;
+        marks_[i] = stamp_;
+        if (entries_[i].box.intersects(region)) out.push_back(i);
+    };
+    int c0, r0, c1, r1;
+    if (cellRange(region, c0, r0, c1, r1)) {
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) {
+                for (int i : cells_[size_t(r) * cols_ + c]) visit(i);
+            }
+        }
+    }
+    for (int i : large_) visit(i);
+    // 按文档顺序：同一样式批次内保持原有的绘制先后
+    std::sort(out.begin(), out.end());
+}
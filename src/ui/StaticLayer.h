@@ -0,0 +1,148 @@
+#pragma once
+
+#include <QCache>
+#include <QGraphicsItem>
+#include <QHash>
+#include <QImage>
+#include <QLineF>
+#include <QPoint>
+#include <QPointF>
+#include <QSet>
+#include <QTransform>
+#include <vector>
+
+class DrawingScene;
+class ShapeItem;
+
+// 静态层：打开的文档中未选中、未在编辑的图形“停放”在这里，不作为场景中的项——
+// 场景索引、逐项排序与逐项 paint 都只剩这一个图元。绘制时经网格索引取出暴露区域内的条目，
+// 按样式把轮廓（ShapeItem::appendOutline：细分后的圆/椭圆、化简后的长折线）汇总为场景坐标的线段数组，
+// 每种样式一次 drawLines；亚像素图形按 DrawingScene::LodSettings 汇总为点或跳过。
+// 在仅有缩放与平移的光栅设备上，绘制结果按缩放级别切成固定像素大小的瓦片缓存（LRU），
+// 平移与局部重绘只贴图；条目变化时只丢弃与其新旧包围盒相交的瓦片。
+// 连续缩放时每帧的级别都不同，级别首次出现时直接绘制，视图停在该级别后才切瓦片。
+//
+// 图形被选中或编辑时提升（promote）为场景中的真实 ShapeItem，之后由场景放回（demote）。
+// 停放期间 ShapeItem 对象保持存活（撤销命令与编辑日志仍按指针/编号引用），只是不在场景中；
+// 条目按文档顺序占位，放回时回到原位。层析构时删除仍停放的项
+class StaticLayer : public QGraphicsItem {
+public:
+    explicit StaticLayer(DrawingScene* owner);
+    ~StaticLayer() override;
+
+    QRectF boundingRect() const override { return bounds_; }
+    // 层本身不参与命中与鼠标事件：停放的图形由 DrawingScene 先提升再交给场景处理
+    QPainterPath shape() const override { return {}; }
+    bool contains(const QPointF&) const override { return false; }
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+    // 停放一批尚不在场景中的项（层接管所有权），按给定顺序排在已有条目之后
+    void park(const std::vector<ShapeItem*>& items);
+    // 提升：加入场景并不再由层绘制；已在场景中时无操作
+    void promote(ShapeItem* item);
+    // 把已提升且不再选中的项放回层中（位置与旋转可能已变）；返回放回的个数
+    int demoteIdle();
+    // ShapeItem 析构时调用：条目留空
+    void release(ShapeItem* item);
+    // 把尚不在场景中的 item 放进 next 之前连续空位中的第一个（next 为空时指末尾），即回到被删除前的次序；
+    // 先作为已提升的项加入场景，之后由场景放回。没有空位时返回 false
+    bool adoptBefore(ShapeItem* item, ShapeItem* next);
+
+    // 全部条目（含已提升的），按文档顺序
+    std::vector<ShapeItem*> shapeItems() const;
+    // scenePos 处最上层的停放项：包围盒粗筛后按 ShapeItem::hitTest 精确判定（容差为场景单位）
+    ShapeItem* itemAt(const QPointF& scenePos, double tolerance) const;
+    // 场景包围盒与 region 相交的停放项，按文档顺序
+    std::vector<ShapeItem*> parkedIn(const QRectF& region) const;
+    int parkedCount() const { return parked_; }
+
+    // 瓦片边长（设备无关像素）与缓存上限（KB）
+    static constexpr int kTileSize = 256;
+    static constexpr int kTileCacheKB = 64 * 1024;
+    // 条目包围盒只含半个线宽（细线为 0），抗锯齿还会向外多画约一个像素：
+    // 瓦片取条目与按条目丢弃瓦片时都按此像素数外扩
+    static constexpr double kTilePadPx = 1.0;
+    void setTileCacheEnabled(bool on);
+    bool tileCacheEnabled() const { return tileCacheEnabled_; }
+    qsizetype cachedTileCount() const { return tiles_.count(); }
+    // 外观整体改变（如细节层次设置）时丢弃全部瓦片
+    void clearTiles();
+
+private:
+    struct Entry {
+        ShapeItem* item;     // 为空表示已删除
+        QTransform toScene;  // 停放时的局部到场景变换（平移、绕中心旋转）
+        QRectF box;          // 场景包围盒
+        bool promoted;
+    };
+    // 每帧按（样式下标, 是否抗锯齿）汇总的几何
+    struct Batch {
+        quint32 style;
+        bool antialiased;
+        std::vector<QLineF> lines;
+        std::vector<QPointF> points;
+    };
+
+    // 缩放级别（设备像素/场景单位）与像素比
+    struct TileLevel {
+        double scale;
+        qreal dpr;
+        bool operator==(const TileLevel& o) const { return scale == o.scale && dpr == o.dpr; }
+    };
+    friend size_t qHash(const TileLevel& l, size_t seed) noexcept;
+    // 某级别下的一块瓦片
+    struct TileKey {
+        double scale;
+        qreal dpr;
+        int x;
+        int y;
+        bool operator==(const TileKey& o) const { return scale == o.scale && dpr == o.dpr && x == o.x && y == o.y; }
+    };
+    friend size_t qHash(const TileKey& k, size_t seed) noexcept;
+
+    void capture(Entry& e);
+    Batch& batchFor(quint32 style, bool antialiased);
+    // 直接绘制 visible_ 中的条目（painter 为场景坐标）
+    void drawVisible(QPainter* painter);
+    // 取瓦片，缺失时绘制；瓦片内没有图形时返回空图像
+    const QImage& tile(const TileKey& key);
+    // 逐级别只查与 sceneRect 相交的瓦片坐标（至多为该级别登记的数目），不遍历整个缓存
+    void invalidateTiles(const QRectF& sceneRect);
+    void clearTileIndex();
+    void indexTile(const TileKey& key);
+
+    // 均匀网格索引：条目登记在其包围盒覆盖的格子中，覆盖格子过多的放入 large_
+    void rebuildIndex();
+    void indexInsert(int i);
+    void indexRemove(int i);
+    bool cellRange(const QRectF& r, int& c0, int& r0, int& c1, int& r1) const;
+    // 包围盒与 region 相交的条目下标，升序（即文档顺序）
+    void query(const QRectF& region, std::vector<int>& out) const;
+
+    DrawingScene* owner_;
+    std::vector<Entry> entries_;
+    std::vector<int> promoted_;
+    int parked_ {0};
+    QRectF bounds_;
+
+    QRectF gridRect_;
+    double cellSize_ {1.0};
+    int cols_ {0};
+    int rows_ {0};
+    std::vector<std::vector<int>> cells_;
+    std::vector<int> large_;
+    mutable std::vector<quint32> marks_;
+    mutable quint32 stamp_ {0};
+
+    // 绘制缓冲（跨帧复用容量）
+    std::vector<Batch> batches_;
+    QHash<quint64, int> batchIndex_;
+    std::vector<int> visible_;
+    QCache<TileKey, QImage> tiles_ {kTileCacheKB};
+    // 按级别登记缓存过的瓦片坐标；QCache 淘汰的不会同步移除，登记数超过缓存数两倍时按缓存重建
+    QHash<TileLevel, QSet<QPoint>> tileIndex_;
+    qsizetype indexedTiles_ {0};
+    // 上一次绘制的级别：与本次相同（或该级别已有瓦片）才使用瓦片
+    TileLevel lastLevel_ {0.0, 0.0};
+    bool tileCacheEnabled_ {true};
+};
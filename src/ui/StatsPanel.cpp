@@ -0,0 +1,185 @@
+#include "StatsPanel.h"
+
+#include <QComboBox>
+#include <QGraphicsView>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLocale>
+#include <QPointer>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVBoxLayout>
+#include <QCoreApplication>
+#include <algorithm>
+#include <memory>
+
+#include "DrawingScene.h"
+#include "ShapeItem.h"
+#include "../core/ShapeStore.h"
+
+namespace {
+enum Column { ColType, ColCount, ColArea, ColPerimeter, ColLength, ColExtents, ColumnCount };
+
+QString fmt(double v) { return QLocale().toString(v, 'f', 2); }
+
+QString fmtExtents(const MeasureReport::Totals& t) {
+    if (t.count == 0) return QStringLiteral("-");
+    const auto& r = t.extents;
+    return QStringLiteral("(%1, %2) - (%3, %4)")
+        .arg(fmt(r.left()), fmt(r.top()), fmt(r.right()), fmt(r.bottom()));
+}
+} // namespace
+
+StatsPanel::StatsPanel(DrawingScene* scene, QGraphicsView* view, QWidget* parent)
+    : QWidget(parent), scene_(scene), view_(view) {
+    rebuildUI();
+}
+
+void StatsPanel::rebuildUI() {
+    auto* lay = new QVBoxLayout(this);
+    auto* top = new QHBoxLayout();
+    scopeCombo_ = new QComboBox(this);
+    scopeCombo_->addItem(tr("全部图形"), static_cast<int>(Scope::Document));
+    scopeCombo_->addItem(tr("选中图形"), static_cast<int>(Scope::Selection));
+    scopeCombo_->addItem(tr("可见区域"), static_cast<int>(Scope::Viewport));
+    refreshBtn_ = new QPushButton(tr("刷新"), this);
+    top->addWidget(scopeCombo_, 1);
+    top->addWidget(refreshBtn_);
+    lay->addLayout(top);
+
+    table_ = new QTableWidget(kShapeKindCount + 1, ColumnCount, this);
+    table_->setHorizontalHeaderLabels({tr("类型"), tr("数量"), tr("面积"), tr("周长"), tr("长度"), tr("范围")});
+    table_->verticalHeader()->setVisible(false);
+    table_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table_->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    for (int k = 0; k < kShapeKindCount; ++k) {
+        table_->setItem(k, ColType, new QTableWidgetItem(ShapeStore::KindName(static_cast<ShapeKind>(k))));
+    }
+    table_->setItem(kShapeKindCount, ColType, new QTableWidgetItem(tr("合计")));
+    lay->addWidget(table_, 1);
+
+    statusLbl_ = new QLabel(this);
+    lay->addWidget(statusLbl_);
+
+    debounce_ = new QTimer(this);
+    debounce_->setSingleShot(true);
+    debounce_->setInterval(200);
+
+    connect(debounce_, &QTimer::timeout, this, &StatsPanel::recompute);
+    connect(refreshBtn_, &QPushButton::clicked, this, &StatsPanel::recompute);
+    connect(scopeCombo_, qOverload<int>(&QComboBox::currentIndexChanged), this, &StatsPanel::recompute);
+
+    applyReport(0, MeasureReport{});
+}
+
+StatsPanel::Scope StatsPanel::scope() const {
+    return static_cast<Scope>(scopeCombo_->currentData().toInt());
+}
+
+void StatsPanel::scheduleRecompute() {
+    // 面板不可见时不统计，显示时再刷新
+    if (!isVisible()) return;
+    debounce_->start();
+}
+
+void StatsPanel::recompute() {
+    debounce_->stop();
+    if (!scene_) return;
+
+    // 快照：Shape 的度量缓存不可跨线程访问，后台只读取 ShapeStore 副本
+    const Scope sc = scope();
+    std::vector<ShapeItem*> items;
+    if (sc == Scope::Selection) {
+        for (auto* it : scene_->selectedItems()) {
+            if (auto* si = dynamic_cast<ShapeItem*>(it)) items.push_back(si);
+        }
+    } else {
+        // 含停放在静态层中的图形
+        items = scene_->shapeItems();
+    }
+    auto& chunks = (sc == Scope::Selection) ? selectionChunks_ : documentChunks_;
+    refreshChunks(items, chunks);
+    std::vector<std::shared_ptr<const ShapeStore>> stores;
+    stores.reserve(chunks.size());
+    for (const auto& c : chunks) stores.push_back(c.store);
+    QRectF region;
+    if (sc == Scope::Viewport && view_) {
+        region = view_->mapToScene(view_->viewport()->rect()).boundingRect();
+    }
+
+    const quint64 gen = ++pending_;
+    statusLbl_->setText(tr("统计中（%1 个图形）...").arg(items.size()));
+    QPointer<StatsPanel> self(this);
+    QThreadPool::globalInstance()->start([self, stores = std::move(stores), region, sc, gen] {
+        // 各块一起交给 Compute，由其在线程池上并行
+        std::vector<const ShapeStore*> parts;
+        parts.reserve(stores.size());
+        for (const auto& store : stores) parts.push_back(store.get());
+        auto report = std::make_shared<MeasureReport>(sc == Scope::Viewport ? MeasureReport::ComputeInRect(parts, region)
+                                                                             : MeasureReport::Compute(parts));
+        // 以 qApp 为上下文投递回 GUI 线程，面板若已销毁则由 QPointer 拦截
+        QMetaObject::invokeMethod(qApp, [self, report, gen] {
+            if (self) self->applyReport(gen, *report);
+        }, Qt::QueuedConnection);
+    });
+}
+
+bool StatsPanel::RowKey::operator==(const RowKey& o) const {
+    return id == o.id && revision == o.revision && tx == o.tx && ty == o.ty && rotation == o.rotation;
+}
+
+void StatsPanel::refreshChunks(const std::vector<ShapeItem*>& items, std::vector<SnapshotChunk>& chunks) {
+    const size_t count = (items.size() + kChunkRows - 1) / kChunkRows;
+    chunks.resize(count);
+    std::vector<RowKey> keys;
+    for (size_t c = 0; c < count; ++c) {
+        const size_t begin = c * kChunkRows;
+        const size_t end = std::min(items.size(), begin + kChunkRows);
+        keys.clear();
+        keys.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            const Shape* s = items[i]->model();
+            keys.push_back(RowKey{items[i]->shapeId(), s->geometryRevision(), s->transform().m31(), s->transform().m32(),
+                                  s->rotationDegrees()});
+        }
+        SnapshotChunk& chunk = chunks[c];
+        if (chunk.store && chunk.keys == keys) continue;
+        auto store = std::make_shared<ShapeStore>();
+        store->reserve(static_cast<qsizetype>(end - begin));
+        for (size_t i = begin; i < end; ++i) store->append(*items[i]->model());
+        chunk.store = std::move(store);
+        chunk.keys.swap(keys);
+    }
+}
+
+void StatsPanel::applyReport(quint64 generation, const MeasureReport& report) {
+    // 丢弃过期结果（期间已发起更新的统计）
+    if (generation != pending_) return;
+    applied_ = generation;
+    report_ = report;
+
+    auto setRow = [this](int row, const MeasureReport::Totals& t, bool areaKind, bool lineKind) {
+        auto set = [this, row](int col, const QString& text) {
+            auto* cell = table_->item(row, col);
+            if (!cell) { cell = new QTableWidgetItem(); table_->setItem(row, col, cell); }
+            cell->setText(text);
+        };
+        set(ColCount, QLocale().toString(t.count));
+        set(ColArea, areaKind ? fmt(t.area) : QStringLiteral("-"));
+        set(ColPerimeter, areaKind ? fmt(t.perimeter) : QStringLiteral("-"));
+        set(ColLength, lineKind ? fmt(t.length) : QStringLiteral("-"));
+        set(ColExtents, fmtExtents(t));
+    };
+    for (int k = 0; k < kShapeKindCount; ++k) {
+        const auto kind = static_cast<ShapeKind>(k);
+        const bool line = (kind == ShapeKind::LineSegment || kind == ShapeKind::Polyline);
+        setRow(k, report.byKind[k], !line, line);
+    }
+    setRow(kShapeKindCount, report.total, true, true);
+
+    statusLbl_->setText(tr("共 %1 个图形").arg(QLocale().toString(report.total.count)));
+    emit reportReady();
+}
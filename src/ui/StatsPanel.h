@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QWidget>
+#include <memory>
+#include <vector>
+
+#include "../core/MeasureReport.h"
+
+class QComboBox;
+class QLabel;
+class QPushButton;
+class QTableWidget;
+class QTimer;
+class QGraphicsView;
+class DrawingScene;
+class ShapeItem;
+class ShapeStore;
+
+// 统计面板：按类型显示实例数、总面积、总周长/长度与外包范围。
+// 在 GUI 线程只做场景快照（ShapeStore），统计在线程池中并行计算，完成后回到 GUI 线程刷新表格。
+// 快照按固定行数分块并跨次复用：块内图形的编号、几何版本与位姿都未变时沿用上次的副本，
+// 编辑后只复制变化的块，其余只做逐项比较。
+class StatsPanel : public QWidget {
+    Q_OBJECT
+ public:
+    enum class Scope { Document, Selection, Viewport };
+
+    StatsPanel(DrawingScene* scene, QGraphicsView* view, QWidget* parent = nullptr);
+
+    Scope scope() const;
+    // 最近一次完成的统计结果
+    const MeasureReport& report() const { return report_; }
+    bool busy() const { return pending_ != applied_; }
+
+public slots:
+    // 立即重新统计（丢弃仍在计算中的旧结果）
+    void recompute();
+    // 合并短时间内的多次变化，稍后统计一次
+    void scheduleRecompute();
+
+signals:
+    void reportReady();
+
+ private:
+    void rebuildUI();
+    void applyReport(quint64 generation, const MeasureReport& report);
+
+    struct RowKey {
+        quint64 id;
+        quint32 revision;
+        double tx;
+        double ty;
+        double rotation;
+        bool operator==(const RowKey& o) const;
+    };
+    struct SnapshotChunk {
+        std::vector<RowKey> keys;
+        std::shared_ptr<const ShapeStore> store;
+    };
+    static constexpr int kChunkRows = 4096;
+    // 按 items 更新分块快照，只重建有变化的块
+    static void refreshChunks(const std::vector<ShapeItem*>& items, std::vector<SnapshotChunk>& chunks);
+
+    DrawingScene* scene_ { nullptr };
+    QGraphicsView* view_ { nullptr };
+    MeasureReport report_;
+    quint64 pending_ { 0 };
+    quint64 applied_ { 0 };
+    // 文档/可见区域范围共用一份快照，选中范围另用一份
+    std::vector<SnapshotChunk> documentChunks_;
+    std::vector<SnapshotChunk> selectionChunks_;
+
+    QComboBox* scopeCombo_ {};
+    QPushButton* refreshBtn_ {};
+    QTableWidget* table_ {};
+    QLabel* statusLbl_ {};
+    QTimer* debounce_ {};
+};
@@ -1,13 +1,29 @@
 #include "Commands.h"
 
 #include <QGraphicsScene>
+#include <algorithm>
+#include <unordered_map>
 
 #include "../ui/DrawingScene.h"
 #include "../ui/ShapeItem.h"
+#include "../ui/StaticLayer.h"
 #include "../core/Serialization.h"
+#include "../core/StyleTable.h"
+#include "EditJournal.h"
 
 using namespace UndoCmd;
 
+// 命令效果追加到场景的编辑日志（未启用日志时为空）
+static EditJournal* journalOf(QGraphicsScene* scene) {
+    auto* ds = dynamic_cast<DrawingScene*>(scene);
+    return ds ? ds->journal() : nullptr;
+}
+
+// 停放在静态层中的图形先提升回场景再修改（之后由场景放回），日志与场景通知都依赖 item->scene()
+static void promote(ShapeItem* item) {
+    if (auto* layer = item->staticLayer()) layer->promote(item);
+}
+
 AddShapeCommand::AddShapeCommand(DrawingScene* scene, const QJsonObject& shapeJson, QUndoCommand* parent)
     : QUndoCommand(QObject::tr("添加图形"), parent), scene_(scene), json_(shapeJson) {}
 
@@ -18,10 +34,12 @@ void AddShapeCommand::redo() {
     auto* item = new ShapeItem(std::move(shape));
     scene_->addItem(item);
     item_ = item;
+    if (auto* j = scene_->journal()) j->recordAdd(item->shapeId(), json_);
 }
 
 void AddShapeCommand::undo() {
     if (item_) {
+        if (auto* j = scene_->journal()) j->recordRemove(item_->shapeId());
         scene_->removeItem(item_);
         delete item_;
         item_ = nullptr;
@@ -36,7 +54,11 @@ void DeleteShapesCommand::redo() {
     if (!items_.empty()) {
         // 已经创建过，直接删
         for (auto& it : items_) {
-            if (it) { scene_->removeItem(it); delete it; }
+            if (!it) continue;
+            promote(it);
+            if (auto* j = scene_->journal()) j->recordRemove(it->shapeId());
+            scene_->removeItem(it);
+            delete it;
         }
         items_.clear();
         return;
@@ -48,7 +70,10 @@ void DeleteShapesCommand::redo() {
             items_.push_back(si);
         }
     }
-    for (auto& it : items_) { scene_->removeItem(it); }
+    for (auto& it : items_) {
+        if (auto* j = scene_->journal()) j->recordRemove(it->shapeId());
+        scene_->removeItem(it);
+    }
     // 延后统一删除以避免迭代失效
     for (auto& it : items_) { delete it; }
     items_.clear();
@@ -62,6 +87,7 @@ void DeleteShapesCommand::undo() {
         auto* item = new ShapeItem(std::move(s));
         scene_->addItem(item);
         items_.push_back(item);
+        if (auto* jr = scene_->journal()) jr->recordAdd(item->shapeId(), j);
     }
 }
 
@@ -70,6 +96,7 @@ TransformShapeCommand::TransformShapeCommand(ShapeItem* item, const QPointF& old
 
 void TransformShapeCommand::apply(const QPointF& pos, double rot) {       
     if (!item_) return;
+    promote(item_);
     item_->setPos(pos);
     item_->setRotation(rot);
     if (item_->model()) {
@@ -80,6 +107,7 @@ void TransformShapeCommand::apply(const QPointF& pos, double rot) {
     if (auto ds = dynamic_cast<DrawingScene*>(item_->scene())) {
         ds->notifyShapeMetricsChanged(item_);
     }
+    if (auto* j = journalOf(item_->scene())) j->recordTransform(item_->shapeId(), pos, rot);
 }
 
 void TransformShapeCommand::redo() { apply(newPos_, newRot_); }
@@ -90,6 +118,7 @@ EditShapeJsonCommand::EditShapeJsonCommand(ShapeItem* item, const QJsonObject& o
 
 void EditShapeJsonCommand::apply(const QJsonObject& j) {
     if (!item_ || !item_->model()) return;
+    promote(item_);
     item_->aboutToChangeGeometry();
     Ser::ApplyJsonToShape(item_->model(), j);
     item_->geometryChanged();
@@ -97,7 +126,111 @@ void EditShapeJsonCommand::apply(const QJsonObject& j) {
     if (auto ds = dynamic_cast<DrawingScene*>(item_->scene())) {
         ds->notifyShapeMetricsChanged(item_);
     }
+    if (auto* jr = journalOf(item_->scene())) jr->recordEdit(item_->shapeId(), j);
 }
 
 void EditShapeJsonCommand::redo() { apply(neo_); }
 void EditShapeJsonCommand::undo() { apply(old_); }
+
+SetStyleCommand::SetStyleCommand(ShapeItem* item, quint32 oldStyle, quint32 newStyle, QUndoCommand* parent)
+    : QUndoCommand(QObject::tr("修改样式"), parent), item_(item), old_(oldStyle), neo_(newStyle) {}
+
+void SetStyleCommand::apply(quint32 style) {
+    if (!item_ || !item_->model()) return;
+    promote(item_);
+    // 线宽影响包围盒
+    item_->aboutToChangeGeometry();
+    item_->model()->setStyleIndex(style);
+    item_->geometryChanged();
+    if (auto ds = dynamic_cast<DrawingScene*>(item_->scene())) {
+        ds->notifyShapeMetricsChanged(item_);
+    }
+    if (auto* j = journalOf(item_->scene())) {
+        const auto& st = StyleTable::instance().at(style);
+        j->recordStyle(item_->shapeId(), st.color, st.pen.widthF());
+    }
+}
+
+void SetStyleCommand::redo() { apply(neo_); }
+void SetStyleCommand::undo() { apply(old_); }
+
+RenameShapeCommand::RenameShapeCommand(ShapeItem* item, const QString& oldName, const QString& newName, QUndoCommand* parent)
+    : QUndoCommand(QObject::tr("重命名"), parent), item_(item), old_(oldName), neo_(newName) {}
+
+void RenameShapeCommand::apply(const QString& name) {
+    if (!item_ || !item_->model()) return;
+    promote(item_);
+    item_->model()->setName(name);
+    if (auto ds = dynamic_cast<DrawingScene*>(item_->scene())) {
+        ds->notifyShapeMetricsChanged(item_);
+    }
+    if (auto* j = journalOf(item_->scene())) j->recordName(item_->shapeId(), name);
+}
+
+void RenameShapeCommand::redo() { apply(neo_); }
+void RenameShapeCommand::undo() { apply(old_); }
+
+MoveVertexCommand::MoveVertexCommand(ShapeItem* item, int index, const QPointF& oldPos, const QPointF& newPos, QUndoCommand* parent)
+    : QUndoCommand(QObject::tr("编辑几何"), parent), item_(item), index_(index), old_(oldPos), neo_(newPos) {}
+
+// 与拖拽走同一路径（保持相邻顶点的场景位置不变），结果与拖拽一致；日志只记该顶点
+void MoveVertexCommand::apply(const QPointF& pos) {
+    if (!item_) return;
+    promote(item_);
+    item_->moveHandleTo(ShapeItem::HandleKind::Vertex, index_, pos);
+    if (auto* j = journalOf(item_->scene())) j->recordMoveVertex(item_->shapeId(), index_, pos);
+}
+
+void MoveVertexCommand::redo() { apply(neo_); }
+void MoveVertexCommand::undo() { apply(old_); }
+
+ReplaceShapesCommand::ReplaceShapesCommand(DrawingScene* scene, const std::vector<ShapeItem*>& replaced, const std::vector<QJsonObject>& results,
+                                           const QString& text, QUndoCommand* parent)
+    : QUndoCommand(text, parent), scene_(scene), newJsons_(results), oldItems_(replaced) {
+    // 按文档次序排列，撤销时依次插回
+    std::unordered_map<ShapeItem*, int> order;
+    const auto all = scene_->shapeItems();
+    for (size_t i = 0; i < all.size(); ++i) order[all[i]] = static_cast<int>(i);
+    std::stable_sort(oldItems_.begin(), oldItems_.end(), [&](ShapeItem* a, ShapeItem* b) { return order[a] < order[b]; });
+    oldJsons_.reserve(oldItems_.size());
+    for (auto* it : oldItems_) oldJsons_.push_back(it->model()->ToJson());
+}
+
+void ReplaceShapesCommand::removeAll(std::vector<ShapeItem*>& items) {
+    for (auto* it : items) {
+        promote(it);
+        if (auto* j = scene_->journal()) j->recordRemove(it->shapeId());
+        scene_->removeItem(it);
+    }
+    for (auto* it : items) delete it;
+    items.clear();
+}
+
+void ReplaceShapesCommand::addAll(const std::vector<QJsonObject>& jsons, std::vector<ShapeItem*>& items, const std::vector<int>* indices) {
+    for (size_t i = 0; i < jsons.size(); ++i) {
+        const QJsonObject& j = jsons[i];
+        auto s = Ser::FromJsonObject(j);
+        if (!s) continue;
+        auto* item = new ShapeItem(std::move(s));
+        const int at = (indices && i < indices->size()) ? (*indices)[i] : -1;
+        if (at >= 0) scene_->insertShapeItem(item, at);
+        else scene_->addItem(item);
+        items.push_back(item);
+        if (auto* jr = scene_->journal()) jr->recordAdd(item->shapeId(), j, at);
+    }
+}
+
+void ReplaceShapesCommand::redo() {
+    if (!scene_) return;
+    oldIndices_.clear();
+    const auto all = scene_->shapeItems();
+    for (auto* it : oldItems_) oldIndices_.push_back(static_cast<int>(std::find(all.begin(), all.end(), it) - all.begin()));
+    removeAll(oldItems_);
+    addAll(newJsons_, newItems_);
+}
+
+void ReplaceShapesCommand::undo() {
+    if (!scene_) return;
+    removeAll(newItems_);
+    addAll(oldJsons_, oldItems_, &oldIndices_);
+}
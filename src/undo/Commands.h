@@ -56,4 +56,59 @@ private:
     void apply(const QJsonObject& j);
 };
 
+// 修改样式（颜色/线宽）：只记录新旧样式在 StyleTable 中的下标，不快照几何
+class SetStyleCommand : public QUndoCommand {
+public:
+    SetStyleCommand(ShapeItem* item, quint32 oldStyle, quint32 newStyle, QUndoCommand* parent = nullptr);
+    void undo() override;
+    void redo() override;
+private:
+    ShapeItem* item_{};
+    quint32 old_{}, neo_{};
+    void apply(quint32 style);
+};
+
+class RenameShapeCommand : public QUndoCommand {
+public:
+    RenameShapeCommand(ShapeItem* item, const QString& oldName, const QString& newName, QUndoCommand* parent = nullptr);
+    void undo() override;
+    void redo() override;
+private:
+    ShapeItem* item_{};
+    QString old_, neo_;
+    void apply(const QString& name);
+};
+
+// 多边形/折线单个顶点的移动：只记录该顶点（局部坐标），撤销/重做代价与顶点总数无关
+class MoveVertexCommand : public QUndoCommand {
+public:
+    MoveVertexCommand(ShapeItem* item, int index, const QPointF& oldPos, const QPointF& newPos, QUndoCommand* parent = nullptr);
+    void undo() override;
+    void redo() override;
+private:
+    ShapeItem* item_{};
+    int index_{};
+    QPointF old_{}, neo_{};
+    void apply(const QPointF& pos);
+};
+
+// 以一组新图形替换指定的图形（布尔运算等）：快照被替换图形与结果的 JSON，
+// 撤销时删除结果并按快照重建原图形，放回原来的堆叠次序
+class ReplaceShapesCommand : public QUndoCommand {
+public:
+    ReplaceShapesCommand(DrawingScene* scene, const std::vector<ShapeItem*>& replaced, const std::vector<QJsonObject>& results,
+                         const QString& text, QUndoCommand* parent = nullptr);
+    void undo() override;
+    void redo() override;
+private:
+    DrawingScene* scene_{};
+    std::vector<QJsonObject> oldJsons_;
+    std::vector<QJsonObject> newJsons_;
+    std::vector<ShapeItem*> oldItems_;
+    std::vector<ShapeItem*> newItems_;
+    std::vector<int> oldIndices_;  // 被替换图形在 DrawingScene::shapeItems() 中的位置，升序
+    void removeAll(std::vector<ShapeItem*>& items);
+    void addAll(const std::vector<QJsonObject>& jsons, std::vector<ShapeItem*>& items, const std::vector<int>* indices = nullptr);
+};
+
 }
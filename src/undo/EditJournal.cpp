@@ -0,0 +1,303 @@
+#include "EditJournal.h"
+
+#include <QColor>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QObject>
+#include <QStandardPaths>
+#include <unordered_map>
+
+#include "Commands.h"
+#include "../ui/DrawingScene.h"
+#include "../ui/ShapeItem.h"
+#include "../ui/StaticLayer.h"
+#include "../core/Serialization.h"
+#include "../core/StyleTable.h"
+
+namespace {
+
+constexpr int kJournalVersion = 1;
+const QLatin1String kSuffix(".fcadj");
+
+QString appDataFile(const QString& name) {
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    QDir().mkpath(dir);
+    return QDir(dir).filePath(name);
+}
+
+// 编号序列按连续段编码：打开后未编辑的文档只有一段
+QJsonArray encodeIds(const std::vector<quint64>& ids) {
+    QJsonArray runs;
+    for (size_t i = 0; i < ids.size();) {
+        size_t j = i + 1;
+        while (j < ids.size() && ids[j] == ids[j - 1] + 1) ++j;
+        runs.append(QJsonArray{static_cast<qint64>(ids[i]), static_cast<qint64>(j - i)});
+        i = j;
+    }
+    return runs;
+}
+
+std::vector<quint64> decodeIds(const QJsonArray& runs) {
+    std::vector<quint64> ids;
+    for (const auto& r : runs) {
+        const auto run = r.toArray();
+        const auto first = static_cast<quint64>(run.at(0).toInteger());
+        const qint64 count = run.at(1).toInteger();
+        for (qint64 k = 0; k < count; ++k) ids.push_back(first + static_cast<quint64>(k));
+    }
+    return ids;
+}
+
+QJsonObject baseRecord(const QString& basePath) {
+    const QFileInfo fi(basePath);
+    return QJsonObject{{"op", "base"}, {"size", fi.size()}, {"mtime", fi.lastModified().toMSecsSinceEpoch()}};
+}
+
+} // namespace
+
+struct EditJournal::Target {
+    QFile file;
+    QString basePath;
+    QString finalPath;
+};
+
+EditJournal::EditJournal() = default;
+EditJournal::~EditJournal() = default;
+
+QString EditJournal::PathFor(const QString& documentPath) {
+    if (documentPath.isEmpty()) return appDataFile(QStringLiteral("untitled") + kSuffix);
+    return documentPath + kSuffix;
+}
+
+QString EditJournal::UntitledBasePath() { return appDataFile(QStringLiteral("untitled.fcadb")); }
+
+QString EditJournal::path() const { return file_ ? file_->finalPath : QString(); }
+
+// 新建 fileName 并写入头部（基准已写好时随即写基准记录）；之后的记录顺序追加在末尾
+static bool openJournal(QFile& f, const QString& basePath, const std::vector<quint64>& baseIds, bool baseWritten,
+                        QString* error) {
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = f.errorString();
+        return false;
+    }
+    const QJsonObject header{{"journal", kJournalVersion}, {"base", basePath}, {"ids", encodeIds(baseIds)}};
+    QByteArray bytes = QJsonDocument(header).toJson(QJsonDocument::Compact) + '\n';
+    if (baseWritten && !basePath.isEmpty()) bytes += QJsonDocument(baseRecord(basePath)).toJson(QJsonDocument::Compact) + '\n';
+    if (f.write(bytes) != bytes.size() || !f.flush()) {
+        if (error) *error = f.errorString();
+        f.close();
+        f.remove();
+        return false;
+    }
+    return true;
+}
+
+bool EditJournal::start(const QString& basePath, const std::vector<quint64>& baseIds, QString* error) {
+    discard();
+    auto t = std::make_unique<Target>();
+    t->basePath = basePath;
+    t->finalPath = PathFor(basePath);
+    t->file.setFileName(t->finalPath);
+    if (!openJournal(t->file, basePath, baseIds, true, error)) return false;
+    file_ = std::move(t);
+    return true;
+}
+
+bool EditJournal::beginRebase(const QString& basePath, const std::vector<quint64>& baseIds, QString* error) {
+    abortRebase();
+    auto t = std::make_unique<Target>();
+    t->basePath = basePath;
+    t->finalPath = PathFor(basePath);
+    t->file.setFileName(t->finalPath + QLatin1String(".new"));
+    if (!openJournal(t->file, basePath, baseIds, false, error)) return false;
+    pending_ = std::move(t);
+    return true;
+}
+
+bool EditJournal::commitRebase(QString* error) {
+    if (!pending_) return false;
+    // 基准文件此时已提交：补上其大小与修改时间，再替换当前日志
+    pending_->file.write(QJsonDocument(baseRecord(pending_->basePath)).toJson(QJsonDocument::Compact) + '\n');
+    pending_->file.flush();
+    if (file_) {
+        file_->file.close();
+        if (file_->finalPath != pending_->finalPath) QFile::remove(file_->finalPath);
+        file_.reset();
+    }
+    QFile::remove(pending_->finalPath);
+    if (!pending_->file.rename(pending_->finalPath)
+        || !pending_->file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        if (error) *error = pending_->file.errorString();
+        pending_.reset();
+        return false;
+    }
+    file_ = std::move(pending_);
+    return true;
+}
+
+void EditJournal::abortRebase() {
+    if (!pending_) return;
+    pending_->file.close();
+    pending_->file.remove();
+    pending_.reset();
+}
+
+void EditJournal::discard() {
+    abortRebase();
+    if (!file_) return;
+    file_->file.close();
+    file_->file.remove();
+    file_.reset();
+}
+
+// 每条记录写入后立即 flush 到操作系统：进程崩溃时已记录的编辑不会丢失
+void EditJournal::append(const QJsonObject& record) {
+    if (!file_ && !pending_) return;
+    const QByteArray line = QJsonDocument(record).toJson(QJsonDocument::Compact) + '\n';
+    for (Target* t : {file_.get(), pending_.get()}) {
+        if (!t) continue;
+        t->file.write(line);
+        t->file.flush();
+    }
+}
+
+void EditJournal::recordAdd(quint64 id, const QJsonObject& shape, int at) {
+    QJsonObject rec{{"op", "add"}, {"id", static_cast<qint64>(id)}, {"shape", shape}};
+    if (at >= 0) rec["at"] = at;
+    append(rec);
+}
+
+void EditJournal::recordRemove(quint64 id) {
+    append({{"op", "remove"}, {"id", static_cast<qint64>(id)}});
+}
+
+void EditJournal::recordTransform(quint64 id, const QPointF& pos, double rotation) {
+    append({{"op", "move"}, {"id", static_cast<qint64>(id)}, {"x", pos.x()}, {"y", pos.y()}, {"rot", rotation}});
+}
+
+void EditJournal::recordEdit(quint64 id, const QJsonObject& shape) {
+    append({{"op", "edit"}, {"id", static_cast<qint64>(id)}, {"shape", shape}});
+}
+
+void EditJournal::recordMoveVertex(quint64 id, int index, const QPointF& localPos) {
+    append({{"op", "vertex"}, {"id", static_cast<qint64>(id)}, {"i", index}, {"x", localPos.x()}, {"y", localPos.y()}});
+}
+
+void EditJournal::recordStyle(quint64 id, const QColor& color, double penWidth) {
+    append({{"op", "style"}, {"id", static_cast<qint64>(id)}, {"color", color.name(QColor::HexArgb)}, {"width", penWidth}});
+}
+
+void EditJournal::recordName(quint64 id, const QString& name) {
+    append({{"op", "name"}, {"id", static_cast<qint64>(id)}, {"name", name}});
+}
+
+bool EditJournal::Load(const QString& journalPath, Contents& out, QString* error) {
+    out = Contents();
+    QFile f(journalPath);
+    if (!f.open(QIODevice::ReadOnly)) {
+        if (error) *error = f.errorString();
+        return false;
+    }
+    const QJsonObject header = QJsonDocument::fromJson(f.readLine()).object();
+    if (header["journal"].toInt() != kJournalVersion) {
+        if (error) *error = QObject::tr("无法识别的编辑日志：%1").arg(journalPath);
+        return false;
+    }
+    out.basePath = header["base"].toString();
+    out.baseIds = decodeIds(header["ids"].toArray());
+
+    bool baseChecked = out.basePath.isEmpty();
+    while (!f.atEnd()) {
+        const QByteArray line = f.readLine();
+        QJsonParseError pe;
+        const QJsonObject rec = QJsonDocument::fromJson(line, &pe).object();
+        if (pe.error != QJsonParseError::NoError || !line.endsWith('\n')) {
+            // 崩溃时写了一半的末行：忽略；中间的坏行说明日志已损坏
+            if (f.atEnd()) break;
+            if (error) *error = QObject::tr("编辑日志已损坏（第 %1 字节）").arg(f.pos() - line.size());
+            return false;
+        }
+        if (rec["op"].toString() == QLatin1String("base")) {
+            const QJsonObject now = baseRecord(out.basePath);
+            baseChecked = rec["size"].toInteger() == now["size"].toInteger()
+                && rec["mtime"].toInteger() == now["mtime"].toInteger();
+            continue;
+        }
+        out.records.push_back(rec);
+    }
+    if (!baseChecked) {
+        if (error) *error = QObject::tr("文档 %1 在日志之后被修改或未保存完成，无法按日志恢复").arg(out.basePath);
+        return false;
+    }
+    return true;
+}
+
+bool EditJournal::Replay(DrawingScene* scene, const Contents& contents, QString* error) {
+    // 基准图形按文件顺序加入（静态层条目的次序，或场景中自下而上的次序）
+    const std::vector<ShapeItem*> base = scene->shapeItems();
+    if (base.size() != contents.baseIds.size()) {
+        if (error) *error = QObject::tr("编辑日志与基准文档的图形数量不一致");
+        return false;
+    }
+    std::unordered_map<quint64, ShapeItem*> items;
+    for (size_t i = 0; i < base.size(); ++i) {
+        base[i]->setShapeId(contents.baseIds[i]);
+        scene->registerShapeId(base[i]);
+        items[contents.baseIds[i]] = base[i];
+    }
+
+    EditJournal* const journal = scene->journal();
+    scene->setJournal(nullptr);
+    // 被修改的图形先提升回场景（与撤销命令一致）
+    auto find = [&](const QJsonObject& rec) -> ShapeItem* {
+        auto it = items.find(static_cast<quint64>(rec["id"].toInteger()));
+        if (it == items.end()) return nullptr;
+        if (auto* layer = it->second->staticLayer()) layer->promote(it->second);
+        return it->second;
+    };
+    // 效果与撤销命令相同：借用命令的 redo 执行
+    for (const auto& rec : contents.records) {
+        const QString op = rec["op"].toString();
+        if (op == QLatin1String("add")) {
+            auto s = Ser::FromJsonObject(rec["shape"].toObject());
+            if (!s) continue;
+            auto* item = new ShapeItem(std::move(s));
+            item->setShapeId(static_cast<quint64>(rec["id"].toInteger()));
+            if (rec.contains(QLatin1String("at"))) scene->insertShapeItem(item, rec["at"].toInt());
+            else scene->addItem(item);
+            items[item->shapeId()] = item;
+        } else if (op == QLatin1String("remove")) {
+            if (auto* item = find(rec)) {
+                items.erase(item->shapeId());
+                scene->removeItem(item);
+                delete item;
+            }
+        } else if (op == QLatin1String("move")) {
+            if (auto* item = find(rec)) {
+                UndoCmd::TransformShapeCommand(item, {}, 0.0, QPointF(rec["x"].toDouble(), rec["y"].toDouble()),
+                                               rec["rot"].toDouble()).redo();
+            }
+        } else if (op == QLatin1String("edit")) {
+            if (auto* item = find(rec)) UndoCmd::EditShapeJsonCommand(item, {}, rec["shape"].toObject()).redo();
+        } else if (op == QLatin1String("vertex")) {
+            if (auto* item = find(rec)) {
+                UndoCmd::MoveVertexCommand(item, rec["i"].toInt(), {}, QPointF(rec["x"].toDouble(), rec["y"].toDouble()))
+                    .redo();
+            }
+        } else if (op == QLatin1String("style")) {
+            if (auto* item = find(rec)) {
+                const QJsonObject style{{"color", rec["color"]}, {"pen", QJsonObject{{"width", rec["width"]}}}};
+                const quint32 index = StyleTable::instance().internJson(style, item->model()->styleIndex());
+                UndoCmd::SetStyleCommand(item, StyleTable::kDefault, index).redo();
+            }
+        } else if (op == QLatin1String("name")) {
+            if (auto* item = find(rec)) UndoCmd::RenameShapeCommand(item, {}, rec["name"].toString()).redo();
+        }
+    }
+    scene->setJournal(journal);
+    return true;
+}
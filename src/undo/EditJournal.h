@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QPointF>
+#include <QString>
+#include <memory>
+#include <vector>
+
+class QColor;
+class QFile;
+class DrawingScene;
+
+// 追加式编辑日志：撤销命令每次执行（含撤销/重做）的效果追加为一行紧凑 JSON 并立即写出，
+// 代价只与本次编辑的大小有关。日志以最近一次完整保存（基准文档）为起点：崩溃后打开基准文档、
+// 按图形编号回放日志即可恢复，随后在后台完整保存一次并换用新日志（压缩）。
+//
+// 第一行为头部 {"journal":1,"base":基准路径,"ids":[[首编号,个数],...]}，ids 为基准文档中
+// 各图形按文件顺序的编号；基准文件写好后追加 {"op":"base","size":..,"mtime":..} 供恢复时核对。
+// 其余每行一条记录：add/edit 携带图形 JSON（add 插回原堆叠位置时另带 at，即 shapeItems() 中的下标），
+// remove/move/vertex/style/name 只带编号与新值
+class EditJournal {
+public:
+    EditJournal();
+    ~EditJournal();
+
+    EditJournal(const EditJournal&) = delete;
+    EditJournal& operator=(const EditJournal&) = delete;
+
+    // 文档对应的日志：文档旁的 <文档>.fcadj；未命名文档放在应用数据目录
+    static QString PathFor(const QString& documentPath);
+    // 未命名文档压缩时的基准文件（应用数据目录中的 .fcadb）
+    static QString UntitledBasePath();
+
+    // 开始新日志（覆盖同名文件）；basePath 为空表示基准为空文档，否则其文件须已存在
+    bool start(const QString& basePath, const std::vector<quint64>& baseIds, QString* error = nullptr);
+    bool isOpen() const { return file_ != nullptr; }
+    QString path() const;
+
+    // 保存期间换基：新日志先写到 <日志>.new，与当前日志同时记录；
+    // 基准文件写好后 commitRebase 以其替换当前日志，保存失败或取消时 abortRebase 丢弃
+    bool beginRebase(const QString& basePath, const std::vector<quint64>& baseIds, QString* error = nullptr);
+    bool commitRebase(QString* error = nullptr);
+    void abortRebase();
+    // 正常关闭：删除日志文件
+    void discard();
+
+    // at < 0 表示放在最上层
+    void recordAdd(quint64 id, const QJsonObject& shape, int at = -1);
+    void recordRemove(quint64 id);
+    void recordTransform(quint64 id, const QPointF& pos, double rotation);
+    void recordEdit(quint64 id, const QJsonObject& shape);
+    void recordMoveVertex(quint64 id, int index, const QPointF& localPos);
+    // color 同 JSON 的 style.color（填充与画笔颜色）
+    void recordStyle(quint64 id, const QColor& color, double penWidth);
+    void recordName(quint64 id, const QString& name);
+
+    // 读出的日志：末尾写了一半的行（崩溃时）被忽略
+    struct Contents {
+        QString basePath;
+        std::vector<quint64> baseIds;
+        std::vector<QJsonObject> records;
+    };
+    // 读取并核对基准文件（大小与修改时间须与日志记录一致）
+    static bool Load(const QString& journalPath, Contents& out, QString* error = nullptr);
+    // 在已按文件顺序载入基准文档的场景上回放；回放期间不写日志
+    static bool Replay(DrawingScene* scene, const Contents& contents, QString* error = nullptr);
+
+private:
+    struct Target;
+    void append(const QJsonObject& record);
+
+    std::unique_ptr<Target> file_;
+    std::unique_ptr<Target> pending_;
+};
@@ -0,0 +1,112 @@
+// 基准：大文件加载（反序列化 + 创建 ShapeItem）与清场（scene->clear + ObjectPool::Trim）耗时；
+// 另测单线程流式解析，与 LoadFromFile 的并行解析对比
+// 运行：bench_bulk_load；图元数量可用环境变量 FAKECAD_BENCH_ITEMS 调整（默认 1000000）
+// 对比全局分配：以 FAKECAD_DISABLE_POOL=1 再运行一次
+#include <QtTest/QtTest>
+#include <QtWidgets/QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <thread>
+
+#include "core/ObjectPool.h"
+#include "core/Serialization.h"
+#include "ui/DrawingScene.h"
+#include "ui/ShapeItem.h"
+
+namespace {
+
+int benchItemCount() {
+    bool ok = false;
+    const int n = qEnvironmentVariableIntValue("FAKECAD_BENCH_ITEMS", &ok);
+    return (ok && n > 0) ? n : 1000000;
+}
+
+std::unique_ptr<Shape> makeShape(int i) {
+    const double x = (i % 1000) * 5.0;
+    const double y = (i / 1000) * 5.0;
+    switch (i % 7) {
+    case 0: return std::make_unique<LineSegment>(QPointF(x, y), QPointF(x + 4, y + 3));
+    case 1: return std::make_unique<Rectangle>(QRectF(x, y, 4, 3));
+    case 2: return std::make_unique<Circle>(QPointF(x, y), 2.0);
+    case 3: return std::make_unique<Triangle>(QPointF(x, y), QPointF(x + 4, y), QPointF(x + 2, y + 3));
+    case 4: return std::make_unique<Polygon>(QVector<QPointF>{{x, y}, {x + 4, y}, {x + 4, y + 3}, {x, y + 3}});
+    case 5: return std::make_unique<Polyline>(QVector<QPointF>{{x, y}, {x + 2, y + 3}, {x + 4, y}});
+    default: return std::make_unique<Ellipse>(QPointF(x, y), 2.0, 1.5);
+    }
+}
+
+} // namespace
+
+class BulkLoadBench : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void load_and_teardown();
+
+private:
+    QTemporaryDir dir_;
+    QString path_;
+    int count_ { 0 };
+};
+
+void BulkLoadBench::initTestCase() {
+    QVERIFY(dir_.isValid());
+    path_ = dir_.filePath(QStringLiteral("bulk.json"));
+    count_ = benchItemCount();
+    std::vector<std::unique_ptr<Shape>> owned;
+    std::vector<Shape*> shapes;
+    owned.reserve(count_);
+    shapes.reserve(count_);
+    for (int i = 0; i < count_; ++i) {
+        owned.push_back(makeShape(i));
+        shapes.push_back(owned.back().get());
+    }
+    QString err;
+    QVERIFY2(Ser::SaveToFile(path_, shapes, &err), qPrintable(err));
+}
+
+// 单次计时（一次加载即百万级分配，无需 QBENCHMARK 重复）；与 MainWindow::onOpen/closeDocument 的流程一致
+void BulkLoadBench::load_and_teardown() {
+    DrawingScene scene;
+    QElapsedTimer t;
+
+    t.start();
+    QString err;
+    {
+        QFile f(path_);
+        QVERIFY(f.open(QIODevice::ReadOnly));
+        auto streamed = Ser::ReadJson(f, &err);
+        QVERIFY2(err.isEmpty(), qPrintable(err));
+        QCOMPARE(int(streamed.size()), count_);
+    }
+    const qint64 streamMs = t.restart();
+
+    auto shapes = Ser::LoadFromFile(path_, &err);
+    const qint64 parseMs = t.restart();
+    QVERIFY2(err.isEmpty(), qPrintable(err));
+    QCOMPARE(int(shapes.size()), count_);
+
+    scene.addShapes(shapes);
+    const qint64 itemsMs = t.restart();
+
+    const auto loaded = ObjectPool::GetStats();
+    scene.clear();
+    const qint64 clearMs = t.restart();
+    const std::size_t trimmed = ObjectPool::Trim();
+    const qint64 trimMs = t.elapsed();
+
+    qInfo("pool %s, %d shapes, %u threads: deserialize %lld ms (streaming, 1 thread: %lld ms), create items %lld ms, "
+          "clear %lld ms, trim %lld ms",
+          ObjectPool::Enabled() ? "on" : "off", count_, std::thread::hardware_concurrency(),
+          static_cast<long long>(parseMs), static_cast<long long>(streamMs), static_cast<long long>(itemsMs),
+          static_cast<long long>(clearMs), static_cast<long long>(trimMs));
+    qInfo("pool live %zu objects / %zu KiB reserved after load, %zu KiB released by trim",
+          loaded.liveObjects, loaded.reservedBytes / 1024, trimmed / 1024);
+
+    QCOMPARE(ObjectPool::GetStats().liveObjects, std::size_t(0));
+    QCOMPARE(ObjectPool::GetStats().reservedBytes, std::size_t(0));
+}
+
+QTEST_MAIN(BulkLoadBench)
+#include "bench_bulk_load.moc"
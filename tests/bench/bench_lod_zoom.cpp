@@ -0,0 +1,84 @@
+// 基准：缩小视图下整帧渲染——细节层次（亚像素画点/跳过、小图形关抗锯齿）对比完整绘制
+// 运行：bench_lod_zoom [-iterations N]；图元数量可用环境变量 FAKECAD_BENCH_ITEMS 调整（默认 100000）
+#include <QtTest/QtTest>
+#include <QtWidgets/QApplication>
+#include <QImage>
+#include <QPainter>
+
+#include "ui/DrawingScene.h"
+#include "ui/ShapeItem.h"
+
+namespace {
+
+int benchItemCount() {
+    bool ok = false;
+    const int n = qEnvironmentVariableIntValue("FAKECAD_BENCH_ITEMS", &ok);
+    return (ok && n > 0) ? n : 100000;
+}
+
+std::unique_ptr<Shape> makeShape(int i) {
+    const double x = (i % 400) * 5.0;
+    const double y = (i / 400) * 5.0;
+    switch (i % 5) {
+    case 0: return std::make_unique<LineSegment>(QPointF(x, y), QPointF(x + 4, y + 3));
+    case 1: return std::make_unique<Rectangle>(QRectF(x, y, 4, 3));
+    case 2: return std::make_unique<Circle>(QPointF(x, y), 2.0);
+    case 3: return std::make_unique<Polygon>(QVector<QPointF>{{x, y}, {x + 4, y}, {x + 4, y + 3}, {x, y + 3}});
+    default: return std::make_unique<Ellipse>(QPointF(x, y), 2.0, 1.5);
+    }
+}
+
+} // namespace
+
+class LodZoomBench : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void zoomOut_data();
+    void zoomOut();
+
+private:
+    DrawingScene* scene_ { nullptr };
+};
+
+void LodZoomBench::initTestCase() {
+    scene_ = new DrawingScene();
+    scene_->setShowGrid(false);
+    const int n = benchItemCount();
+    for (int i = 0; i < n; ++i) scene_->addItem(new ShapeItem(makeShape(i)));
+    scene_->setSceneRect(scene_->itemsBoundingRect());
+}
+
+void LodZoomBench::cleanupTestCase() {
+    delete scene_;
+    scene_ = nullptr;
+}
+
+void LodZoomBench::zoomOut_data() {
+    QTest::addColumn<double>("pointSize");
+    QTest::addColumn<double>("aliasedSize");
+    QTest::addColumn<bool>("skipTiny");
+    QTest::newRow("full") << 0.0 << 0.0 << false;
+    QTest::newRow("aliased") << 0.0 << 3.0 << false;
+    QTest::newRow("points") << 1.0 << 3.0 << false;
+    QTest::newRow("skip") << 1.0 << 3.0 << true;
+}
+
+// 整个场景缩放进 512x512 的图像：每个图形约 1 像素
+void LodZoomBench::zoomOut() {
+    QFETCH(double, pointSize);
+    QFETCH(double, aliasedSize);
+    QFETCH(bool, skipTiny);
+    scene_->setLodSettings({pointSize, aliasedSize, skipTiny});
+    QImage img(512, 512, QImage::Format_ARGB32_Premultiplied);
+    QBENCHMARK {
+        img.fill(Qt::white);
+        QPainter p(&img);
+        scene_->render(&p);
+    }
+}
+
+QTEST_MAIN(LodZoomBench)
+#include "bench_lod_zoom.moc"
@@ -0,0 +1,228 @@
+// 基准：ShapeItem 绘制/包围盒的类型标签分派 vs 旧的 dynamic_cast 链
+// 运行：bench_paint_dispatch [-iterations N]；图元数量可用环境变量 FAKECAD_BENCH_ITEMS 调整（默认 100000）
+#include <QtTest/QtTest>
+#include <QtWidgets/QApplication>
+#include <QImage>
+#include <QPainter>
+#include <cmath>
+
+#include "ui/DrawingScene.h"
+#include "ui/ShapeItem.h"
+#include "ui/StaticLayer.h"
+
+namespace {
+
+int benchItemCount() {
+    bool ok = false;
+    const int n = qEnvironmentVariableIntValue("FAKECAD_BENCH_ITEMS", &ok);
+    return (ok && n > 0) ? n : 100000;
+}
+
+std::unique_ptr<Shape> makeShape(int i) {
+    const double x = (i % 400) * 5.0;
+    const double y = (i / 400) * 5.0;
+    switch (i % 7) {
+    case 0: return std::make_unique<LineSegment>(QPointF(x, y), QPointF(x + 4, y + 3));
+    case 1: return std::make_unique<Rectangle>(QRectF(x, y, 4, 3));
+    case 2: return std::make_unique<Circle>(QPointF(x, y), 2.0);
+    case 3: return std::make_unique<Triangle>(QPointF(x, y), QPointF(x + 4, y), QPointF(x + 2, y + 3));
+    case 4: return std::make_unique<Polygon>(QVector<QPointF>{{x, y}, {x + 4, y}, {x + 4, y + 3}, {x, y + 3}});
+    case 5: return std::make_unique<Polyline>(QVector<QPointF>{{x, y}, {x + 2, y + 3}, {x + 4, y}});
+    default: return std::make_unique<Ellipse>(QPointF(x, y), 2.0, 1.5);
+    }
+}
+
+// 旧实现（基线）：每次调用沿 dynamic_cast 链逐个尝试
+QRectF ladderBoundingRect(const Shape* s) {
+    if (auto* ls = dynamic_cast<const LineSegment*>(s)) return QRectF(ls->p1(), ls->p2()).normalized().adjusted(-1, -1, 1, 1);
+    if (auto* rc = dynamic_cast<const Rectangle*>(s)) return rc->rect().normalized().adjusted(-1, -1, 1, 1);
+    if (auto* cc = dynamic_cast<const Circle*>(s)) {
+        const auto r = cc->radius();
+        return QRectF(cc->center().x() - r, cc->center().y() - r, 2 * r, 2 * r).adjusted(-1, -1, 1, 1);
+    }
+    if (auto* tr = dynamic_cast<const Triangle*>(s)) {
+        QPolygonF poly; poly << tr->p1() << tr->p2() << tr->p3();
+        return poly.boundingRect().adjusted(-1, -1, 1, 1);
+    }
+    if (auto* pg = dynamic_cast<const Polygon*>(s)) return QPolygonF(pg->points()).boundingRect().adjusted(-1, -1, 1, 1);
+    if (auto* pl = dynamic_cast<const Polyline*>(s)) return QPolygonF(pl->points()).boundingRect().adjusted(-1, -1, 1, 1);
+    if (auto* el = dynamic_cast<const Ellipse*>(s)) {
+        return QRectF(el->center().x()-el->rx(), el->center().y()-el->ry(), el->rx()*2, el->ry()*2).adjusted(-1,-1,1,1);
+    }
+    return {};
+}
+
+void ladderPaint(QPainter* painter, const Shape* s) {
+    painter->setRenderHint(QPainter::Antialiasing, true);
+    painter->setPen(s->pen());
+    painter->setBrush(Qt::NoBrush);
+    if (auto* ls = dynamic_cast<const LineSegment*>(s)) { painter->drawLine(ls->p1(), ls->p2()); return; }
+    if (auto* rc = dynamic_cast<const Rectangle*>(s)) { painter->drawRect(rc->rect()); return; }
+    if (auto* cc = dynamic_cast<const Circle*>(s)) { painter->drawEllipse(cc->center(), cc->radius(), cc->radius()); return; }
+    if (auto* tr = dynamic_cast<const Triangle*>(s)) {
+        QPolygonF poly; poly << tr->p1() << tr->p2() << tr->p3();
+        painter->drawPolygon(poly);
+        return;
+    }
+    if (auto* pg = dynamic_cast<const Polygon*>(s)) { painter->drawPolygon(QPolygonF(pg->points())); return; }
+    if (auto* pl = dynamic_cast<const Polyline*>(s)) { painter->drawPolyline(QPolygonF(pl->points())); return; }
+    if (auto* el = dynamic_cast<const Ellipse*>(s)) { painter->drawEllipse(el->center(), el->rx(), el->ry()); return; }
+}
+
+} // namespace
+
+class PaintDispatchBench : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void boundingRect_ladder();
+    void boundingRect_dispatch();
+    void paint_ladder();
+    void paint_dispatch();
+    void frame_render();
+    void frame_render_static_layer();
+    void frame_pan_static_layer_data();
+    void frame_pan_static_layer();
+    void frame_zoom_static_layer_data();
+    void frame_zoom_static_layer();
+
+private:
+    std::vector<ShapeItem*> items_;
+    DrawingScene* scene_ { nullptr };
+    // 同一组图形经 addShapes 停放在静态层中
+    DrawingScene* staticScene_ { nullptr };
+};
+
+void PaintDispatchBench::initTestCase() {
+    scene_ = new DrawingScene();
+    const int n = benchItemCount();
+    items_.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        auto* it = new ShapeItem(makeShape(i));
+        scene_->addItem(it);
+        items_.push_back(it);
+    }
+    scene_->setSceneRect(scene_->itemsBoundingRect());
+
+    staticScene_ = new DrawingScene();
+    std::vector<std::unique_ptr<Shape>> shapes;
+    shapes.reserve(n);
+    for (int i = 0; i < n; ++i) shapes.push_back(makeShape(i));
+    staticScene_->addShapes(shapes);
+    staticScene_->setSceneRect(scene_->sceneRect());
+}
+
+void PaintDispatchBench::cleanupTestCase() {
+    delete scene_;
+    scene_ = nullptr;
+    delete staticScene_;
+    staticScene_ = nullptr;
+    items_.clear();
+}
+
+void PaintDispatchBench::boundingRect_ladder() {
+    qreal acc = 0;
+    QBENCHMARK {
+        for (auto* it : items_) acc += ladderBoundingRect(it->model()).width();
+    }
+    QVERIFY(acc > 0);
+}
+
+void PaintDispatchBench::boundingRect_dispatch() {
+    qreal acc = 0;
+    QBENCHMARK {
+        for (auto* it : items_) acc += it->boundingRect().width();
+    }
+    QVERIFY(acc > 0);
+}
+
+// 仅对比单帧内逐项 paint 的开销（不经过场景索引与裁剪）
+void PaintDispatchBench::paint_ladder() {
+    QImage img(1024, 1024, QImage::Format_ARGB32_Premultiplied);
+    QPainter p(&img);
+    QBENCHMARK {
+        for (auto* it : items_) ladderPaint(&p, it->model());
+    }
+}
+
+void PaintDispatchBench::paint_dispatch() {
+    QImage img(1024, 1024, QImage::Format_ARGB32_Premultiplied);
+    QPainter p(&img);
+    QBENCHMARK {
+        for (auto* it : items_) it->paint(&p, nullptr, nullptr);
+    }
+}
+
+// 整帧渲染（含场景遍历），作为端到端参考
+void PaintDispatchBench::frame_render() {
+    QImage img(1024, 1024, QImage::Format_ARGB32_Premultiplied);
+    QBENCHMARK {
+        img.fill(Qt::white);
+        QPainter p(&img);
+        scene_->render(&p);
+    }
+}
+
+// 同一帧由静态层按样式批量绘制
+void PaintDispatchBench::frame_render_static_layer() {
+    QImage img(1024, 1024, QImage::Format_ARGB32_Premultiplied);
+    QBENCHMARK {
+        img.fill(Qt::white);
+        QPainter p(&img);
+        staticScene_->render(&p);
+    }
+}
+
+void PaintDispatchBench::frame_pan_static_layer_data() {
+    QTest::addColumn<bool>("tiles");
+    QTest::newRow("direct") << false;
+    QTest::newRow("tiles") << true;
+}
+
+// 平移：每帧视口移动 16 像素（来回），瓦片缓存命中时只贴图
+void PaintDispatchBench::frame_pan_static_layer() {
+    QFETCH(bool, tiles);
+    auto* layer = staticScene_->staticLayer();
+    QVERIFY(layer);
+    layer->setTileCacheEnabled(tiles);
+    const QRectF scene = staticScene_->sceneRect();
+    QImage img(1024, 1024, QImage::Format_ARGB32_Premultiplied);
+    int frame = 0;
+    QBENCHMARK {
+        const qreal dx = (frame++ % 16) * 16.0;
+        img.fill(Qt::white);
+        QPainter p(&img);
+        staticScene_->render(&p, QRectF(0, 0, 1024, 1024), QRectF(scene.left() + dx, scene.top(), 1024, 1024));
+    }
+    layer->setTileCacheEnabled(true);
+}
+
+void PaintDispatchBench::frame_zoom_static_layer_data() {
+    QTest::addColumn<bool>("tiles");
+    QTest::newRow("direct") << false;
+    QTest::newRow("tiles") << true;
+}
+
+// 连续缩放：每帧缩放比例都不同（滚轮缩放的步长），瓦片缓存不应比直接绘制更慢
+void PaintDispatchBench::frame_zoom_static_layer() {
+    QFETCH(bool, tiles);
+    auto* layer = staticScene_->staticLayer();
+    QVERIFY(layer);
+    layer->setTileCacheEnabled(tiles);
+    const QRectF scene = staticScene_->sceneRect();
+    QImage img(1024, 1024, QImage::Format_ARGB32_Premultiplied);
+    int frame = 0;
+    QBENCHMARK {
+        const qreal zoom = std::pow(1.05, frame++ % 32);
+        img.fill(Qt::white);
+        QPainter p(&img);
+        staticScene_->render(&p, QRectF(0, 0, 1024, 1024),
+                             QRectF(scene.center() - QPointF(512, 512) / zoom, QSizeF(1024, 1024) / zoom));
+    }
+    layer->setTileCacheEnabled(true);
+}
+
+QTEST_MAIN(PaintDispatchBench)
+#include "bench_paint_dispatch.moc"
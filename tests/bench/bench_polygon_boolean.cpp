@@ -0,0 +1,76 @@
+// 基准：PolygonBoolean 扫描线布尔运算（大规模随机操作数）
+// 运行：bench_polygon_boolean [-iterations N]；每个操作数的顶点数可用环境变量 FAKECAD_BENCH_ITEMS 调整（默认 100000）
+#include <QtTest/QtTest>
+#include <cmath>
+#include <random>
+
+#include "core/PolygonBoolean.h"
+
+namespace {
+
+int benchVertexCount() {
+    bool ok = false;
+    const int n = qEnvironmentVariableIntValue("FAKECAD_BENCH_ITEMS", &ok);
+    return (ok && n > 0) ? n : 100000;
+}
+
+// 带低频起伏与随机扰动的星形环：边界相互交错，交点数随顶点数增长
+PolygonBoolean::Ring randomRing(std::mt19937& rng, const QPointF& c, double r0, int n) {
+    std::uniform_real_distribution<double> jitter(-0.02, 0.02);
+    std::uniform_real_distribution<double> phase(0.0, 2.0 * M_PI);
+    const double ph = phase(rng);
+    PolygonBoolean::Ring ring;
+    ring.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        const double t = 2.0 * M_PI * i / n;
+        const double r = r0 * (1.0 + 0.15 * std::sin(9.0 * t + ph) + jitter(rng));
+        ring.append(QPointF(c.x() + r * std::cos(t), c.y() + r * std::sin(t)));
+    }
+    return ring;
+}
+
+} // namespace
+
+class PolygonBooleanBench : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void union_large();
+    void intersection_large();
+    void difference_large();
+    void xor_large();
+
+private:
+    void run(PolygonBoolean::Op op);
+
+    PolygonBoolean::Region subject_;
+    PolygonBoolean::Region clipping_;
+};
+
+void PolygonBooleanBench::initTestCase() {
+    std::mt19937 rng(2024);
+    const int n = benchVertexCount();
+    subject_ = {randomRing(rng, QPointF(0, 0), 1000.0, n)};
+    clipping_ = {randomRing(rng, QPointF(400, 150), 900.0, n)};
+    qInfo("PolygonBoolean operands: %d vertices each", n);
+}
+
+void PolygonBooleanBench::run(PolygonBoolean::Op op) {
+    std::vector<PolygonBoolean::ResultRing> result;
+    QBENCHMARK {
+        result = PolygonBoolean::Compute(subject_, clipping_, op);
+    }
+    qsizetype vertices = 0;
+    for (const auto& r : result) vertices += r.points.size();
+    qInfo("%zu rings, %lld vertices", result.size(), static_cast<long long>(vertices));
+    QVERIFY(!result.empty());
+}
+
+void PolygonBooleanBench::union_large() { run(PolygonBoolean::Op::Union); }
+void PolygonBooleanBench::intersection_large() { run(PolygonBoolean::Op::Intersection); }
+void PolygonBooleanBench::difference_large() { run(PolygonBoolean::Op::Difference); }
+void PolygonBooleanBench::xor_large() { run(PolygonBoolean::Op::Xor); }
+
+QTEST_APPLESS_MAIN(PolygonBooleanBench)
+#include "bench_polygon_boolean.moc"
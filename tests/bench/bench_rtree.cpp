@@ -0,0 +1,123 @@
+// 基准：核心 R 树（RTree）与 QGraphicsScene BSP 索引的矩形范围查询
+// 运行：bench_rtree [-iterations N]；图形数量可用环境变量 FAKECAD_BENCH_ITEMS 调整（默认 1000000）
+#include <QtTest/QtTest>
+#include <QtWidgets/QApplication>
+#include <QElapsedTimer>
+
+#include "core/RTree.h"
+#include "ui/DrawingScene.h"
+#include "ui/ShapeItem.h"
+
+namespace {
+
+int benchItemCount() {
+    bool ok = false;
+    const int n = qEnvironmentVariableIntValue("FAKECAD_BENCH_ITEMS", &ok);
+    return (ok && n > 0) ? n : 1000000;
+}
+
+std::unique_ptr<Shape> makeShape(int i) {
+    const double x = (i % 1000) * 5.0;
+    const double y = (i / 1000) * 5.0;
+    switch (i % 4) {
+    case 0: return std::make_unique<LineSegment>(QPointF(x, y), QPointF(x + 4, y + 3));
+    case 1: return std::make_unique<Rectangle>(QRectF(x, y, 4, 3));
+    case 2: return std::make_unique<Circle>(QPointF(x, y), 2.0);
+    default: return std::make_unique<Ellipse>(QPointF(x, y), 2.0, 1.5);
+    }
+}
+
+// 固定的一组查询窗口（约 40x40 个图形大小），两种索引使用相同输入
+QVector<QRectF> queryRects(const QRectF& world) {
+    QVector<QRectF> rects;
+    for (int i = 0; i < 256; ++i) {
+        const double fx = ((i * 7919) % 1000) / 1000.0, fy = ((i * 104729) % 1000) / 1000.0;
+        rects.append(QRectF(world.left() + fx * world.width(), world.top() + fy * world.height(), 200, 200));
+    }
+    return rects;
+}
+
+} // namespace
+
+class RTreeBench : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void build_rtree();
+    void query_scene();
+    void query_rtree();
+    void nearest_rtree();
+
+private:
+    DrawingScene* scene_ { nullptr };
+    std::vector<Shape*> shapes_;
+    RTree tree_;
+    QVector<QRectF> rects_;
+};
+
+void RTreeBench::initTestCase() {
+    scene_ = new DrawingScene();
+    const int n = benchItemCount();
+    shapes_.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        auto* it = new ShapeItem(makeShape(i));
+        scene_->addItem(it);
+        shapes_.push_back(it->model());
+    }
+    scene_->setSceneRect(scene_->itemsBoundingRect());
+    // 触发场景 BSP 索引的首次构建，避免计入首次查询
+    (void)scene_->items(QRectF(0, 0, 1, 1));
+    QElapsedTimer t;
+    t.start();
+    tree_.bulkLoad(shapes_);
+    qInfo("RTree bulk load of %d shapes: %lld ms, height %d", n, static_cast<long long>(t.elapsed()), tree_.height());
+    rects_ = queryRects(scene_->sceneRect());
+}
+
+void RTreeBench::cleanupTestCase() {
+    tree_.clear();
+    shapes_.clear();
+    delete scene_;
+    scene_ = nullptr;
+}
+
+void RTreeBench::build_rtree() {
+    QBENCHMARK {
+        RTree t;
+        t.bulkLoad(shapes_);
+    }
+}
+
+void RTreeBench::query_scene() {
+    qsizetype hits = 0;
+    QBENCHMARK {
+        for (const auto& r : rects_) hits += scene_->items(r, Qt::IntersectsItemBoundingRect).size();
+    }
+    QVERIFY(hits > 0);
+}
+
+void RTreeBench::query_rtree() {
+    qsizetype hits = 0;
+    std::vector<Shape*> out;
+    QBENCHMARK {
+        for (const auto& r : rects_) {
+            out.clear();
+            tree_.query(r, out);
+            hits += static_cast<qsizetype>(out.size());
+        }
+    }
+    QVERIFY(hits > 0);
+}
+
+void RTreeBench::nearest_rtree() {
+    qsizetype found = 0;
+    QBENCHMARK {
+        for (const auto& r : rects_) found += static_cast<qsizetype>(tree_.nearest(r.center(), 16).size());
+    }
+    QVERIFY(found > 0);
+}
+
+QTEST_MAIN(RTreeBench)
+#include "bench_rtree.moc"
@@ -5,11 +5,19 @@
 #include <QtCore/QTemporaryDir>
 #include <QtCore/QFileInfo>
 #include <QtCore/QDir>
+#include <QtCore/QBuffer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+
+#include <algorithm>
+#include <cstring>
 
 #include "core/Serialization.h"
+#include "core/BinaryFormat.h"
 #include "core/shapes/LineSegment.h"
 #include "core/shapes/Rectangle.h"
 #include "core/shapes/Circle.h"
+#include "core/ShapeRegistry.h"
 
 static int countType(const std::vector<std::unique_ptr<Shape>>& v, const QString& t) {
     int c = 0; for (auto& s : v) if (s && s->typeName() == t) ++c; return c;
@@ -30,6 +38,61 @@ TEST_CASE("Serialize/Deserialize roundtrip") {
     REQUIRE(countType(out, "Circle") == 1);
 }
 
+TEST_CASE("Serialize from ShapeStore matches shapes") {
+    LineSegment ls({0,0},{1,1}); ls.setName("A");
+    Rectangle rc(QRectF(0,0,10,20)); rc.MoveTo(3, 4);
+    Circle cc(QPointF(5,5), 3.0); cc.setRotationDegrees(45.0);
+    // 图形列表直接写出（不建快照）：顶点与样式表下标须与快照一致
+    Polygon pg({QPointF(0,0), QPointF(2,0), QPointF(1,3)}); pg.setColor(Qt::red);
+    Polyline pl({QPointF(0,0), QPointF(3.25,4)}); pl.setPen(QPen(Qt::blue, 2.5));
+    Polyline pl2({QPointF(1,1), QPointF(2,2)}); pl2.setPen(QPen(Qt::green, 2.5)); // 只差描边颜色：同一项
+    std::vector<Shape*> in { &ls, &rc, &pg, &cc, &pl, &pl2 };
+
+    const auto store = ShapeStore::FromShapes(in);
+    REQUIRE(Ser::Serialize(store).toJson() == Ser::Serialize(in).toJson());
+    QBuffer a, b;
+    REQUIRE(a.open(QIODevice::WriteOnly));
+    REQUIRE(b.open(QIODevice::WriteOnly));
+    REQUIRE(Ser::WriteJson(a, store));
+    REQUIRE(Ser::WriteJson(b, in));
+    REQUIRE(a.data() == b.data());
+}
+
+TEST_CASE("JSON version 2 uses flat points and a shared style table") {
+    Polygon pg({QPointF(0,0), QPointF(2,0.5), QPointF(1,3)}); pg.setName("P");
+    Polyline pl({QPointF(-1,-2), QPointF(3,4)}); pl.setColor(QColor(10, 20, 30));
+    Circle cc(QPointF(5,5), 3.0);
+    Rectangle rc(QRectF(0,0,10,20)); rc.setColor(QColor(10, 20, 30));
+    std::vector<Shape*> in { &pg, &pl, &cc, &rc };
+
+    const QJsonObject root = Ser::Serialize(in).object();
+    REQUIRE(root["version"].toInt() == 2);
+    const QJsonArray styles = root["styles"].toArray();
+    REQUIRE(styles.size() == 2);
+    const QJsonArray shapes = root["shapes"].toArray();
+    REQUIRE(shapes[0].toObject()["style"].toInt() == shapes[2].toObject()["style"].toInt());
+    REQUIRE(shapes[1].toObject()["style"].toInt() == shapes[3].toObject()["style"].toInt());
+    REQUIRE(styles[shapes[1].toObject()["style"].toInt()].toObject() == pl.ToJson()["style"].toObject());
+    REQUIRE(shapes[0].toObject()["geom"].toObject()["points"].toArray() == QJsonArray({0.0, 0.0, 2.0, 0.5, 1.0, 3.0}));
+
+    // 两条读取路径都还原出与原图形相同的对象
+    const QByteArray text = Ser::Serialize(in).toJson(QJsonDocument::Compact);
+    REQUIRE(toJsonArray(Ser::Deserialize(QJsonDocument::fromJson(text))) == toJsonArray(in));
+    QBuffer buf;
+    buf.setData(text);
+    REQUIRE(buf.open(QIODevice::ReadOnly));
+    QString err;
+    REQUIRE(toJsonArray(Ser::ReadJson(buf, &err)) == toJsonArray(in));
+    REQUIRE(err.isEmpty());
+    REQUIRE(toJsonArray(Ser::ParseJson(text.constData(), text.size(), &err, {}, 2)) == toJsonArray(in));
+
+    // 版本 1 文档照常读取，且比版本 2 大
+    const QByteArray v1 = QJsonDocument(QJsonObject{{"version", 1}, {"shapes", toJsonArray(in)}}).toJson(QJsonDocument::Compact);
+    REQUIRE(toJsonArray(Ser::Deserialize(QJsonDocument::fromJson(v1))) == toJsonArray(in));
+    REQUIRE(toJsonArray(Ser::ParseJson(v1.constData(), v1.size(), &err, {}, 2)) == toJsonArray(in));
+    REQUIRE(v1.size() > text.size());
+}
+
 TEST_CASE("SaveToFile/LoadFromFile") {
     QTemporaryDir tmp;
     REQUIRE(tmp.isValid());
@@ -50,3 +113,330 @@ TEST_CASE("SaveToFile/LoadFromFile") {
     REQUIRE(countType(out, "LineSegment") == 1);
     REQUIRE(countType(out, "Rectangle") == 1);
 }
+
+TEST_CASE("Streaming JSON writer matches QJsonDocument output") {
+    LineSegment ls({0,0},{1e6,-2.5}); ls.setName(QStringLiteral("引号\"反斜杠\\换行\n\t\x01 😀"));
+    Rectangle rc(QRectF(1,2,10,20)); rc.MoveTo(3, 4); rc.setRotationDegrees(30.0);
+    Circle cc(QPointF(0.1,1e-7), 3.0);
+    Polygon pg({QPointF(0,0), QPointF(2,0), QPointF(1,3)});
+    Polyline pl({QPointF(0,0), QPointF(3.25,4), QPointF(123456789,4)});
+    Ellipse el(QPointF(1,1), 3.0, 4.0); el.setName(QString(QChar(0xd800)) + "x"); // 孤立代理项
+    QVector<QPointF> many;
+    for (int i = 0; i < 5000; ++i) many.append(QPointF(i * 0.37, -i)); // 超过写缓冲，跨多次写出
+    Polyline big(many);
+    std::vector<Shape*> in { &ls, nullptr, &rc, &cc, &pg, &pl, &el, &big };
+
+    for (auto format : {QJsonDocument::Indented, QJsonDocument::Compact}) {
+        QBuffer buf;
+        REQUIRE(buf.open(QIODevice::WriteOnly));
+        REQUIRE(Ser::WriteJson(buf, in, format));
+        REQUIRE(buf.data() == Ser::Serialize(in).toJson(format));
+
+        QBuffer empty;
+        REQUIRE(empty.open(QIODevice::WriteOnly));
+        REQUIRE(Ser::WriteJson(empty, {}, format));
+        REQUIRE(empty.data() == Ser::Serialize(std::vector<Shape*>{}).toJson(format));
+    }
+
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    const QString path = tmp.filePath("s.json");
+    REQUIRE(Ser::SaveToFile(path, in));
+    QFile f(path);
+    REQUIRE(f.open(QIODevice::ReadOnly));
+    REQUIRE(f.readAll() == Ser::Serialize(in).toJson(QJsonDocument::Indented));
+}
+
+static QJsonArray toJsonArray(const std::vector<std::unique_ptr<Shape>>& v) {
+    QJsonArray arr; for (auto& s : v) arr.append(s->ToJson()); return arr;
+}
+static QJsonArray toJsonArray(const std::vector<Shape*>& v) {
+    QJsonArray arr; for (auto* s : v) arr.append(s->ToJson()); return arr;
+}
+
+TEST_CASE("Streaming JSON loader matches Deserialize") {
+    // 各种空白、转义、代理对、非对象元素、未知类型、缺失分量与无关的根键
+    const QByteArray text = R"( { "meta" : {"a":[1,{"b":null}],"c":true} ,
+        "shapes":[
+          {"type":"Polygon","name":"pé😀\"\\\/\n","geom":{"points":[{"x":1,"y":2},{"y":-3.5e2},{"x":4,"y":5,"z":6},7]},
+           "style":{"color":"#ff102030","pen":{"width":2.5}},"transform":{"tx":10,"ty":-20,"rot":15}},
+          {"geom":{"cx":1,"cy":2,"r":3},"type":"Circle"},
+          42, "skip", {"type":"NoSuchShape","geom":{}},
+          {"type":"Polyline","geom":{"points":[]}},
+          {"type":"Ellipse","geom":{"cx":0,"cy":0,"rx":2,"ry":1,"points":[{"x":1,"y":1}]}},
+          {"type":"Rectangle","geom":{"x":1,"y":2,"w":3,"h":4}}
+        ],
+        "version":1 } )";
+    QBuffer buf;
+    buf.setData(text);
+    REQUIRE(buf.open(QIODevice::ReadOnly));
+    QString err;
+    const auto streamed = Ser::ReadJson(buf, &err);
+    REQUIRE(err.isEmpty());
+    const auto viaDom = Ser::Deserialize(QJsonDocument::fromJson(text));
+    REQUIRE(streamed.size() == 5);
+    REQUIRE(toJsonArray(streamed) == toJsonArray(viaDom));
+    REQUIRE(streamed[0]->name() == QStringLiteral("pé\U0001F600\"\\/\n"));
+
+    // 保存后的文件：与 DOM 路径逐图形一致，进度单调且最终等于文件大小
+    Polygon pg({QPointF(0,0), QPointF(2,0), QPointF(1,3)}); pg.setName(QStringLiteral("多边形"));
+    Circle cc(QPointF(0.1,1e-7), 3.0); cc.setRotationDegrees(30.0);
+    QVector<QPointF> many;
+    for (int i = 0; i < 20000; ++i) many.append(QPointF(i * 0.37, -i));
+    Polyline big(many);
+    std::vector<Shape*> in { &pg, &cc, &big };
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    const QString path = tmp.filePath("s.json");
+    REQUIRE(Ser::SaveToFile(path, in));
+    std::vector<qint64> seen;
+    qint64 totalSeen = -1;
+    const auto loaded = Ser::LoadFromFile(path, &err, [&](qint64 done, qint64 total) {
+        seen.push_back(done);
+        totalSeen = total;
+        return true;
+    });
+    REQUIRE(err.isEmpty());
+    REQUIRE(toJsonArray(loaded) == toJsonArray(in));
+    REQUIRE(seen.size() >= 2);
+    REQUIRE(std::is_sorted(seen.begin(), seen.end()));
+    REQUIRE(seen.back() == QFileInfo(path).size());
+    REQUIRE(totalSeen == QFileInfo(path).size());
+}
+
+TEST_CASE("Streaming JSON loader rejects malformed documents") {
+    const char* bad[] = {
+        "",
+        R"({"shapes":[{"type":"Circle","geom":{"cx":1,"cy":2,"r":3}})",   // 截断
+        R"({"shapes":[{"type":"Circle","geom":{"cx":1,}}]})",              // 多余逗号
+        R"({"shapes":[]} x)",                                               // 末尾多余内容
+        R"({"shapes":[{"name":"a\qb"}]})",                                  // 无效转义
+        R"({"shapes":[{"geom":{"cx":1-}}]})",                               // 无效数字
+    };
+    for (const char* t : bad) {
+        QBuffer buf;
+        buf.setData(QByteArray(t));
+        REQUIRE(buf.open(QIODevice::ReadOnly));
+        QString err;
+        REQUIRE(Ser::ReadJson(buf, &err).empty());
+        REQUIRE(!err.isEmpty());
+    }
+    // 非对象的合法文档：结果为空但不报错
+    QBuffer arr;
+    arr.setData(QByteArray("[1, 2]"));
+    REQUIRE(arr.open(QIODevice::ReadOnly));
+    QString err;
+    REQUIRE(Ser::ReadJson(arr, &err).empty());
+    REQUIRE(err.isEmpty());
+}
+
+TEST_CASE("Parallel JSON parse keeps document order and matches streaming loader") {
+    std::vector<std::unique_ptr<Shape>> owned;
+    std::vector<Shape*> in;
+    for (int i = 0; i < 3000; ++i) {
+        const double x = i * 1.5, y = -i * 0.25;
+        switch (i % 4) {
+        case 0: owned.push_back(std::make_unique<Circle>(QPointF(x, y), 1.0 + i)); break;
+        case 1: owned.push_back(std::make_unique<Polygon>(QVector<QPointF>{{x, y}, {x + 1, y}, {x, y + 1}})); break;
+        case 2: owned.push_back(std::make_unique<Rectangle>(QRectF(x, y, 2, 3))); break;
+        default: owned.push_back(std::make_unique<Polyline>(QVector<QPointF>{{x, y}, {x + 2, y + 2}})); break;
+        }
+        owned.back()->setName(QStringLiteral("s[%1]{\"},").arg(i)); // 名称中的括号与逗号不影响切段
+        in.push_back(owned.back().get());
+    }
+    const QJsonArray expected = toJsonArray(in);
+
+    for (auto format : {QJsonDocument::Indented, QJsonDocument::Compact}) {
+        QBuffer buf;
+        REQUIRE(buf.open(QIODevice::WriteOnly));
+        REQUIRE(Ser::WriteJson(buf, in, format));
+        const QByteArray text = buf.data();
+        for (int threads : {1, 3, 8}) {
+            QString err;
+            qint64 last = 0;
+            bool monotonic = true;
+            const auto out = Ser::ParseJson(text.constData(), text.size(), &err, [&](qint64 done, qint64) {
+                monotonic = monotonic && done >= last;
+                last = done;
+                return true;
+            }, threads);
+            REQUIRE(err.isEmpty());
+            REQUIRE(monotonic);
+            REQUIRE(last == text.size());
+            REQUIRE(toJsonArray(out) == expected);
+        }
+    }
+
+    // 错误：与流式读取报告相同的位置；末尾多余逗号同样被拒绝
+    QBuffer buf;
+    REQUIRE(buf.open(QIODevice::WriteOnly));
+    REQUIRE(Ser::WriteJson(buf, in, QJsonDocument::Compact));
+    QByteArray broken = buf.data();
+    const qsizetype mid = broken.indexOf("\"r\":", broken.size() / 2);
+    REQUIRE(mid > 0);
+    broken.replace(mid + 4, 1, "-x");
+    QString parErr, seqErr;
+    REQUIRE(Ser::ParseJson(broken.constData(), broken.size(), &parErr, {}, 4).empty());
+    QBuffer seq;
+    seq.setData(broken);
+    REQUIRE(seq.open(QIODevice::ReadOnly));
+    REQUIRE(Ser::ReadJson(seq, &seqErr).empty());
+    REQUIRE(!parErr.isEmpty());
+    REQUIRE(parErr == seqErr);
+
+    QByteArray trailing = buf.data();
+    trailing.insert(trailing.lastIndexOf(']'), ',');
+    QString err;
+    REQUIRE(Ser::ParseJson(trailing.constData(), trailing.size(), &err, {}, 4).empty());
+    REQUIRE(!err.isEmpty());
+}
+
+TEST_CASE("Progress callback cancels load and save without touching the old file") {
+    std::vector<std::unique_ptr<Shape>> owned;
+    std::vector<Shape*> in;
+    for (int i = 0; i < 20000; ++i) {
+        owned.push_back(std::make_unique<Circle>(QPointF(i, -i), 1.0 + i));
+        in.push_back(owned.back().get());
+    }
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    for (const QString name : {QStringLiteral("c.json"), QStringLiteral("c.fcadb")}) {
+        const QString path = tmp.filePath(name);
+        REQUIRE(Ser::SaveToFile(path, in));
+        const qint64 size = QFileInfo(path).size();
+        QString err;
+        int calls = 0;
+        auto cancelSecond = [&](qint64, qint64) { return ++calls < 2; };
+        REQUIRE(Ser::LoadFromFile(path, &err, cancelSecond).empty());
+        REQUIRE(!err.isEmpty());
+        REQUIRE(calls == 2); // 取消后不再回调
+
+        // 取消保存：原文件不变
+        std::vector<Shape*> head(in.begin(), in.begin() + 10);
+        err.clear();
+        REQUIRE(!Ser::SaveToFile(path, ShapeStore::FromShapes(head), &err, QJsonDocument::Indented,
+                                 [](qint64, qint64) { return false; }));
+        REQUIRE(!err.isEmpty());
+        REQUIRE(QFileInfo(path).size() == size);
+        err.clear();
+        REQUIRE(Ser::LoadFromFile(path, &err).size() == in.size());
+        REQUIRE(err.isEmpty());
+    }
+
+    // 并行解析：主线程取消后工作线程停止，结果为空
+    QBuffer buf;
+    REQUIRE(buf.open(QIODevice::WriteOnly));
+    REQUIRE(Ser::WriteJson(buf, in, QJsonDocument::Compact));
+    QString err;
+    REQUIRE(Ser::ParseJson(buf.data().constData(), buf.data().size(), &err, [](qint64, qint64) { return false; }, 4)
+                .empty());
+    REQUIRE(!err.isEmpty());
+}
+
+TEST_CASE("ShapeRegistry covers every kind with JSON codecs") {
+    Triangle tr({0,0},{4,0},{0,3});
+    Polygon pg({QPointF(0,0), QPointF(2,0), QPointF(1,3)});
+    Polyline pl({QPointF(0,0), QPointF(3,4), QPointF(6,4)});
+    Ellipse el(QPointF(1,1), 3.0, 4.0);
+    LineSegment ls({0,0},{1,1});
+    Rectangle rc(QRectF(1,2,10,20));
+    Circle cc(QPointF(5,5), 3.0);
+    std::vector<Shape*> in { &ls, &rc, &cc, &tr, &pg, &pl, &el };
+
+    const auto& reg = ShapeRegistry::instance();
+    REQUIRE(reg.find(QStringLiteral("NoSuchShape")) == nullptr);
+    for (auto* s : in) {
+        const auto* byKind = reg.find(s->kind());
+        REQUIRE(byKind);
+        REQUIRE(reg.find(s->typeName()) == byKind);
+        REQUIRE(byKind->typeName == s->typeName());
+        REQUIRE(byKind->toJson(*s) == s->ToJson());
+        auto back = byKind->fromJson(s->ToJson());
+        REQUIRE(back);
+        REQUIRE(back->kind() == s->kind());
+        REQUIRE(back->ToJson() == s->ToJson());
+    }
+}
+
+
+TEST_CASE("Binary .fcadb roundtrip keeps every field") {
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    const QString path = tmp.filePath("doc.fcadb");
+
+    LineSegment ls({0,0},{1,1}); ls.setName(QStringLiteral("线段 A"));
+    Rectangle rc(QRectF(1,2,10,20)); rc.MoveTo(3, 4);
+    Circle cc(QPointF(5,5), 3.0); cc.setRotationDegrees(45.0); cc.setColor(QColor(10, 20, 30, 200));
+    Triangle tr({0,0},{4,0},{0,3});
+    Polygon pg({QPointF(0,0), QPointF(2,0), QPointF(1,3)});
+    Polyline pl({QPointF(0,0), QPointF(3,4), QPointF(6,4), QPointF(9,1)});
+    Ellipse el(QPointF(1,1), 3.0, 4.0);
+    QPen wide(Qt::red); wide.setWidthF(2.5);
+    el.setPen(wide);
+    std::vector<Shape*> in { &ls, &rc, &cc, &tr, &pg, &pl, &el };
+
+    QString err;
+    REQUIRE(Ser::SaveToFile(path, in, &err)); // 按后缀选用二进制
+    REQUIRE(err.isEmpty());
+    QFile f(path);
+    REQUIRE(f.open(QIODevice::ReadOnly));
+    REQUIRE(BinaryFormat::IsBinary(f.read(8)));
+    f.close();
+
+    auto out = Ser::LoadFromFile(path, &err); // 按文件头识别
+    REQUIRE(err.isEmpty());
+    REQUIRE(out.size() == in.size());
+    for (size_t i = 0; i < in.size(); ++i) {
+        REQUIRE(out[i]->kind() == in[i]->kind());
+        REQUIRE(out[i]->ToJson() == in[i]->ToJson());
+    }
+
+    // 空文档
+    const QString emptyPath = tmp.filePath("empty.fcadb");
+    REQUIRE(Ser::SaveBinaryFile(emptyPath, {}, &err));
+    REQUIRE(Ser::LoadBinaryFile(emptyPath, &err).empty());
+    REQUIRE(err.isEmpty());
+}
+
+TEST_CASE("Binary .fcadb shares styles and rejects damaged files") {
+    std::vector<std::unique_ptr<Shape>> owned;
+    std::vector<Shape*> in;
+    for (int i = 0; i < 100; ++i) {
+        owned.push_back(std::make_unique<Polygon>(QVector<QPointF>{{0, 0}, {double(i), 0}, {0, double(i + 1)}}));
+        in.push_back(owned.back().get());
+    }
+    const auto store = ShapeStore::FromShapes(in);
+    REQUIRE(store.styles().size() == 1);
+
+    QByteArray bytes;
+    {
+        QBuffer buf(&bytes);
+        REQUIRE(buf.open(QIODevice::WriteOnly));
+        REQUIRE(store.writeBinary(buf));
+    }
+    ShapeStore back;
+    QString err;
+    REQUIRE(ShapeStore::ReadBinary(reinterpret_cast<const uchar*>(bytes.constData()), bytes.size(), back, &err));
+    REQUIRE(back.size() == store.size());
+    REQUIRE(back.vertices().size() == store.vertices().size());
+    REQUIRE(back.toJson(57) == store.toJson(57));
+
+    // 截断、错误魔数与越界区间都应报错而非越界访问
+    REQUIRE(!ShapeStore::ReadBinary(reinterpret_cast<const uchar*>(bytes.constData()), bytes.size() - 8, back, &err));
+    REQUIRE(!err.isEmpty());
+    QByteArray badMagic = bytes;
+    badMagic[0] = 'X';
+    REQUIRE(!ShapeStore::ReadBinary(reinterpret_cast<const uchar*>(badMagic.constData()), badMagic.size(), back, &err));
+    QByteArray badRange = bytes;
+    BinaryFormat::Header h;
+    std::memcpy(&h, badRange.constData(), sizeof(h));
+    for (quint32 i = 0; i < h.sectionCount; ++i) {
+        BinaryFormat::SectionEntry e;
+        std::memcpy(&e, badRange.constData() + sizeof(h) + i * sizeof(e), sizeof(e));
+        if (e.id == static_cast<quint32>(BinaryFormat::Section::PolygonRanges)) {
+            const qint64 huge = 1 << 30;
+            std::memcpy(badRange.data() + e.offset + sizeof(qint64), &huge, sizeof(huge));
+        }
+    }
+    REQUIRE(!ShapeStore::ReadBinary(reinterpret_cast<const uchar*>(badRange.constData()), badRange.size(), back, &err));
+}
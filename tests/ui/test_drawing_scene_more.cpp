@@ -1,14 +1,23 @@
 // UI：在 DrawingScene 中绘制圆与椭圆
 #include <QtTest/QtTest>
+#include <QImage>
+#include <QPainter>
 #include "ui/CanvasView.h"
 #include "ui/DrawingScene.h"
 #include "ui/ShapeItem.h"
+#include "ui/StaticLayer.h"
 
 class DrawingSceneMoreTest : public QObject {
     Q_OBJECT
 private slots:
     void draw_circle();
     void draw_ellipse();
+    void pick_uses_exact_geometry();
+    void tiny_shapes_follow_lod_settings();
+    void bulk_loaded_shapes_park_in_static_layer();
+    void grid_merges_dense_lines();
+    void static_layer_tiles_follow_edits();
+    void batched_insert_keeps_document_order();
 };
 
 void DrawingSceneMoreTest::draw_circle() {
@@ -45,5 +54,213 @@ void DrawingSceneMoreTest::draw_ellipse() {
     QVERIFY(after >= before + 1);
 }
 
+void DrawingSceneMoreTest::pick_uses_exact_geometry() {
+    DrawingScene scene; scene.setSceneRect(0,0,400,300);
+    auto* line = new ShapeItem(std::make_unique<LineSegment>(QPointF(0,0), QPointF(200,200)));
+    auto* circle = new ShapeItem(std::make_unique<Circle>(QPointF(300,100), 40.0));
+    scene.addItem(line);
+    scene.addItem(circle);
+
+    // 对角线包围盒内、远离线段的点不再命中
+    QVERIFY(!line->contains(QPointF(150,20)));
+    QVERIFY(scene.pickItems(QPointF(150,20), QTransform()).isEmpty());
+    // 容差内（3 像素）命中；放大 4 倍后同一场景距离超出容差
+    QVERIFY(line->contains(QPointF(101,99)));
+    QVERIFY(scene.pickItems(QPointF(102,100), QTransform()).contains(line));
+    QVERIFY(!scene.pickItems(QPointF(102,100), QTransform::fromScale(4,4)).contains(line));
+    // 圆内部与外侧容差带命中，包围盒角落不命中
+    QVERIFY(scene.pickItems(QPointF(300,100), QTransform()).contains(circle));
+    QVERIFY(scene.pickItems(QPointF(342,100), QTransform()).contains(circle));
+    QVERIFY(scene.pickItems(QPointF(337,137), QTransform()).isEmpty());
+    QVERIFY(!circle->shape().contains(QPointF(337,137)));
+}
+
+void DrawingSceneMoreTest::tiny_shapes_follow_lod_settings() {
+    DrawingScene scene;
+    auto* dot = new ShapeItem(std::make_unique<Circle>(QPointF(10,10), 0.1));
+    scene.addItem(dot);
+    auto render = [&] {
+        QImage img(20, 20, QImage::Format_ARGB32_Premultiplied);
+        img.fill(Qt::white);
+        QPainter p(&img);
+        dot->paint(&p, nullptr, nullptr);
+        p.end();
+        return img;
+    };
+    // 亚像素图形画为一个画笔颜色的像素；开启跳过后不绘制
+    QCOMPARE(render().pixelColor(10, 10), QColor(Qt::black));
+    auto lod = scene.lodSettings();
+    lod.skipTiny = true;
+    scene.setLodSettings(lod);
+    QCOMPARE(render().pixelColor(10, 10), QColor(Qt::white));
+    // 选中的图形始终完整绘制
+    dot->setSelected(true);
+    QVERIFY(render().pixelColor(10, 10) != QColor(Qt::white));
+}
+
+void DrawingSceneMoreTest::bulk_loaded_shapes_park_in_static_layer() {
+    DrawingScene scene;
+    std::vector<std::unique_ptr<Shape>> shapes;
+    shapes.push_back(std::make_unique<LineSegment>(QPointF(0,10), QPointF(100,10)));
+    shapes.push_back(std::make_unique<Rectangle>(QRectF(20,40,50,30)));
+    shapes.push_back(std::make_unique<Circle>(QPointF(150,50), 20.0));
+    scene.addShapes(shapes);
+
+    // 停放的图形不是场景中的项，但仍按文档顺序属于文档，并由静态层绘制
+    auto* layer = scene.staticLayer();
+    QVERIFY(layer);
+    QCOMPARE(layer->parkedCount(), 3);
+    for (auto* it : scene.items()) QVERIFY(!dynamic_cast<ShapeItem*>(it));
+    const auto items = scene.shapeItems();
+    QCOMPARE(items.size(), size_t(3));
+    QCOMPARE(items[0]->shapeId(), quint64(1));
+    QImage img(200, 100, QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::white);
+    {
+        QPainter p(&img);
+        scene.render(&p, QRectF(0,0,200,100), QRectF(0,0,200,100));
+    }
+    QVERIFY(img.pixelColor(50, 10) != QColor(Qt::white));
+    QVERIFY(img.pixelColor(20, 55) != QColor(Qt::white));
+
+    // 拾取按精确几何；框选把图形提升为场景中的项，取消选中后放回原位
+    QCOMPARE(layer->itemAt(QPointF(150,50), 3.0), items[2]);
+    QVERIFY(!layer->itemAt(QPointF(110,90), 3.0));
+    QPainterPath area;
+    area.addRect(QRectF(10,30,70,50));
+    scene.selectStaticInArea(area);
+    ShapeItem* rect = items[1];
+    QVERIFY(rect->isSelected());
+    QCOMPARE(rect->scene(), &scene);
+    QCOMPARE(layer->parkedCount(), 2);
+    rect->setSelected(false);
+    QTRY_COMPARE(layer->parkedCount(), 3);
+    QVERIFY(!rect->scene());
+    QVERIFY(scene.shapeItems() == items);
+
+    // 只碰到包围盒角落的框选不提升图形
+    QPainterPath corner;
+    corner.addRect(QRectF(130,30,3,3));
+    scene.selectStaticInArea(corner);
+    QVERIFY(!items[2]->scene());
+    QCOMPARE(layer->parkedCount(), 3);
+}
+
+void DrawingSceneMoreTest::grid_merges_dense_lines() {
+    // 屏幕间距不足 6 像素时按 5 倍合并
+    QCOMPARE(DrawingScene::gridStep(20.0, 1.0), 20.0);
+    QCOMPARE(DrawingScene::gridStep(20.0, 0.3), 20.0);
+    QCOMPARE(DrawingScene::gridStep(20.0, 0.2), 100.0);
+    QCOMPARE(DrawingScene::gridStep(20.0, 0.01), 2500.0);
+    QCOMPARE(DrawingScene::gridStep(0.0, 1.0), 20.0);
+
+    // 缩小到 0.1 倍时画在 320x240 视口中的网格线数与 1 倍时同一量级
+    DrawingScene scene; scene.setSceneRect(-5000,-5000,10000,10000);
+    QImage img(320, 240, QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::white);
+    {
+        QPainter p(&img);
+        scene.render(&p, QRectF(0,0,320,240), QRectF(-1600,-1200,3200,2400));
+    }
+    int gridColumns = 0;
+    for (int x = 0; x < img.width(); ++x) {
+        if (img.pixelColor(x, 5) != QColor(Qt::white) && img.pixelColor(x, 120) != QColor(Qt::white)) ++gridColumns;
+    }
+    QVERIFY(gridColumns > 0);
+    QVERIFY(gridColumns <= 320 / DrawingScene::kGridMinSpacingPx + 1);
+}
+
+void DrawingSceneMoreTest::static_layer_tiles_follow_edits() {
+    DrawingScene scene;
+    scene.setShowGrid(false);
+    std::vector<std::unique_ptr<Shape>> shapes;
+    shapes.push_back(std::make_unique<Rectangle>(QRectF(20,20,40,40)));
+    shapes.push_back(std::make_unique<LineSegment>(QPointF(200,200), QPointF(500,200)));
+    // 细线紧贴瓦片边界左侧：抗锯齿溢出到右侧瓦片的像素
+    auto hairline = std::make_unique<LineSegment>(QPointF(255.7,230), QPointF(255.7,290));
+    hairline->setPen(QPen(Qt::black, 0));
+    shapes.push_back(std::move(hairline));
+    scene.addShapes(shapes);
+    auto* layer = scene.staticLayer();
+    QVERIFY(layer->tileCacheEnabled());
+    auto render = [&] {
+        QImage img(600, 300, QImage::Format_ARGB32_Premultiplied);
+        img.fill(Qt::white);
+        QPainter p(&img);
+        scene.render(&p, QRectF(0,0,600,300), QRectF(0,0,600,300));
+        return img;
+    };
+    // 缩放级别首次出现时直接绘制，同一级别再次绘制才切瓦片
+    QImage img = render();
+    QCOMPARE(layer->cachedTileCount(), qsizetype(0));
+    // 跨越瓦片边界（x = 256）的线段完整绘制
+    img = render();
+    QVERIFY(layer->cachedTileCount() > 0);
+    QVERIFY(img.pixelColor(20, 40) != QColor(Qt::white));
+    QCOMPARE(img.pixelColor(150, 200), QColor(Qt::white));
+    QVERIFY(img.pixelColor(255, 200) != QColor(Qt::white));
+    QVERIFY(img.pixelColor(256, 200) != QColor(Qt::white));
+    QVERIFY(img.pixelColor(499, 200) != QColor(Qt::white));
+    const QColor spill = img.pixelColor(256, 260);
+
+    // 移动后放回：旧位置与新位置所在的瓦片重画
+    ShapeItem* rect = scene.shapeItems()[0];
+    layer->promote(rect);
+    rect->setPos(100, 0);
+    rect->model()->MoveTo(100, 0);
+    QCOMPARE(layer->demoteIdle(), 1);
+    img = render();
+    QCOMPARE(img.pixelColor(20, 40), QColor(Qt::white));
+    QVERIFY(img.pixelColor(120, 40) != QColor(Qt::white));
+    // 直接绘制与瓦片结果一致
+    layer->setTileCacheEnabled(false);
+    const QImage direct = render();
+    QCOMPARE(direct.pixelColor(20, 40), QColor(Qt::white));
+    QVERIFY(direct.pixelColor(120, 40) != QColor(Qt::white));
+    QVERIFY(direct.pixelColor(310, 200) != QColor(Qt::white));
+    QCOMPARE(spill, direct.pixelColor(256, 260));
+
+    // 连续缩放：每帧级别不同，不产生瓦片
+    layer->setTileCacheEnabled(true);
+    for (int i = 1; i <= 4; ++i) {
+        QImage zoomed(600, 300, QImage::Format_ARGB32_Premultiplied);
+        QPainter p(&zoomed);
+        scene.render(&p, QRectF(0,0,600,300), QRectF(0,0,600 / (1 + 0.1 * i),300 / (1 + 0.1 * i)));
+    }
+    QCOMPARE(layer->cachedTileCount(), qsizetype(0));
+}
+
+void DrawingSceneMoreTest::batched_insert_keeps_document_order() {
+    const int n = DrawingScene::kInsertBatch * 2 + 7;
+    auto make = [n] {
+        std::vector<std::unique_ptr<Shape>> shapes;
+        for (int i = 0; i < n; ++i) shapes.push_back(std::make_unique<LineSegment>(QPointF(i, 0), QPointF(i, 1)));
+        return shapes;
+    };
+    DrawingScene scene;
+    QList<qint64> reported;
+    int finished = -1;
+    scene.addShapesInBatches(make(), [&](qint64 done, qint64 total) {
+        reported << done;
+        return total == n;
+    }, [&](bool complete) { finished = complete ? 1 : 0; });
+    // 第一批同步创建，其余每轮事件循环一批；全部创建前不加入文档
+    QCOMPARE(reported.size(), 1);
+    QVERIFY(scene.shapeItems().empty());
+    QTRY_COMPARE(finished, 1);
+    QCOMPARE(reported.size(), 3);
+    QCOMPARE(reported.back(), qint64(n));
+    const auto items = scene.shapeItems();
+    QCOMPARE(int(items.size()), n);
+    for (int i = 0; i < n; i += 997) QCOMPARE(items[i]->shapeId(), quint64(i + 1));
+
+    // 取消：已创建的项被删除，文档不变
+    DrawingScene other;
+    finished = -1;
+    other.addShapesInBatches(make(), [](qint64, qint64) { return false; }, [&](bool complete) { finished = complete ? 1 : 0; });
+    QCOMPARE(finished, 0);
+    QVERIFY(other.shapeItems().empty());
+}
+
 QTEST_MAIN(DrawingSceneMoreTest)
 #include "test_drawing_scene_more.moc"
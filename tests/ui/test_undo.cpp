@@ -2,13 +2,19 @@
 #include <QtTest/QtTest>
 #include <QUndoStack>
 #include <QJsonObject>
+#include <QJsonDocument>
+#include <QFile>
+#include <QTemporaryDir>
 
 #include "ui/DrawingScene.h"
 #include "ui/ShapeItem.h"
 #include "core/Serialization.h"
+#include "core/StyleTable.h"
 #include "core/shapes/Rectangle.h"
 #include "core/shapes/Circle.h"
+#include "core/shapes/Polygon.h"
 #include "undo/Commands.h"
+#include "undo/EditJournal.h"
 
 static int shapeItemCount(QGraphicsScene* s) {
     int c=0; for (auto* it : s->items()) if (dynamic_cast<ShapeItem*>(it)) ++c; return c;
@@ -21,6 +27,10 @@ private slots:
     void transform_and_undo();
     void edit_json_and_undo();
     void delete_and_undo();
+    void move_vertex_and_undo();
+    void style_and_name_and_undo();
+    void replace_undo_restores_order();
+    void journal_replay_rebuilds_scene();
 };
 
 void UndoCommandsTest::add_and_undo() {
@@ -83,6 +93,146 @@ void UndoCommandsTest::delete_and_undo() {
     QCOMPARE(shapeItemCount(&scene), before);
 }
 
+void UndoCommandsTest::move_vertex_and_undo() {
+    DrawingScene scene; QUndoStack stack; scene.setUndoStack(&stack);
+    auto* item = new ShapeItem(std::make_unique<Polygon>(QVector<QPointF>{{0,0},{10,0},{10,10},{0,10}}));
+    scene.addItem(item);
+    auto* pg = static_cast<Polygon*>(item->model());
+    QCOMPARE(pg->Area(), 100.0);
+    const QPointF neighbourScene = item->mapToScene(pg->points()[0]);
+    stack.push(new UndoCmd::MoveVertexCommand(item, 2, QPointF(10,10), QPointF(20,10)));
+    QCOMPARE(pg->points()[2], QPointF(20,10));
+    QVERIFY(std::abs(pg->Area() - 150.0) < 1e-9);
+    // 相邻顶点在场景中保持不动（与拖拽一致）
+    QVERIFY(QLineF(item->mapToScene(pg->points()[0]), neighbourScene).length() < 1e-9);
+    stack.undo();
+    QCOMPARE(pg->points()[2], QPointF(10,10));
+    QVERIFY(std::abs(pg->Area() - 100.0) < 1e-9);
+    QVERIFY(std::abs(pg->Perimeter() - 40.0) < 1e-9);
+}
+
+// 替换（布尔运算）后撤销：原图形回到原来的堆叠次序，停放的回到静态层中的原位
+void UndoCommandsTest::replace_undo_restores_order() {
+    DrawingScene scene; QUndoStack stack; scene.setUndoStack(&stack);
+    std::vector<std::unique_ptr<Shape>> shapes;
+    for (int i = 0; i < 4; ++i) shapes.push_back(std::make_unique<Rectangle>(QRectF(i * 5, 0, 10, 10)));
+    scene.addShapes(shapes);
+    auto* top = new ShapeItem(std::make_unique<Rectangle>(QRectF(0, 20, 10, 10))); scene.addItem(top);
+    auto json = [](ShapeItem* si) { return QJsonDocument(si->model()->ToJson()).toJson(QJsonDocument::Compact); };
+    const auto before = scene.shapeItems();
+    QCOMPARE(int(before.size()), 5);
+    QList<QByteArray> order;
+    for (auto* si : before) order << json(si);
+
+    Polygon result(QVector<QPointF>{{0,0},{1,0},{1,1}}); QJsonObject rj = result.ToJson(); rj["type"] = QStringLiteral("Polygon");
+    stack.push(new UndoCmd::ReplaceShapesCommand(&scene, {before[3], before[1]}, {rj}, QStringLiteral("replace")));
+    QCOMPARE(int(scene.shapeItems().size()), 4);
+    stack.undo();
+    QCOMPARE(int(scene.shapeItems().size()), 5);
+    const auto after = scene.shapeItems();
+    for (int i = 0; i < 5; ++i) QCOMPARE(json(after[i]), order[i]);
+    QCOMPARE(after[4], top);
+    QVERIFY(after[1]->staticLayer());
+    QVERIFY(after[3]->staticLayer());
+}
+
+void UndoCommandsTest::style_and_name_and_undo() {
+    DrawingScene scene; QUndoStack stack; scene.setUndoStack(&stack);
+    auto* item = new ShapeItem(std::make_unique<Rectangle>(QRectF(0,0,10,10)));
+    scene.addItem(item);
+    auto* s = item->model();
+    const quint32 oldStyle = s->styleIndex();
+    QPen pen = s->pen(); pen.setWidthF(4.0); pen.setColor(Qt::red);
+    const quint32 red = StyleTable::instance().intern(QColor(Qt::red), pen);
+    stack.push(new UndoCmd::SetStyleCommand(item, oldStyle, red));
+    QCOMPARE(s->color(), QColor(Qt::red));
+    QCOMPARE(s->pen().widthF(), 4.0);
+    const QString oldName = s->name();
+    stack.push(new UndoCmd::RenameShapeCommand(item, oldName, QStringLiteral("外框")));
+    QCOMPARE(s->name(), QStringLiteral("外框"));
+    stack.undo();
+    QCOMPARE(s->name(), oldName);
+    stack.undo();
+    QCOMPARE(s->styleIndex(), oldStyle);
+    stack.redo();
+    QCOMPARE(s->styleIndex(), red);
+}
+
+// 场景中全部图形（含停放在静态层中的）按堆叠次序的 JSON
+static QStringList sceneJson(DrawingScene* s) {
+    QStringList out;
+    for (auto* si : s->shapeItems()) {
+        out << QString::fromUtf8(QJsonDocument(si->model()->ToJson()).toJson(QJsonDocument::Compact));
+    }
+    return out;
+}
+
+void UndoCommandsTest::journal_replay_rebuilds_scene() {
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    const QString base = tmp.filePath("doc.json");
+
+    DrawingScene scene; QUndoStack stack; scene.setUndoStack(&stack);
+    auto* rect = new ShapeItem(std::make_unique<Rectangle>(QRectF(0,0,10,10))); scene.addItem(rect);
+    auto* poly = new ShapeItem(std::make_unique<Polygon>(QVector<QPointF>{{0,0},{10,0},{10,10},{0,10}})); scene.addItem(poly);
+    QCOMPARE(rect->shapeId(), quint64(1));
+    QCOMPARE(poly->shapeId(), quint64(2));
+    QVERIFY(Ser::SaveToFile(base, {rect->model(), poly->model()}));
+
+    EditJournal journal;
+    QVERIFY(journal.start(base, {1, 2}));
+    scene.setJournal(&journal);
+    Circle c(QPointF(5,5), 3.0); QJsonObject cj = c.ToJson(); cj["type"] = QStringLiteral("Circle");
+    stack.push(new UndoCmd::AddShapeCommand(&scene, cj));
+    stack.push(new UndoCmd::TransformShapeCommand(rect, rect->pos(), 0.0, QPointF(30, -4), 15.0));
+    stack.push(new UndoCmd::MoveVertexCommand(poly, 2, QPointF(10,10), QPointF(25,10)));
+    ShapeItem* circle = nullptr;
+    for (auto* it : scene.items()) {
+        if (auto* si = dynamic_cast<ShapeItem*>(it); si && si->typeName() == QStringLiteral("Circle")) circle = si;
+    }
+    QVERIFY(circle);
+    auto bigger = cj; auto g = bigger["geom"].toObject(); g["r"] = 9.0; bigger["geom"] = g;
+    stack.push(new UndoCmd::EditShapeJsonCommand(circle, cj, bigger));
+    QPen thick = circle->model()->pen(); thick.setWidthF(3.5); thick.setColor(Qt::blue);
+    stack.push(new UndoCmd::SetStyleCommand(circle, circle->model()->styleIndex(),
+                                            StyleTable::instance().intern(QColor(Qt::blue), thick)));
+    stack.push(new UndoCmd::RenameShapeCommand(circle, circle->model()->name(), QStringLiteral("圆")));
+    rect->setSelected(true);
+    stack.push(new UndoCmd::DeleteShapesCommand(&scene, {rect->model()->ToJson()}));
+    stack.undo(); // 删除后撤销：重新加入的图形带新编号
+    // 替换后撤销：原图形插回原来的堆叠位置（最底层），回放须得到同样的次序
+    QCOMPARE(scene.shapeItems().front(), poly);
+    Rectangle result(QRectF(0,0,4,4)); QJsonObject rj = result.ToJson(); rj["type"] = QStringLiteral("Rectangle");
+    stack.push(new UndoCmd::ReplaceShapesCommand(&scene, {poly}, {rj}, QStringLiteral("替换")));
+    stack.undo();
+    QCOMPARE(scene.shapeItems().front()->typeName(), QStringLiteral("Polygon"));
+    scene.setJournal(nullptr);
+
+    // 崩溃恢复：载入基准文档并回放日志，得到相同的场景（含堆叠次序）
+    const QString path = journal.path();
+    QFile tail(path);
+    QVERIFY(tail.open(QIODevice::Append));
+    tail.write("{\"op\":\"remo"); // 崩溃时写了一半的末行被忽略
+    tail.close();
+    EditJournal::Contents contents;
+    QString err;
+    QVERIFY2(EditJournal::Load(path, contents, &err), qPrintable(err));
+    QCOMPARE(contents.basePath, base);
+    DrawingScene restored;
+    auto shapes = Ser::LoadFromFile(base, &err);
+    restored.addShapes(shapes);
+    QVERIFY2(EditJournal::Replay(&restored, contents, &err), qPrintable(err));
+    QCOMPARE(sceneJson(&restored), sceneJson(&scene));
+
+    // 基准文件在日志之后被改写：拒绝回放
+    // （修改时间可能落在同一毫秒，文件大小的变化足以识别）
+    QVERIFY(Ser::SaveToFile(base, std::vector<Shape*>{&result}));
+    QVERIFY(!EditJournal::Load(path, contents, &err));
+    QVERIFY(!err.isEmpty());
+    journal.discard();
+    QVERIFY(!QFile::exists(path));
+}
+
 QTEST_MAIN(UndoCommandsTest)
 #include "test_undo.moc"
 
@@ -14,6 +14,22 @@
 #include "core/shapes/Polygon.h"
 #include "core/shapes/Polyline.h"
 #include "core/shapes/Ellipse.h"
+#include "core/ShapeStore.h"
+#include "core/GeometryKernels.h"
+#include "core/MeasureReport.h"
+#include "core/ObjectPool.h"
+#include "core/Simplify.h"
+#include "core/RTree.h"
+#include "core/HitTest.h"
+#include "core/PolygonBoolean.h"
+#include "core/Tessellate.h"
+#include "core/StyleTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
 
 TEST_CASE("LineSegment length") {
     LineSegment ls({0,0},{3,4});
@@ -70,3 +86,592 @@ TEST_CASE("Shape transform and rotation") {
     r.setRotationDegrees(15.0);
     REQUIRE_NEAR(r.rotationDegrees(), 15.0, 1e-9);
 }
+
+TEST_CASE("Cached metrics follow geometry and transform changes") {
+    Polygon p({QPointF(0,0), QPointF(2,0), QPointF(2,2), QPointF(0,2)});
+    REQUIRE_NEAR(p.Area(), 4.0, 1e-9);
+    REQUIRE(p.BoundingBox() == QRectF(0,0,2,2));
+    const auto rev = p.geometryRevision();
+    p.setPoint(2, QPointF(4,4));
+    REQUIRE(p.geometryRevision() != rev);
+    REQUIRE_NEAR(p.Area(), 6.0, 1e-9);
+    REQUIRE(p.LocalBounds() == QRectF(0,0,4,4));
+    p.MoveTo(10, 20);
+    REQUIRE(p.BoundingBox() == QRectF(10,20,4,4));
+    REQUIRE(p.LocalBounds() == QRectF(0,0,4,4));
+
+    Circle c(QPointF(0,0), 1.0);
+    REQUIRE_NEAR(c.Perimeter(), 2.0*3.14159265358979323846, 1e-9);
+    c.setRadius(3.0);
+    REQUIRE_NEAR(c.Perimeter(), 6.0*3.14159265358979323846, 1e-9);
+    REQUIRE(c.BoundingBox() == QRectF(-3,-3,6,6));
+
+    Polyline pl({QPointF(0,0), QPointF(3,4)});
+    REQUIRE_NEAR(pl.Length(), 5.0, 1e-9);
+    pl.setPoints({QPointF(0,0), QPointF(3,4), QPointF(3,0)});
+    REQUIRE_NEAR(pl.Length(), 9.0, 1e-9);
+}
+
+TEST_CASE("Shape kind tags match concrete type") {
+    REQUIRE(LineSegment().kind() == ShapeKind::LineSegment);
+    REQUIRE(Rectangle().kind() == ShapeKind::Rectangle);
+    REQUIRE(Circle().kind() == ShapeKind::Circle);
+    REQUIRE(Triangle().kind() == ShapeKind::Triangle);
+    REQUIRE(Polygon().kind() == ShapeKind::Polygon);
+    REQUIRE(Polyline().kind() == ShapeKind::Polyline);
+    REQUIRE(Ellipse().kind() == ShapeKind::Ellipse);
+    std::unique_ptr<Shape> s = std::make_unique<Circle>(QPointF(1,1), 2.0);
+    REQUIRE(s->kind() == Circle::kKind);
+}
+
+TEST_CASE("ShapeStore metrics match shapes") {
+    LineSegment ls({0,0},{3,4});
+    Rectangle rc(QRectF(1,1,10,20)); rc.MoveTo(5, 5);
+    Circle cc(QPointF(0,0), 2.0);
+    Triangle tr({0,0},{4,0},{0,3});
+    Polygon pg({QPointF(0,0), QPointF(2,0), QPointF(2,2), QPointF(0,2)});
+    Polyline pl({QPointF(0,0), QPointF(3,4), QPointF(6,4)});
+    Ellipse el(QPointF(1,1), 3.0, 4.0);
+    std::vector<Shape*> in { &ls, &rc, &cc, &tr, &pg, &pl, &el };
+
+    auto store = ShapeStore::FromShapes(in);
+    REQUIRE(store.size() == 7);
+    REQUIRE(store.styles().size() == 1);
+    for (int i = 0; i < store.size(); ++i) {
+        REQUIRE(store.typeName(i) == in[i]->typeName());
+        REQUIRE(store.boundingBox(i) == in[i]->BoundingBox());
+        REQUIRE_NEAR(store.length(i), in[i]->Length(), 1e-12);
+        if (auto* as = dynamic_cast<AreaShape*>(in[i])) {
+            REQUIRE_NEAR(store.area(i), as->Area(), 1e-12);
+            REQUIRE_NEAR(store.perimeter(i), as->Perimeter(), 1e-12);
+        }
+    }
+    // 多边形与折线共用一块顶点缓冲
+    REQUIRE(store.vertices().size() == 7);
+}
+
+TEST_CASE("ShapeStore makeShape roundtrip") {
+    Polygon pg({QPointF(0,0), QPointF(2,0), QPointF(1,3)});
+    pg.setName("P");
+    QPen pen(Qt::red); pen.setWidthF(2.5); pg.setPen(pen);
+    pg.MoveTo(7, -3);
+    pg.setRotationDegrees(30.0);
+    ShapeStore store;
+    REQUIRE(store.append(pg) == 0);
+    auto back = store.makeShape(0);
+    REQUIRE(back);
+    REQUIRE(back->ToJson() == pg.ToJson());
+    REQUIRE(store.toJson(0) == pg.ToJson());
+    REQUIRE(back->pen().color() == QColor(Qt::red));
+}
+
+// 原标量实现（取模 + hypot），作为向量化内核的对照
+static double refPerimeter(const std::vector<QPointF>& pts) {
+    double sum = 0.0;
+    const auto n = pts.size();
+    for (size_t i = 0; i < n; ++i) {
+        const auto& a = pts[i];
+        const auto& b = pts[(i + 1) % n];
+        sum += std::hypot(b.x() - a.x(), b.y() - a.y());
+    }
+    return sum;
+}
+
+static double refArea(const std::vector<QPointF>& pts) {
+    double sum = 0.0;
+    const auto n = pts.size();
+    for (size_t i = 0; i < n; ++i) {
+        const auto& a = pts[i];
+        const auto& b = pts[(i + 1) % n];
+        sum += a.x() * b.y() - b.x() * a.y();
+    }
+    return std::abs(sum) * 0.5;
+}
+
+static std::vector<QPointF> ringPoints(size_t n, QPointF c, double r) {
+    std::vector<QPointF> pts;
+    pts.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const double t = 2.0 * 3.14159265358979323846 * double(i) / double(n);
+        pts.emplace_back(c.x() + r * std::cos(t), c.y() + r * std::sin(t) * 0.5);
+    }
+    return pts;
+}
+
+TEST_CASE("Geometry kernels match scalar reference for every ISA") {
+    const Kernels::Isa isas[] = { Kernels::Isa::Scalar, Kernels::Isa::SSE2, Kernels::Isa::AVX2 };
+    // 覆盖各向量宽度的收尾分支
+    for (size_t n = 0; n < 20; ++n) {
+        const auto pts = ringPoints(n, QPointF(3, -2), 10.0);
+        const auto* xy = reinterpret_cast<const double*>(pts.data());
+        const double area = n < 3 ? 0.0 : refArea(pts);
+        const double perim = n < 2 ? 0.0 : refPerimeter(pts);
+        for (auto isa : isas) {
+            REQUIRE_NEAR(Kernels::PolygonArea(xy, n, isa), area, 1e-9);
+            REQUIRE_NEAR(Kernels::PolygonPerimeter(xy, n, isa), perim, 1e-9);
+            REQUIRE_NEAR(Kernels::PathLength(xy, n, isa), n < 2 ? 0.0 : perim - std::hypot(pts[0].x() - pts[n-1].x(), pts[0].y() - pts[n-1].y()), 1e-9);
+        }
+    }
+    REQUIRE(Kernels::IsaSupported(Kernels::ActiveIsa()));
+}
+
+TEST_CASE("Geometry kernels keep precision on large coordinates") {
+    // 远离原点的大多边形：平移 + 补偿求和后各实现应一致且接近解析值
+    const size_t n = 200003;
+    const double r = 250.0;
+    const auto pts = ringPoints(n, QPointF(1e7, -4e6), r);
+    const auto* xy = reinterpret_cast<const double*>(pts.data());
+    const double pi = 3.14159265358979323846;
+    const double exactArea = 0.5 * double(n) * r * (r * 0.5) * std::sin(2.0 * pi / double(n));
+    const double scalarPerim = Kernels::PolygonPerimeter(xy, n, Kernels::Isa::Scalar);
+    REQUIRE_NEAR(scalarPerim, refPerimeter(pts), 1e-6);
+    for (auto isa : { Kernels::Isa::Scalar, Kernels::Isa::SSE2, Kernels::Isa::AVX2 }) {
+        REQUIRE_NEAR(Kernels::PolygonArea(xy, n, isa), exactArea, 1e-6 * exactArea);
+        REQUIRE_NEAR(Kernels::PolygonPerimeter(xy, n, isa), scalarPerim, 1e-9);
+    }
+
+    Polygon pg(QVector<QPointF>(pts.begin(), pts.end()));
+    REQUIRE_NEAR(pg.Area(), exactArea, 1e-6 * exactArea);
+    REQUIRE_NEAR(pg.Perimeter(), scalarPerim, 1e-9);
+    Polyline pl(QVector<QPointF>(pts.begin(), pts.end()));
+    REQUIRE_NEAR(pl.Length(), Kernels::PathLength(xy, n, Kernels::Isa::Scalar), 1e-9);
+}
+
+TEST_CASE("MeasureReport totals per type, parallel and by region") {
+    ShapeStore store;
+    const int n = 10000;
+    for (int i = 0; i < n; ++i) {
+        Rectangle rc(QRectF(0, 0, 2, 3)); rc.MoveTo(i * 10.0, 0);
+        store.append(rc);
+        LineSegment ls({0,0},{3,4}); ls.MoveTo(i * 10.0, 100);
+        store.append(ls);
+    }
+    Polygon pg({QPointF(0,0), QPointF(2,0), QPointF(2,2), QPointF(0,2)});
+    store.append(pg);
+
+    const auto one = MeasureReport::Compute(store, 1);
+    const auto many = MeasureReport::Compute(store, 4);
+    for (const auto* r : { &one, &many }) {
+        REQUIRE(r->of(ShapeKind::Rectangle).count == n);
+        REQUIRE(r->of(ShapeKind::LineSegment).count == n);
+        REQUIRE(r->of(ShapeKind::Polygon).count == 1);
+        REQUIRE(r->of(ShapeKind::Circle).count == 0);
+        REQUIRE(r->total.count == 2 * n + 1);
+        REQUIRE_NEAR(r->of(ShapeKind::Rectangle).area, 6.0 * n, 1e-6);
+        REQUIRE_NEAR(r->of(ShapeKind::Rectangle).perimeter, 10.0 * n, 1e-6);
+        REQUIRE_NEAR(r->of(ShapeKind::LineSegment).length, 5.0 * n, 1e-6);
+        REQUIRE_NEAR(r->total.area, 6.0 * n + 4.0, 1e-6);
+        REQUIRE(r->of(ShapeKind::LineSegment).extents == QRectF(QPointF(0, 100), QPointF((n - 1) * 10.0 + 3, 104)));
+        REQUIRE(r->total.extents == QRectF(QPointF(0, 0), QPointF((n - 1) * 10.0 + 3, 104)));
+    }
+
+    // 区域：仅覆盖前两列矩形与线段（边界接触也计入）
+    const auto part = MeasureReport::ComputeInRect(store, QRectF(QPointF(-1, -1), QPointF(10, 200)), 4);
+    REQUIRE(part.of(ShapeKind::Rectangle).count == 2);
+    REQUIRE(part.of(ShapeKind::LineSegment).count == 2);
+    REQUIRE(part.of(ShapeKind::Polygon).count == 1);
+    REQUIRE(MeasureReport::Compute(ShapeStore()).total.count == 0);
+}
+
+TEST_CASE("MeasureReport over chunked snapshots runs chunks on several workers") {
+    // 与统计面板相同：文档按 4096 行分块快照，多块一起交给 Compute
+    const int chunkRows = 4096, chunkCount = 32;
+    std::vector<ShapeStore> stores(chunkCount);
+    for (int c = 0; c < chunkCount; ++c) {
+        for (int i = 0; i < chunkRows; ++i) {
+            Rectangle rc(QRectF(0, 0, 2, 3)); rc.MoveTo((c * chunkRows + i) * 10.0, 0);
+            stores[c].append(rc);
+        }
+    }
+    std::vector<const ShapeStore*> parts;
+    for (const auto& s : stores) parts.push_back(&s);
+
+    const auto one = MeasureReport::Compute(parts, 1);
+    REQUIRE(one.workers == 1);
+    // 池线程启动有延迟，多试几次取最大值
+    int workers = 0;
+    for (int attempt = 0; attempt < 5 && workers < 2; ++attempt) {
+        const auto many = MeasureReport::Compute(parts, 4);
+        REQUIRE(many.total.count == chunkRows * chunkCount);
+        REQUIRE_NEAR(many.total.area, one.total.area, 1e-6);
+        REQUIRE(many.total.extents == one.total.extents);
+        workers = std::max(workers, many.workers);
+    }
+    REQUIRE(workers > 1);
+    REQUIRE(workers <= 4);
+
+    const QRectF region(QPointF(-1, -1), QPointF(chunkRows * 10.0 + 5, 10));
+    REQUIRE(MeasureReport::ComputeInRect(parts, region, 4).total.count == chunkRows + 1);
+}
+
+TEST_CASE("Polygon/Polyline in-place vertex edits keep caches exact") {
+    // 足够多的顶点以走增量路径（替换区间远小于顶点数）
+    QVector<QPointF> ring;
+    for (int i = 0; i < 64; ++i) {
+        const double t = 2.0 * 3.14159265358979323846 * i / 64.0;
+        ring.append(QPointF(5e6 + 40.0 * std::cos(t), -3e6 + 25.0 * std::sin(t)));
+    }
+    Polygon pg(ring);
+    Polyline pl(ring);
+    // 预热缓存
+    (void)pg.Area(); (void)pg.Perimeter(); (void)pg.BoundingBox();
+    (void)pl.Length(); (void)pl.BoundingBox();
+    const auto rev = pg.geometryRevision();
+
+    const QPointF moved[] = { QPointF(5e6 + 90.0, -3e6 + 1.0), QPointF(5e6 + 10.0, -3e6 - 2.0), QPointF(5e6 - 3.0, -3e6 + 60.0) };
+    pg.setPoint(0, moved[0]);            // 边界顶点向外
+    pg.setPointRange(30, moved + 1, 2);  // 一段顶点
+    pg.setPoint(63, pg.points()[63] + QPointF(-1, 1));
+    pl.setPoint(0, moved[0]);
+    pl.setPointRange(62, moved + 1, 2);  // 末尾区间
+    REQUIRE(pg.geometryRevision() != rev);
+    REQUIRE(pg.points()[0] == moved[0]);
+
+    Polygon pgRef(pg.points());
+    Polyline plRef(pl.points());
+    REQUIRE_NEAR(pg.Area(), pgRef.Area(), 1e-6);
+    REQUIRE_NEAR(pg.Perimeter(), pgRef.Perimeter(), 1e-6);
+    REQUIRE(pg.BoundingBox() == pgRef.BoundingBox());
+    REQUIRE_NEAR(pl.Length(), plRef.Length(), 1e-6);
+    REQUIRE(pl.BoundingBox() == plRef.BoundingBox());
+
+    // 边界顶点向内移动：包围盒需重算，结果仍正确
+    pg.setPoint(0, QPointF(5e6, -3e6));
+    REQUIRE(pg.BoundingBox() == Polygon(pg.points()).BoundingBox());
+    // 大区间替换与越界调用
+    pl.setPointRange(0, ring.constData(), ring.size());
+    REQUIRE_NEAR(pl.Length(), Polyline(ring).Length(), 1e-9);
+    pl.setPointRange(63, moved, 2);
+    REQUIRE(pl.points() == ring);
+}
+
+TEST_CASE("Shapes allocate from the object pool and trim releases freed slabs") {
+    if (!ObjectPool::Enabled()) return;
+    const auto base = ObjectPool::GetStats();
+    std::vector<std::unique_ptr<Shape>> doc;
+    for (int i = 0; i < 20000; ++i) {
+        if (i % 2) doc.push_back(std::make_unique<Circle>(QPointF(i, 0), 1.0));
+        else doc.push_back(std::make_unique<Polygon>(QVector<QPointF>{{0,0},{1,0},{0,1}}));
+    }
+    REQUIRE(ObjectPool::GetStats().liveObjects == base.liveObjects + doc.size());
+    REQUIRE(ObjectPool::GetStats().reservedBytes > base.reservedBytes);
+
+    // 留下少量对象，其余释放后 Trim 归还整块空闲的内存
+    auto survivor = std::move(doc.back());
+    doc.clear();
+    REQUIRE(ObjectPool::GetStats().liveObjects == base.liveObjects + 1);
+    REQUIRE(ObjectPool::Trim() > 0);
+    REQUIRE_NEAR(survivor->Length(), 2.0 * 3.14159265358979323846, 1e-9);
+    survivor.reset();
+    ObjectPool::Trim();
+    REQUIRE(ObjectPool::GetStats().liveObjects == base.liveObjects);
+    REQUIRE(ObjectPool::GetStats().reservedBytes <= base.reservedBytes);
+}
+
+TEST_CASE("Douglas-Peucker importance and LOD pyramid") {
+    // 噪声圆环：化简结果与容差单调相关，偏差不超过容差
+    std::vector<QPointF> ring;
+    for (int i = 0; i < 4000; ++i) {
+        const double t = 2.0 * 3.14159265358979323846 * i / 4000.0;
+        const double r = 100.0 + ((i * 7919) % 13) * 0.01;
+        ring.push_back(QPointF(r * std::cos(t), r * std::sin(t)));
+    }
+    const auto n = static_cast<qsizetype>(ring.size());
+
+    // 直线上的中间点全部被化简掉，端点保留
+    const std::vector<QPointF> line { {0,0}, {1,0.001}, {2,0}, {3,-0.001}, {4,0} };
+    const auto straight = Simplify::DouglasPeucker(line.data(), 5, 0.01, false);
+    REQUIRE(straight.size() == 2);
+    REQUIRE(straight.front() == line.front() && straight.back() == line.back());
+
+    const auto fine = Simplify::DouglasPeucker(ring.data(), n, 0.05, true);
+    const auto coarse = Simplify::DouglasPeucker(ring.data(), n, 2.0, true);
+    REQUIRE(coarse.size() < fine.size());
+    REQUIRE(fine.size() < n);
+
+    Simplify::LodPyramid pyr;
+    pyr.build(ring.data(), n, true);
+    REQUIRE(!pyr.levels().empty());
+    qsizetype prev = n;
+    double prevTol = 0.0;
+    for (const auto& lv : pyr.levels()) {
+        REQUIRE(lv.points.size() * 2 <= prev);
+        REQUIRE(lv.tolerance > prevTol);
+        // 与同容差的直接化简一致
+        REQUIRE(lv.points == Simplify::DouglasPeucker(ring.data(), n, lv.tolerance, true));
+        prev = lv.points.size();
+        prevTol = lv.tolerance;
+    }
+    // 容差小于最精细层时需精确绘制
+    REQUIRE(pyr.levelFor(pyr.levels().front().tolerance * 0.5) == nullptr);
+    REQUIRE(pyr.levelFor(1e9) == &pyr.levels().back().points);
+
+    // 顶点过少不建金字塔
+    Simplify::LodPyramid small;
+    small.build(ring.data(), Simplify::LodPyramid::kMinVertices - 1, false);
+    REQUIRE(small.levels().empty());
+}
+
+TEST_CASE("RTree range and nearest queries match brute force") {
+    std::vector<std::unique_ptr<Shape>> owned;
+    std::vector<Shape*> shapes;
+    for (int i = 0; i < 3000; ++i) {
+        const double x = (i * 7919 % 1000) * 1.0, y = (i * 104729 % 997) * 1.0;
+        if (i % 3 == 0) owned.push_back(std::make_unique<LineSegment>(QPointF(x, y), QPointF(x + 8, y))); // 高为 0
+        else if (i % 3 == 1) owned.push_back(std::make_unique<Circle>(QPointF(x, y), 3.0));
+        else owned.push_back(std::make_unique<Rectangle>(QRectF(x, y, 5, 2)));
+        shapes.push_back(owned.back().get());
+    }
+    auto touches = [](const QRectF& a, const QRectF& b) {
+        return a.left() <= b.right() && b.left() <= a.right() && a.top() <= b.bottom() && b.top() <= a.bottom();
+    };
+    auto brute = [&](const RTree& t, const QRectF& r) {
+        std::vector<Shape*> out;
+        for (auto* s : shapes) if (t.contains(s) && touches(s->BoundingBox(), r)) out.push_back(s);
+        std::sort(out.begin(), out.end());
+        return out;
+    };
+    auto check = [&](const RTree& t) {
+        for (int q = 0; q < 50; ++q) {
+            const QRectF r(q * 19 % 900, q * 37 % 900, 40 + q, 30);
+            auto got = t.query(r);
+            std::sort(got.begin(), got.end());
+            REQUIRE(got == brute(t, r));
+        }
+        const QPointF p(500.5, 500.5);
+        const auto nn = t.nearest(p, 8);
+        std::vector<double> all;
+        for (auto* s : shapes) {
+            if (!t.contains(s)) continue;
+            const auto b = s->BoundingBox();
+            const double dx = std::max({b.left() - p.x(), 0.0, p.x() - b.right()});
+            const double dy = std::max({b.top() - p.y(), 0.0, p.y() - b.bottom()});
+            all.push_back(dx * dx + dy * dy);
+        }
+        std::sort(all.begin(), all.end());
+        REQUIRE(nn.size() == std::min<size_t>(8, all.size()));
+        for (size_t i = 0; i < nn.size(); ++i) {
+            const auto b = nn[i]->BoundingBox();
+            const double dx = std::max({b.left() - p.x(), 0.0, p.x() - b.right()});
+            const double dy = std::max({b.top() - p.y(), 0.0, p.y() - b.bottom()});
+            REQUIRE_NEAR(dx * dx + dy * dy, all[i], 1e-9);
+        }
+    };
+
+    RTree bulk;
+    bulk.bulkLoad(shapes);
+    REQUIRE(bulk.size() == 3000);
+    REQUIRE(bulk.height() > 1);
+    check(bulk);
+
+    // 增量：插入、删除一半、移动后更新
+    RTree inc;
+    for (auto* s : shapes) inc.insert(s);
+    check(inc);
+    for (size_t i = 0; i < shapes.size(); i += 2) REQUIRE(inc.remove(shapes[i]));
+    REQUIRE(!inc.remove(shapes[0]));
+    REQUIRE(inc.size() == 1500);
+    for (size_t i = 1; i < shapes.size(); i += 4) {
+        shapes[i]->Move(25, -10);
+        inc.update(shapes[i]);
+    }
+    check(inc);
+    for (auto* s : shapes) inc.remove(s);
+    REQUIRE(inc.empty());
+    REQUIRE(inc.height() == 1);
+    REQUIRE(inc.query(QRectF(-1e9, -1e9, 2e9, 2e9)).empty());
+}
+
+TEST_CASE("HitTest distance kernels and per-shape hits") {
+    REQUIRE_NEAR(HitTest::PointSegmentDistance(QPointF(5, 3), QPointF(0, 0), QPointF(10, 0)), 3.0, 1e-12);
+    REQUIRE_NEAR(HitTest::PointSegmentDistance(QPointF(-4, 3), QPointF(0, 0), QPointF(10, 0)), 5.0, 1e-12);
+    // 椭圆：轴上点与圆的情形有解析解
+    REQUIRE_NEAR(HitTest::PointEllipseDistance(QPointF(15, 0), QPointF(0, 0), 10, 5), 5.0, 1e-9);
+    REQUIRE_NEAR(HitTest::PointEllipseDistance(QPointF(0, 1), QPointF(0, 0), 10, 5), 4.0, 1e-9);
+    REQUIRE_NEAR(HitTest::PointEllipseDistance(QPointF(3, 4), QPointF(0, 0), 10, 10), 5.0, 1e-9);
+    REQUIRE_NEAR(HitTest::PointEllipseDistance(QPointF(12, 3), QPointF(0, 0), 10, 0), 3.605551275, 1e-6);
+
+    const QPointF sq[] = {{0, 0}, {10, 0}, {10, 10}, {0, 10}};
+    REQUIRE(HitTest::PointInPolygon(QPointF(5, 5), sq, 4));
+    REQUIRE(!HitTest::PointInPolygon(QPointF(15, 5), sq, 4));
+
+    LineSegment diag(QPointF(0, 0), QPointF(100, 100));
+    diag.setPen(QPen(Qt::black, 0));
+    REQUIRE(HitTest::Hit(diag, QPointF(51, 50), 1.0));
+    REQUIRE(!HitTest::Hit(diag, QPointF(80, 10), 1.0));  // 包围盒内但远离线段
+    Polyline zig(QVector<QPointF>{{0, 0}, {10, 10}, {20, 0}});
+    zig.setPen(QPen(Qt::black, 0));
+    REQUIRE(!HitTest::Hit(zig, QPointF(10, 2), 1.0));    // 开放折线内部不算命中
+    REQUIRE(HitTest::Hit(zig, QPointF(15, 5.5), 1.0));
+    Polygon tri(QVector<QPointF>{{0, 0}, {10, 10}, {20, 0}});
+    REQUIRE(HitTest::Hit(tri, QPointF(10, 2), 0.0));     // 闭合多边形内部命中
+    Ellipse el(QPointF(0, 0), 20, 5);
+    el.setPen(QPen(Qt::black, 0));
+    REQUIRE(HitTest::Hit(el, QPointF(0, 6), 1.5));
+    REQUIRE(!HitTest::Hit(el, QPointF(18, 4.5), 0.5));   // 包围盒角落
+    Rectangle rc(QRectF(0, 0, 10, 10));
+    rc.setPen(QPen(Qt::black, 4));                       // 线宽一半计入容差
+    REQUIRE(HitTest::Hit(rc, QPointF(12.5, 5), 1.0));
+    REQUIRE(!HitTest::Hit(rc, QPointF(12.5, 12.5), 1.0));
+}
+
+TEST_CASE("PolygonBoolean matches point classification for all operations") {
+    using PolygonBoolean::Op;
+    auto inResult = [](const QPointF& p, const std::vector<PolygonBoolean::ResultRing>& rings) {
+        bool in = false; // 各环按奇偶规则叠加
+        for (const auto& r : rings) {
+            if (HitTest::PointInPolygon(p, r.points.constData(), r.points.size())) in = !in;
+        }
+        return in;
+    };
+    auto expected = [](Op op, bool a, bool b) {
+        switch (op) {
+        case Op::Union: return a || b;
+        case Op::Intersection: return a && b;
+        case Op::Difference: return a && !b;
+        case Op::Xor: return a != b;
+        }
+        return false;
+    };
+    auto ringArea = [](const PolygonBoolean::Ring& r) { return Polygon::AreaOf(r.constData(), r.size()); };
+
+    const PolygonBoolean::Ring a {{0, 0}, {10, 0}, {10, 10}, {0, 10}};
+    const PolygonBoolean::Ring b {{5, 5}, {15, 5}, {15, 15}, {5, 15}};
+    auto u = PolygonBoolean::Compute({a}, {b}, Op::Union);
+    REQUIRE(u.size() == 1);
+    REQUIRE_NEAR(ringArea(u[0].points), 175.0, 1e-9);
+    auto i = PolygonBoolean::Compute({a}, {b}, Op::Intersection);
+    REQUIRE(i.size() == 1);
+    REQUIRE_NEAR(ringArea(i[0].points), 25.0, 1e-9);
+    REQUIRE(PolygonBoolean::Compute({a}, {PolygonBoolean::Ring{{20, 20}, {30, 20}, {25, 30}}}, Op::Intersection).empty());
+
+    // 共边合并为一个环；内含的方块相减得到带洞结果
+    auto merged = PolygonBoolean::Compute({a}, {PolygonBoolean::Ring{{10, 0}, {20, 0}, {20, 10}, {10, 10}}}, Op::Union);
+    REQUIRE(merged.size() == 1);
+    REQUIRE_NEAR(ringArea(merged[0].points), 200.0, 1e-9);
+    auto holed = PolygonBoolean::Compute({a}, {PolygonBoolean::Ring{{3, 3}, {7, 3}, {7, 7}, {3, 7}}}, Op::Difference);
+    REQUIRE(holed.size() == 2);
+    REQUIRE(holed[0].holeOf == -1);
+    REQUIRE(holed[1].holeOf == 0);
+    REQUIRE(!inResult(QPointF(5, 5), holed));
+    REQUIRE(inResult(QPointF(1, 1), holed));
+    // 洞经桥边并入外环：单个环，奇偶判定与面积都与带洞结果一致
+    auto bridged = PolygonBoolean::BridgeHoles(holed);
+    REQUIRE(bridged.size() == 1);
+    REQUIRE(!HitTest::PointInPolygon(QPointF(5, 5), bridged[0].constData(), bridged[0].size()));
+    REQUIRE(HitTest::PointInPolygon(QPointF(1, 1), bridged[0].constData(), bridged[0].size()));
+    REQUIRE_NEAR(ringArea(bridged[0]), 84.0, 1e-9);
+
+    // 随机星形（自交点众多）：逐点核对奇偶分类
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> radius(0.3, 1.0), coord(-12.0, 17.0);
+    auto star = [&](double cx, double cy, int n) {
+        PolygonBoolean::Ring r;
+        for (int k = 0; k < n; ++k) {
+            const double t = 2.0 * M_PI * k / n, rr = 10.0 * radius(rng);
+            r.append(QPointF(cx + rr * std::cos(t), cy + rr * std::sin(t)));
+        }
+        return r;
+    };
+    for (int iter = 0; iter < 50; ++iter) {
+        const auto p = star(0, 0, 5 + iter % 30), q = star(iter % 5, (iter * 3) % 5, 7 + iter % 23);
+        for (Op op : {Op::Union, Op::Intersection, Op::Difference, Op::Xor}) {
+            const auto res = PolygonBoolean::Compute({p}, {q}, op);
+            for (int k = 0; k < 100; ++k) {
+                const QPointF t(coord(rng), coord(rng));
+                const bool inP = HitTest::PointInPolygon(t, p.constData(), p.size());
+                const bool inQ = HitTest::PointInPolygon(t, q.constData(), q.size());
+                REQUIRE(inResult(t, res) == expected(op, inP, inQ));
+            }
+            for (const auto& r : res) REQUIRE(r.holeOf < 0 || !res[r.holeOf].isHole());
+        }
+    }
+}
+
+TEST_CASE("Ellipse tessellation is error bounded and cached per scale bucket") {
+    for (double r : {0.5, 3.0, 50.0, 2000.0}) {
+        for (double tol : {0.01, 0.25}) {
+            const int n = Tessellate::EllipseSegments(r, r * 0.4, tol);
+            REQUIRE(n % 4 == 0);
+            REQUIRE(n >= Tessellate::kMinSegments && n <= Tessellate::kMaxSegments);
+            const QPolygonF poly = Tessellate::EllipsePolygon(QPointF(7, -3), r, r * 0.4, n);
+            REQUIRE(poly.size() == n);
+            for (int i = 0; i < n; ++i) {
+                const QPointF mid = (poly[i] + poly[(i + 1) % n]) * 0.5;
+                REQUIRE(HitTest::PointEllipseDistance(mid, QPointF(7, -3), r, r * 0.4) <= tol * (1.0 + 1e-9));
+            }
+            // 段数不过量：减半后误差超出容差（已触底的除外）
+            if (n > Tessellate::kMinSegments) REQUIRE(r * (1.0 - std::cos(2.0 * M_PI / n)) > tol);
+        }
+    }
+
+    Circle c(QPointF(0, 0), 100);
+    Tessellate::CurveCache cache;
+    const QPointF* first = cache.get(c.center(), c.radius(), c.radius(), c.geometryRevision(), 1.1, 0.25).constData();
+    // 同一档位内缩放复用缓存，换档或几何变化后重建
+    REQUIRE(cache.get(c.center(), c.radius(), c.radius(), c.geometryRevision(), 1.3, 0.25).constData() == first);
+    const qsizetype coarse = cache.get(c.center(), c.radius(), c.radius(), c.geometryRevision(), 1.3, 0.25).size();
+    REQUIRE(cache.get(c.center(), c.radius(), c.radius(), c.geometryRevision(), 8.0, 0.25).size() > coarse);
+    const quint32 rev = c.geometryRevision();
+    c.setRadius(50);
+    REQUIRE(c.geometryRevision() != rev);
+    REQUIRE_NEAR(cache.get(c.center(), c.radius(), c.radius(), c.geometryRevision(), 8.0, 0.25).front().x(), 50.0, 1e-9);
+    Ellipse e(QPointF(0, 0), 10, 5);
+    const quint32 erev = e.geometryRevision();
+    e.setRy(6);
+    REQUIRE(e.geometryRevision() != erev);
+}
+
+TEST_CASE("Shapes share interned styles and edit them copy-on-write") {
+    Circle a(QPointF(0, 0), 1), b(QPointF(1, 1), 2);
+    REQUIRE(a.styleIndex() == StyleTable::kDefault);
+    REQUIRE(&a.pen() == &b.pen());
+
+    const QJsonObject red{{"style", QJsonObject{{"color", "#ffff0000"}, {"pen", QJsonObject{{"width", 2.0}}}}}};
+    a.FromJsonCommon(red);
+    b.FromJsonCommon(red);
+    REQUIRE(a.styleIndex() == b.styleIndex());
+    REQUIRE(a.color() == QColor(255, 0, 0));
+    REQUIRE(a.pen().color() == QColor(255, 0, 0));
+    REQUIRE(a.pen().widthF() == 2.0);
+
+    // 修改一个图形只改指它自己的下标，共用样式的另一图形与原记录不变
+    const quint32 shared = a.styleIndex();
+    a.setPenWidth(5.0);
+    REQUIRE(a.styleIndex() != shared);
+    REQUIRE(b.pen().widthF() == 2.0);
+    REQUIRE(StyleTable::instance().at(shared).pen.widthF() == 2.0);
+    // 改回相同的值得到同一条记录
+    a.setPenWidth(2.0);
+    REQUIRE(a.styleIndex() == shared);
+    a.setPenColor(Qt::blue);
+    REQUIRE(a.pen().color() == QColor(Qt::blue));
+    REQUIRE(a.color() == QColor(255, 0, 0));
+    REQUIRE(b.pen().color() == QColor(255, 0, 0));
+}
+
+TEST_CASE("StyleTable grows past its first chunks and resets to the kept styles") {
+    StyleTable& table = StyleTable::instance();
+    Circle kept(QPointF(0, 0), 1), scratch(QPointF(0, 0), 1);
+    kept.setPen(QPen(Qt::red, 3.0));
+    // 跨越多个（逐块加倍的）块
+    for (int i = 0; i < 5000; ++i) scratch.setPenWidth(100.0 + i * 0.25);
+    REQUIRE(table.size() > 5000);
+    REQUIRE(scratch.pen().widthF() == 100.0 + 4999 * 0.25);
+    REQUIRE(kept.pen().widthF() == 3.0);
+
+    std::vector<quint32> keep {kept.styleIndex(), StyleTable::kDefault, kept.styleIndex()};
+    table.reset(keep);
+    REQUIRE(table.size() == 2);
+    REQUIRE(keep[0] == keep[2]);
+    REQUIRE(keep[1] == StyleTable::kDefault);
+    kept.setStyleIndex(keep[0]);
+    REQUIRE(kept.pen().color() == QColor(Qt::red));
+    REQUIRE(kept.pen().widthF() == 3.0);
+    REQUIRE(table.at(StyleTable::kDefault).pen == QPen(Qt::black));
+    scratch.setStyleIndex(StyleTable::kDefault);
+    // 重置后按值驻留仍能找到保留的记录
+    Circle again(QPointF(0, 0), 1);
+    again.setPen(QPen(Qt::red, 3.0));
+    REQUIRE(again.styleIndex() == keep[0]);
+}